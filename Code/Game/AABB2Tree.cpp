@@ -0,0 +1,382 @@
+#include "Game/AABB2Tree.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/TreeUtils.hpp"
+#include "Game/WorkStealingThreadPool.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+
+#include <algorithm>
+
+
+static void AddBoundsToBounds(AABB2 const& bounds, AABB2& out_bounds)
+{
+	// Plain compares rather than fminf/fmaxf: the builder runs these per poly per level and they must compile to min/max instructions
+	out_bounds.m_mins.x = bounds.m_mins.x < out_bounds.m_mins.x ? bounds.m_mins.x : out_bounds.m_mins.x;
+	out_bounds.m_mins.y = bounds.m_mins.y < out_bounds.m_mins.y ? bounds.m_mins.y : out_bounds.m_mins.y;
+	out_bounds.m_maxs.x = bounds.m_maxs.x > out_bounds.m_maxs.x ? bounds.m_maxs.x : out_bounds.m_maxs.x;
+	out_bounds.m_maxs.y = bounds.m_maxs.y > out_bounds.m_maxs.y ? bounds.m_maxs.y : out_bounds.m_maxs.y;
+}
+
+static float GetPerimeter(AABB2 const& bounds)
+{
+	return 2.f * ((bounds.m_maxs.x - bounds.m_mins.x) + (bounds.m_maxs.y - bounds.m_mins.y));
+}
+
+
+void AABB2Tree::Build(std::vector<ConvexPoly2> const& convexPolys, WorkStealingThreadPool* threadPool)
+{
+	Clear();
+
+	int numPolys = (int)convexPolys.size();
+	if (numPolys == 0)
+	{
+		return;
+	}
+
+	std::vector<BuildPrimitive> primitives(numPolys);
+	auto computePrimitives = [&convexPolys, &primitives](int threadIndex, int firstPolyIndex, int endPolyIndex)
+	{
+		UNUSED(threadIndex);
+		for (int polyIndex = firstPolyIndex; polyIndex < endPolyIndex; polyIndex++)
+		{
+			std::vector<Vec2> const vertexes = convexPolys[polyIndex].GetVertexes();
+			AABB2 bounds(vertexes[0], vertexes[0]);
+			for (int vertexIndex = 1; vertexIndex < (int)vertexes.size(); vertexIndex++)
+			{
+				AddBoundsToBounds(AABB2(vertexes[vertexIndex], vertexes[vertexIndex]), bounds);
+			}
+			primitives[polyIndex].m_bounds = bounds;
+			primitives[polyIndex].m_center = (bounds.m_mins + bounds.m_maxs) * 0.5f;
+			primitives[polyIndex].m_polyIndex = polyIndex;
+		}
+	};
+
+	m_nodes.reserve(2 * numPolys / MAX_POLYS_PER_LEAF + 1);
+	m_nodes.push_back(AABB2TreeNode());
+	int numThreads = threadPool ? threadPool->GetNumThreads() : 1;
+	int maxDeferredSubtreeSize = std::max(numPolys / (NUM_SUBTREE_TASKS_PER_THREAD * numThreads), MIN_POLYS_PER_SUBTREE_TASK);
+	if (numThreads == 1 || numPolys <= maxDeferredSubtreeSize)
+	{
+		computePrimitives(0, 0, numPolys);
+		BuildSubtree(m_nodes, 0, primitives, 0, numPolys, 0, nullptr, 0);
+	}
+	else
+	{
+		// Split the top levels here until every remaining range is small enough to be one task, then build those ranges in parallel.
+		// Each task only reorders its own slice of the primitives and writes its own node list, so the tasks share nothing mutable
+		threadPool->ParallelFor(numPolys, POLY_BOUNDS_CHUNK_SIZE, computePrimitives);
+		std::vector<DeferredSubtree> deferredSubtrees;
+		BuildSubtree(m_nodes, 0, primitives, 0, numPolys, 0, &deferredSubtrees, maxDeferredSubtreeSize);
+
+		std::vector<std::vector<AABB2TreeNode>> subtreeNodes(deferredSubtrees.size());
+		threadPool->ParallelFor((int)deferredSubtrees.size(), 1, [&deferredSubtrees, &subtreeNodes, &primitives](int threadIndex, int firstSubtreeIndex, int endSubtreeIndex)
+		{
+			UNUSED(threadIndex);
+			for (int subtreeIndex = firstSubtreeIndex; subtreeIndex < endSubtreeIndex; subtreeIndex++)
+			{
+				DeferredSubtree const& subtree = deferredSubtrees[subtreeIndex];
+				std::vector<AABB2TreeNode>& nodes = subtreeNodes[subtreeIndex];
+				nodes.reserve(2 * subtree.m_numPrimitives / MAX_POLYS_PER_LEAF + 1);
+				nodes.push_back(AABB2TreeNode());
+				BuildSubtree(nodes, 0, primitives, subtree.m_firstPrimitiveIndex, subtree.m_numPrimitives, subtree.m_depth, nullptr, 0);
+			}
+		});
+
+		// Each subtree root replaces its placeholder and the rest are appended, so children still come after their parents
+		for (int subtreeIndex = 0; subtreeIndex < (int)deferredSubtrees.size(); subtreeIndex++)
+		{
+			std::vector<AABB2TreeNode> const& nodes = subtreeNodes[subtreeIndex];
+			int nodeIndexOffset = (int)m_nodes.size() - 1;
+			for (int localNodeIndex = 0; localNodeIndex < (int)nodes.size(); localNodeIndex++)
+			{
+				AABB2TreeNode node = nodes[localNodeIndex];
+				if (!node.IsLeaf())
+				{
+					node.m_childIndexes[0] += nodeIndexOffset;
+					node.m_childIndexes[1] += nodeIndexOffset;
+				}
+				if (localNodeIndex == 0)
+				{
+					m_nodes[deferredSubtrees[subtreeIndex].m_nodeIndex] = node;
+				}
+				else
+				{
+					m_nodes.push_back(node);
+				}
+			}
+		}
+	}
+
+	// Leaves index primitives, which are now in leaf order
+	m_polyIndexes.resize(numPolys);
+	for (int primitiveIndex = 0; primitiveIndex < numPolys; primitiveIndex++)
+	{
+		m_polyIndexes[primitiveIndex] = primitives[primitiveIndex].m_polyIndex;
+	}
+}
+
+void AABB2Tree::Clear()
+{
+	m_nodes.clear();
+	m_polyIndexes.clear();
+}
+
+void AABB2Tree::BuildSubtree(std::vector<AABB2TreeNode>& nodes, int nodeIndex, std::vector<BuildPrimitive>& primitives, int firstPrimitiveIndex, int numPrimitives, int depth, std::vector<DeferredSubtree>* out_deferredSubtrees, int maxDeferredSubtreeSize)
+{
+	if (out_deferredSubtrees && numPrimitives <= maxDeferredSubtreeSize)
+	{
+		DeferredSubtree subtree;
+		subtree.m_nodeIndex = nodeIndex;
+		subtree.m_firstPrimitiveIndex = firstPrimitiveIndex;
+		subtree.m_numPrimitives = numPrimitives;
+		subtree.m_depth = depth;
+		out_deferredSubtrees->push_back(subtree);
+		return;
+	}
+
+	// Node bounds enclose every poly in the range, centroid bounds decide where splits may go
+	BuildPrimitive* rangePrimitives = primitives.data() + firstPrimitiveIndex;
+	AABB2 nodeBounds = rangePrimitives[0].m_bounds;
+	AABB2 centroidBounds(rangePrimitives[0].m_center, rangePrimitives[0].m_center);
+	for (int primitiveIndex = 1; primitiveIndex < numPrimitives; primitiveIndex++)
+	{
+		AddBoundsToBounds(rangePrimitives[primitiveIndex].m_bounds, nodeBounds);
+		AddBoundsToBounds(AABB2(rangePrimitives[primitiveIndex].m_center, rangePrimitives[primitiveIndex].m_center), centroidBounds);
+	}
+	nodes[nodeIndex].m_bounds = nodeBounds;
+
+	if (numPrimitives <= MAX_POLYS_PER_LEAF)
+	{
+		nodes[nodeIndex].m_firstPolyIndex = firstPrimitiveIndex;
+		nodes[nodeIndex].m_numPolys = numPrimitives;
+		return;
+	}
+
+	int numPrimitivesOnLeft = depth < MAX_BINNED_SAH_DEPTH ? PartitionWithBinnedSAH(rangePrimitives, numPrimitives, centroidBounds) : 0;
+	if (numPrimitivesOnLeft <= 0 || numPrimitivesOnLeft >= numPrimitives)
+	{
+		numPrimitivesOnLeft = PartitionAtMedian(rangePrimitives, numPrimitives, centroidBounds);
+	}
+
+	int leftChildIndex = (int)nodes.size();
+	nodes.push_back(AABB2TreeNode());
+	nodes.push_back(AABB2TreeNode());
+	nodes[nodeIndex].m_childIndexes[0] = leftChildIndex;
+	nodes[nodeIndex].m_childIndexes[1] = leftChildIndex + 1;
+
+	BuildSubtree(nodes, leftChildIndex, primitives, firstPrimitiveIndex, numPrimitivesOnLeft, depth + 1, out_deferredSubtrees, maxDeferredSubtreeSize);
+	BuildSubtree(nodes, leftChildIndex + 1, primitives, firstPrimitiveIndex + numPrimitivesOnLeft, numPrimitives - numPrimitivesOnLeft, depth + 1, out_deferredSubtrees, maxDeferredSubtreeSize);
+}
+
+int AABB2Tree::PartitionWithBinnedSAH(BuildPrimitive* primitives, int numPrimitives, AABB2 const& centroidBounds)
+{
+	// In 2D a box's chance of being crossed by a random ray goes with its perimeter, so a split costs
+	// perimeter(left) * numLeft + perimeter(right) * numRight; candidates are the boundaries between equal-width centroid bins.
+	// An axis with no centroid extent puts everything in bin 0 and so never offers a candidate
+	Vec2 centroidDimensions = centroidBounds.m_maxs - centroidBounds.m_mins;
+	float binScales[2] = { centroidDimensions.x > 0.f ? (float)NUM_SAH_BINS / centroidDimensions.x : 0.f, centroidDimensions.y > 0.f ? (float)NUM_SAH_BINS / centroidDimensions.y : 0.f };
+	auto getBinIndex = [&centroidBounds, &binScales](Vec2 const& center, int axis)
+	{
+		float offset = axis == 0 ? center.x - centroidBounds.m_mins.x : center.y - centroidBounds.m_mins.y;
+		return std::min((int)(offset * binScales[axis]), NUM_SAH_BINS - 1);
+	};
+
+	// Bins start inside out so every poly can be merged without checking whether its bin is still empty
+	AABB2 const emptyBounds(Vec2(FLT_MAX, FLT_MAX), Vec2(-FLT_MAX, -FLT_MAX));
+	int binCounts[2][NUM_SAH_BINS] = {};
+	AABB2 binBounds[2][NUM_SAH_BINS];
+	for (int axis = 0; axis < 2; axis++)
+	{
+		for (int binIndex = 0; binIndex < NUM_SAH_BINS; binIndex++)
+		{
+			binBounds[axis][binIndex] = emptyBounds;
+		}
+	}
+	for (int primitiveIndex = 0; primitiveIndex < numPrimitives; primitiveIndex++)
+	{
+		BuildPrimitive const& primitive = primitives[primitiveIndex];
+		for (int axis = 0; axis < 2; axis++)
+		{
+			int binIndex = getBinIndex(primitive.m_center, axis);
+			AddBoundsToBounds(primitive.m_bounds, binBounds[axis][binIndex]);
+			binCounts[axis][binIndex]++;
+		}
+	}
+
+	float bestSplitCost = FLT_MAX;
+	int bestSplitAxis = -1;
+	int bestSplitBinIndex = -1;
+	for (int axis = 0; axis < 2; axis++)
+	{
+		// Sweep right to left for the cost of everything above each boundary, then left to right to pick the cheapest boundary
+		float rightCosts[NUM_SAH_BINS] = {};
+		int rightCount = 0;
+		AABB2 rightBounds = emptyBounds;
+		for (int binIndex = NUM_SAH_BINS - 1; binIndex > 0; binIndex--)
+		{
+			AddBoundsToBounds(binBounds[axis][binIndex], rightBounds);
+			rightCount += binCounts[axis][binIndex];
+			rightCosts[binIndex] = rightCount > 0 ? GetPerimeter(rightBounds) * (float)rightCount : -1.f;
+		}
+
+		int leftCount = 0;
+		AABB2 leftBounds = emptyBounds;
+		for (int binIndex = 0; binIndex < NUM_SAH_BINS - 1; binIndex++)
+		{
+			AddBoundsToBounds(binBounds[axis][binIndex], leftBounds);
+			leftCount += binCounts[axis][binIndex];
+			if (leftCount == 0 || rightCosts[binIndex + 1] < 0.f)
+			{
+				continue;
+			}
+
+			float splitCost = GetPerimeter(leftBounds) * (float)leftCount + rightCosts[binIndex + 1];
+			if (splitCost < bestSplitCost)
+			{
+				bestSplitCost = splitCost;
+				bestSplitAxis = axis;
+				bestSplitBinIndex = binIndex;
+			}
+		}
+	}
+
+	if (bestSplitAxis < 0)
+	{
+		return 0;
+	}
+
+	BuildPrimitive* rightBegin = std::partition(primitives, primitives + numPrimitives, [&getBinIndex, bestSplitAxis, bestSplitBinIndex](BuildPrimitive const& primitive)
+	{
+		return getBinIndex(primitive.m_center, bestSplitAxis) <= bestSplitBinIndex;
+	});
+	return (int)(rightBegin - primitives);
+}
+
+int AABB2Tree::PartitionAtMedian(BuildPrimitive* primitives, int numPrimitives, AABB2 const& centroidBounds)
+{
+	// Median split along the longest centroid axis keeps the tree balanced for clustered scenes
+	Vec2 centroidDimensions = centroidBounds.m_maxs - centroidBounds.m_mins;
+	bool splitAlongX = centroidDimensions.x >= centroidDimensions.y;
+	int numPrimitivesOnLeft = numPrimitives / 2;
+	std::nth_element(primitives, primitives + numPrimitivesOnLeft, primitives + numPrimitives, [splitAlongX](BuildPrimitive const& primitiveA, BuildPrimitive const& primitiveB)
+	{
+		return splitAlongX ? primitiveA.m_center.x < primitiveB.m_center.x : primitiveA.m_center.y < primitiveB.m_center.y;
+	});
+	return numPrimitivesOnLeft;
+}
+
+RaycastResult2D AABB2Tree::RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit) const
+{
+	RaycastResult2D closestResult;
+	closestResult.m_rayStartPosition = startPos;
+	closestResult.m_rayForwardNormal = fwdNormal;
+	closestResult.m_impactDistance = FLT_MAX;
+
+	auto getEntryDistance = [this, &startPos, &fwdNormal, maxDistance](int nodeIndex, float& out_entryDistance)
+	{
+		return GetRayEntryDistanceVsAABB2(startPos, fwdNormal, maxDistance, m_nodes[nodeIndex].m_bounds, out_entryDistance);
+	};
+	auto visitNode = [this, &startPos, &fwdNormal, maxDistance, &raycastVsHull, stopAtFirstHit, &closestResult, &out_numHullTests](int nodeIndex, float& inout_cutoffDistance)
+	{
+		AABB2TreeNode const& node = m_nodes[nodeIndex];
+		if (!node.IsLeaf())
+		{
+			return true;
+		}
+
+		for (int polyIndexIdx = node.m_firstPolyIndex; polyIndexIdx < node.m_firstPolyIndex + node.m_numPolys; polyIndexIdx++)
+		{
+			out_numHullTests++;
+			RaycastResult2D raycastVsConvexHullResult = raycastVsHull(m_polyIndexes[polyIndexIdx], startPos, fwdNormal, maxDistance);
+			if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+			{
+				closestResult = raycastVsConvexHullResult;
+				if (stopAtFirstHit)
+				{
+					inout_cutoffDistance = -1.f;
+					return false;
+				}
+			}
+		}
+		inout_cutoffDistance = closestResult.m_impactDistance;
+		return false;
+	};
+	TraverseTreeNearestFirst<MAX_TREE_TRAVERSAL_DEPTH>(m_nodes, 0, getEntryDistance, visitNode);
+
+	return closestResult;
+}
+
+void AABB2Tree::AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		AABB2 const& bounds = m_nodes[nodeIndex].m_bounds;
+		AddVertsForLineSegment2D(verts, bounds.m_mins, Vec2(bounds.m_maxs.x, bounds.m_mins.y), lineThickness, color);
+		AddVertsForLineSegment2D(verts, Vec2(bounds.m_maxs.x, bounds.m_mins.y), bounds.m_maxs, lineThickness, color);
+		AddVertsForLineSegment2D(verts, bounds.m_maxs, Vec2(bounds.m_mins.x, bounds.m_maxs.y), lineThickness, color);
+		AddVertsForLineSegment2D(verts, Vec2(bounds.m_mins.x, bounds.m_maxs.y), bounds.m_mins, lineThickness, color);
+	}
+}
+
+uint32_t AABB2Tree::AppendToWriter(BufferWriter& writer) const
+{
+	uint32_t payloadSize = 0;
+	writer.AppendUint32((uint32_t)m_nodes.size());
+	payloadSize += sizeof(uint32_t);
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		AABB2TreeNode const& node = m_nodes[nodeIndex];
+		writer.AppendVec2(node.m_bounds.m_mins);
+		payloadSize += sizeof(Vec2);
+		writer.AppendVec2(node.m_bounds.m_maxs);
+		payloadSize += sizeof(Vec2);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[0]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[1]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUShort((uint16_t)node.m_firstPolyIndex);
+		payloadSize += sizeof(uint16_t);
+		writer.AppendUShort((uint16_t)node.m_numPolys);
+		payloadSize += sizeof(uint16_t);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < (int)m_polyIndexes.size(); polyIndexIdx++)
+	{
+		writer.AppendUShort((uint16_t)m_polyIndexes[polyIndexIdx]);
+		payloadSize += sizeof(uint16_t);
+	}
+
+	return payloadSize;
+}
+
+bool AABB2Tree::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	uint32_t numNodes = parser.ParseUint32();
+	for (uint32_t nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		AABB2TreeNode node;
+		node.m_bounds.m_mins = parser.ParseVec2();
+		node.m_bounds.m_maxs = parser.ParseVec2();
+		node.m_childIndexes[0] = (int)parser.ParseUint32();
+		node.m_childIndexes[1] = (int)parser.ParseUint32();
+		node.m_firstPolyIndex = parser.ParseUShort();
+		node.m_numPolys = parser.ParseUShort();
+		m_nodes.push_back(node);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < numPolys; polyIndexIdx++)
+	{
+		m_polyIndexes.push_back(parser.ParseUShort());
+	}
+
+	if (!AreTreeIndexesValid(m_nodes, m_polyIndexes, numPolys, MAX_TREE_TRAVERSAL_DEPTH - 1))
+	{
+		Clear();
+		return false;
+	}
+
+	return true;
+}
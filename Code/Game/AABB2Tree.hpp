@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Game/HullRaycastFunction.hpp"
+#include "Game/TreeUtils.hpp"
+
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/ConvexHull2.hpp"
+#include "Engine/Math/ConvexPoly2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct RaycastResult2D;
+struct Vertex_PCU;
+struct Rgba8;
+class BufferParser;
+class BufferWriter;
+class WorkStealingThreadPool;
+
+
+struct AABB2TreeNode
+{
+public:
+	bool IsLeaf() const { return m_numPolys > 0; }
+
+public:
+	AABB2 m_bounds;
+	int m_childIndexes[2] = { -1, -1 };
+	int m_firstPolyIndex = 0;
+	int m_numPolys = 0;
+};
+
+class AABB2Tree
+{
+public:
+	~AABB2Tree() = default;
+	AABB2Tree() = default;
+
+	// Binned perimeter-heuristic splits; with a thread pool the subtrees below the top few levels are built as parallel tasks
+	void Build(std::vector<ConvexPoly2> const& convexPolys, WorkStealingThreadPool* threadPool = nullptr);
+	void Clear();
+	bool IsEmpty() const { return m_nodes.empty(); }
+
+	RaycastResult2D RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit = false) const;
+
+	void AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+private:
+	// Per-poly build input, partitioned in place so every pass over a node's range reads memory in order
+	struct BuildPrimitive
+	{
+		AABB2 m_bounds;
+		Vec2 m_center;
+		int m_polyIndex = 0;
+	};
+
+	// A subtree left for a worker thread: its root node is a placeholder in m_nodes until the worker's nodes are stitched in
+	struct DeferredSubtree
+	{
+		int m_nodeIndex = 0;
+		int m_firstPrimitiveIndex = 0;
+		int m_numPrimitives = 0;
+		int m_depth = 0;
+	};
+
+	static void BuildSubtree(std::vector<AABB2TreeNode>& nodes, int nodeIndex, std::vector<BuildPrimitive>& primitives, int firstPrimitiveIndex, int numPrimitives, int depth, std::vector<DeferredSubtree>* out_deferredSubtrees, int maxDeferredSubtreeSize);
+	static int PartitionWithBinnedSAH(BuildPrimitive* primitives, int numPrimitives, AABB2 const& centroidBounds);
+	static int PartitionAtMedian(BuildPrimitive* primitives, int numPrimitives, AABB2 const& centroidBounds);
+
+public:
+	static constexpr int MAX_POLYS_PER_LEAF = 4;
+	static constexpr int NUM_SAH_BINS = 16;
+	// Past this depth splits fall back to the median, so even a degenerate scene stays within MAX_TREE_TRAVERSAL_DEPTH
+	static constexpr int MAX_BINNED_SAH_DEPTH = MAX_TREE_TRAVERSAL_DEPTH - 24;
+	static constexpr int NUM_SUBTREE_TASKS_PER_THREAD = 4;
+	static constexpr int MIN_POLYS_PER_SUBTREE_TASK = 256;
+	static constexpr int POLY_BOUNDS_CHUNK_SIZE = 1024;
+
+	std::vector<AABB2TreeNode> m_nodes;
+	std::vector<int> m_polyIndexes;
+};
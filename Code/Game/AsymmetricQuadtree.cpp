@@ -0,0 +1,244 @@
+#include "Game/AsymmetricQuadtree.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/TreeUtils.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+
+#include <algorithm>
+
+
+void AsymmetricQuadtree::Build(std::vector<ConvexPoly2> const& convexPolys)
+{
+	Clear();
+
+	int numPolys = (int)convexPolys.size();
+	if (numPolys == 0)
+	{
+		return;
+	}
+
+	std::vector<AABB2> polyBounds;
+	std::vector<Vec2> polyCenters;
+	polyBounds.reserve(numPolys);
+	polyCenters.reserve(numPolys);
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		std::vector<Vec2> const vertexes = convexPolys[polyIndex].GetVertexes();
+		AABB2 bounds(vertexes[0], vertexes[0]);
+		for (int vertexIndex = 1; vertexIndex < (int)vertexes.size(); vertexIndex++)
+		{
+			bounds.m_mins.x = fminf(bounds.m_mins.x, vertexes[vertexIndex].x);
+			bounds.m_mins.y = fminf(bounds.m_mins.y, vertexes[vertexIndex].y);
+			bounds.m_maxs.x = fmaxf(bounds.m_maxs.x, vertexes[vertexIndex].x);
+			bounds.m_maxs.y = fmaxf(bounds.m_maxs.y, vertexes[vertexIndex].y);
+		}
+		polyBounds.push_back(bounds);
+		polyCenters.push_back((bounds.m_mins + bounds.m_maxs) * 0.5f);
+		m_polyIndexes.push_back(polyIndex);
+	}
+
+	m_nodes.push_back(AsymmetricQuadtreeNode());
+	BuildSubtree(0, 0, numPolys, 0, polyBounds, polyCenters);
+}
+
+void AsymmetricQuadtree::Clear()
+{
+	m_nodes.clear();
+	m_polyIndexes.clear();
+}
+
+void AsymmetricQuadtree::BuildSubtree(int nodeIndex, int firstPolyIndex, int numPolys, int depth, std::vector<AABB2> const& polyBounds, std::vector<Vec2> const& polyCenters)
+{
+	AABB2 nodeBounds = polyBounds[m_polyIndexes[firstPolyIndex]];
+	std::vector<float> centerXs;
+	std::vector<float> centerYs;
+	centerXs.reserve(numPolys);
+	centerYs.reserve(numPolys);
+	for (int polyIndexIdx = firstPolyIndex; polyIndexIdx < firstPolyIndex + numPolys; polyIndexIdx++)
+	{
+		AABB2 const& bounds = polyBounds[m_polyIndexes[polyIndexIdx]];
+		nodeBounds.m_mins.x = fminf(nodeBounds.m_mins.x, bounds.m_mins.x);
+		nodeBounds.m_mins.y = fminf(nodeBounds.m_mins.y, bounds.m_mins.y);
+		nodeBounds.m_maxs.x = fmaxf(nodeBounds.m_maxs.x, bounds.m_maxs.x);
+		nodeBounds.m_maxs.y = fmaxf(nodeBounds.m_maxs.y, bounds.m_maxs.y);
+
+		centerXs.push_back(polyCenters[m_polyIndexes[polyIndexIdx]].x);
+		centerYs.push_back(polyCenters[m_polyIndexes[polyIndexIdx]].y);
+	}
+	m_nodes[nodeIndex].m_bounds = nodeBounds;
+
+	// Split at the median poly center on each axis instead of the midpoint, so clusters still divide evenly
+	std::nth_element(centerXs.begin(), centerXs.begin() + numPolys / 2, centerXs.end());
+	std::nth_element(centerYs.begin(), centerYs.begin() + numPolys / 2, centerYs.end());
+	Vec2 splitPosition(centerXs[numPolys / 2], centerYs[numPolys / 2]);
+	m_nodes[nodeIndex].m_splitPosition = splitPosition;
+
+	if (numPolys <= MAX_POLYS_PER_LEAF || depth >= MAX_DEPTH - 1)
+	{
+		m_nodes[nodeIndex].m_firstPolyIndex = firstPolyIndex;
+		m_nodes[nodeIndex].m_numPolys = numPolys;
+		return;
+	}
+
+	std::vector<int>::iterator rangeBegin = m_polyIndexes.begin() + firstPolyIndex;
+	std::vector<int>::iterator rangeEnd = rangeBegin + numPolys;
+	std::vector<int>::iterator rightBegin = std::partition(rangeBegin, rangeEnd, [&polyCenters, splitPosition](int polyIndex) { return polyCenters[polyIndex].x < splitPosition.x; });
+	std::vector<int>::iterator leftTopBegin = std::partition(rangeBegin, rightBegin, [&polyCenters, splitPosition](int polyIndex) { return polyCenters[polyIndex].y < splitPosition.y; });
+	std::vector<int>::iterator rightTopBegin = std::partition(rightBegin, rangeEnd, [&polyCenters, splitPosition](int polyIndex) { return polyCenters[polyIndex].y < splitPosition.y; });
+
+	int quadrantFirstPolyIndexes[5] = { firstPolyIndex, firstPolyIndex + (int)(leftTopBegin - rangeBegin), firstPolyIndex + (int)(rightBegin - rangeBegin), firstPolyIndex + (int)(rightTopBegin - rangeBegin), firstPolyIndex + numPolys };
+	// Polys in left-bottom, right-bottom, left-top, right-top order
+	int quadrantOrder[4] = { 0, 2, 1, 3 };
+	int quadrantRanges[4][2] = {};
+	for (int quadrant = 0; quadrant < 4; quadrant++)
+	{
+		int rangeIndex = quadrantOrder[quadrant];
+		quadrantRanges[quadrant][0] = quadrantFirstPolyIndexes[rangeIndex];
+		quadrantRanges[quadrant][1] = quadrantFirstPolyIndexes[rangeIndex + 1] - quadrantFirstPolyIndexes[rangeIndex];
+		if (quadrantRanges[quadrant][1] == numPolys)
+		{
+			// Every center sits on one side of the split (coincident centers), splitting further would not progress
+			m_nodes[nodeIndex].m_firstPolyIndex = firstPolyIndex;
+			m_nodes[nodeIndex].m_numPolys = numPolys;
+			return;
+		}
+	}
+
+	for (int quadrant = 0; quadrant < 4; quadrant++)
+	{
+		if (quadrantRanges[quadrant][1] == 0)
+		{
+			continue;
+		}
+
+		int childIndex = (int)m_nodes.size();
+		m_nodes.push_back(AsymmetricQuadtreeNode());
+		m_nodes[nodeIndex].m_childIndexes[quadrant] = childIndex;
+		BuildSubtree(childIndex, quadrantRanges[quadrant][0], quadrantRanges[quadrant][1], depth + 1, polyBounds, polyCenters);
+	}
+}
+
+RaycastResult2D AsymmetricQuadtree::RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit) const
+{
+	RaycastResult2D closestResult;
+	closestResult.m_rayStartPosition = startPos;
+	closestResult.m_rayForwardNormal = fwdNormal;
+	closestResult.m_impactDistance = FLT_MAX;
+
+	auto getEntryDistance = [this, &startPos, &fwdNormal, maxDistance](int nodeIndex, float& out_entryDistance)
+	{
+		return GetRayEntryDistanceVsAABB2(startPos, fwdNormal, maxDistance, m_nodes[nodeIndex].m_bounds, out_entryDistance);
+	};
+	auto visitNode = [this, &startPos, &fwdNormal, maxDistance, &raycastVsHull, stopAtFirstHit, &closestResult, &out_numHullTests](int nodeIndex, float& inout_cutoffDistance)
+	{
+		AsymmetricQuadtreeNode const& node = m_nodes[nodeIndex];
+		if (!node.IsLeaf())
+		{
+			return true;
+		}
+
+		for (int polyIndexIdx = node.m_firstPolyIndex; polyIndexIdx < node.m_firstPolyIndex + node.m_numPolys; polyIndexIdx++)
+		{
+			out_numHullTests++;
+			RaycastResult2D raycastVsConvexHullResult = raycastVsHull(m_polyIndexes[polyIndexIdx], startPos, fwdNormal, maxDistance);
+			if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+			{
+				closestResult = raycastVsConvexHullResult;
+				if (stopAtFirstHit)
+				{
+					inout_cutoffDistance = -1.f;
+					return false;
+				}
+			}
+		}
+		inout_cutoffDistance = closestResult.m_impactDistance;
+		return false;
+	};
+	TraverseTreeNearestFirst<MAX_TRAVERSAL_STACK_SIZE>(m_nodes, 0, getEntryDistance, visitNode);
+
+	return closestResult;
+}
+
+void AsymmetricQuadtree::AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	// Split lines clipped to each interior node's bounds
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		AsymmetricQuadtreeNode const& node = m_nodes[nodeIndex];
+		if (node.IsLeaf())
+		{
+			continue;
+		}
+		AddVertsForLineSegment2D(verts, Vec2(node.m_splitPosition.x, node.m_bounds.m_mins.y), Vec2(node.m_splitPosition.x, node.m_bounds.m_maxs.y), lineThickness, color);
+		AddVertsForLineSegment2D(verts, Vec2(node.m_bounds.m_mins.x, node.m_splitPosition.y), Vec2(node.m_bounds.m_maxs.x, node.m_splitPosition.y), lineThickness, color);
+	}
+}
+
+uint32_t AsymmetricQuadtree::AppendToWriter(BufferWriter& writer) const
+{
+	uint32_t payloadSize = 0;
+	writer.AppendUint32((uint32_t)m_nodes.size());
+	payloadSize += sizeof(uint32_t);
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		AsymmetricQuadtreeNode const& node = m_nodes[nodeIndex];
+		writer.AppendVec2(node.m_bounds.m_mins);
+		payloadSize += sizeof(Vec2);
+		writer.AppendVec2(node.m_bounds.m_maxs);
+		payloadSize += sizeof(Vec2);
+		writer.AppendVec2(node.m_splitPosition);
+		payloadSize += sizeof(Vec2);
+		for (int quadrant = 0; quadrant < 4; quadrant++)
+		{
+			writer.AppendUint32((uint32_t)node.m_childIndexes[quadrant]);
+			payloadSize += sizeof(uint32_t);
+		}
+		writer.AppendUShort((uint16_t)node.m_firstPolyIndex);
+		payloadSize += sizeof(uint16_t);
+		writer.AppendUShort((uint16_t)node.m_numPolys);
+		payloadSize += sizeof(uint16_t);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < (int)m_polyIndexes.size(); polyIndexIdx++)
+	{
+		writer.AppendUShort((uint16_t)m_polyIndexes[polyIndexIdx]);
+		payloadSize += sizeof(uint16_t);
+	}
+
+	return payloadSize;
+}
+
+bool AsymmetricQuadtree::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	uint32_t numNodes = parser.ParseUint32();
+	for (uint32_t nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		AsymmetricQuadtreeNode node;
+		node.m_bounds.m_mins = parser.ParseVec2();
+		node.m_bounds.m_maxs = parser.ParseVec2();
+		node.m_splitPosition = parser.ParseVec2();
+		for (int quadrant = 0; quadrant < 4; quadrant++)
+		{
+			node.m_childIndexes[quadrant] = (int)parser.ParseUint32();
+		}
+		node.m_firstPolyIndex = parser.ParseUShort();
+		node.m_numPolys = parser.ParseUShort();
+		m_nodes.push_back(node);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < numPolys; polyIndexIdx++)
+	{
+		m_polyIndexes.push_back(parser.ParseUShort());
+	}
+
+	if (!AreTreeIndexesValid(m_nodes, m_polyIndexes, numPolys, MAX_DEPTH, TreeNodeOrder::PARENTS_FIRST, true))
+	{
+		Clear();
+		return false;
+	}
+
+	return true;
+}
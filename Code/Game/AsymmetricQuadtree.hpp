@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Game/HullRaycastFunction.hpp"
+
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/ConvexHull2.hpp"
+#include "Engine/Math/ConvexPoly2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct RaycastResult2D;
+struct Vertex_PCU;
+struct Rgba8;
+class BufferParser;
+class BufferWriter;
+
+
+struct AsymmetricQuadtreeNode
+{
+public:
+	bool IsLeaf() const { return m_numPolys > 0; }
+
+public:
+	// Tight bounds of the polys below this node, which can reach past the parent's split lines
+	AABB2 m_bounds;
+	Vec2 m_splitPosition;
+	// Quadrants in order: left-bottom, right-bottom, left-top, right-top; empty quadrants are -1
+	int m_childIndexes[4] = { -1, -1, -1, -1 };
+	int m_firstPolyIndex = 0;
+	int m_numPolys = 0;
+};
+
+class AsymmetricQuadtree
+{
+public:
+	~AsymmetricQuadtree() = default;
+	AsymmetricQuadtree() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys);
+	void Clear();
+	bool IsEmpty() const { return m_nodes.empty(); }
+
+	RaycastResult2D RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit = false) const;
+
+	void AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+private:
+	void BuildSubtree(int nodeIndex, int firstPolyIndex, int numPolys, int depth, std::vector<AABB2> const& polyBounds, std::vector<Vec2> const& polyCenters);
+
+public:
+	static constexpr int MAX_POLYS_PER_LEAF = 4;
+	static constexpr int MAX_DEPTH = 16;
+	// Up to three siblings wait on the stack per level below the one being visited
+	static constexpr int MAX_TRAVERSAL_STACK_SIZE = 3 * MAX_DEPTH + 1;
+
+	std::vector<AsymmetricQuadtreeNode> m_nodes;
+	std::vector<int> m_polyIndexes;
+};
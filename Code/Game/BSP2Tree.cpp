@@ -0,0 +1,346 @@
+#include "Game/BSP2Tree.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/TreeUtils.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+
+#include <climits>
+
+
+void BSP2Tree::Build(std::vector<ConvexPoly2> const& convexPolys, std::vector<ConvexHull2> const& convexHulls)
+{
+	Clear();
+
+	int numPolys = (int)convexPolys.size();
+	if (numPolys == 0 || (int)convexHulls.size() != numPolys)
+	{
+		return;
+	}
+
+	std::vector<std::vector<Vec2>> polyVertexes;
+	std::vector<int> polyIndexes;
+	polyVertexes.reserve(numPolys);
+	polyIndexes.reserve(numPolys);
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		polyVertexes.push_back(convexPolys[polyIndex].GetVertexes());
+		polyIndexes.push_back(polyIndex);
+	}
+
+	m_nodes.push_back(BSP2TreeNode());
+	BuildSubtree(0, polyIndexes, 0, polyVertexes, convexHulls);
+}
+
+void BSP2Tree::Clear()
+{
+	m_nodes.clear();
+	m_polyIndexes.clear();
+}
+
+void BSP2Tree::BuildSubtree(int nodeIndex, std::vector<int> const& polyIndexes, int depth, std::vector<std::vector<Vec2>> const& polyVertexes, std::vector<ConvexHull2> const& convexHulls)
+{
+	int numPolys = (int)polyIndexes.size();
+	int bestCost = INT_MAX;
+	Plane2 bestSplitPlane;
+	std::vector<int> bestBackPolyIndexes;
+	std::vector<int> bestFrontPolyIndexes;
+
+	if (numPolys > MAX_POLYS_PER_LEAF && depth < MAX_TREE_TRAVERSAL_DEPTH - 2)
+	{
+		// Candidate split planes are hull planes of polys spread evenly through the set
+		int numCandidatePolys = numPolys < MAX_SPLIT_CANDIDATES ? numPolys : MAX_SPLIT_CANDIDATES;
+		for (int candidateIdx = 0; candidateIdx < numCandidatePolys; candidateIdx++)
+		{
+			int candidatePolyIndex = polyIndexes[candidateIdx * numPolys / numCandidatePolys];
+			std::vector<Plane2> const candidatePlanes = convexHulls[candidatePolyIndex].GetPlanes();
+			if (candidatePlanes.empty())
+			{
+				continue;
+			}
+			Plane2 const& candidatePlane = candidatePlanes[candidateIdx % (int)candidatePlanes.size()];
+
+			std::vector<int> backPolyIndexes;
+			std::vector<int> frontPolyIndexes;
+			int numStraddlingPolys = 0;
+			for (int polyIndexIdx = 0; polyIndexIdx < numPolys; polyIndexIdx++)
+			{
+				int polyIndex = polyIndexes[polyIndexIdx];
+				std::vector<Vec2> const& vertexes = polyVertexes[polyIndex];
+				bool isAnyVertexInBack = false;
+				bool isAnyVertexInFront = false;
+				for (int vertexIndex = 0; vertexIndex < (int)vertexes.size(); vertexIndex++)
+				{
+					float vertexAltitude = DotProduct2D(candidatePlane.m_normal, vertexes[vertexIndex]) - candidatePlane.m_distanceFromOriginAlongNormal;
+					isAnyVertexInBack = isAnyVertexInBack || vertexAltitude < PLANE_THICKNESS;
+					isAnyVertexInFront = isAnyVertexInFront || vertexAltitude > -PLANE_THICKNESS;
+				}
+				if (isAnyVertexInBack)
+				{
+					backPolyIndexes.push_back(polyIndex);
+				}
+				if (isAnyVertexInFront)
+				{
+					frontPolyIndexes.push_back(polyIndex);
+				}
+				if (isAnyVertexInBack && isAnyVertexInFront)
+				{
+					numStraddlingPolys++;
+				}
+			}
+
+			// A split that leaves every poly on one side makes no progress
+			if ((int)backPolyIndexes.size() == numPolys || (int)frontPolyIndexes.size() == numPolys)
+			{
+				continue;
+			}
+
+			int imbalance = (int)backPolyIndexes.size() - (int)frontPolyIndexes.size();
+			int cost = STRADDLING_POLY_COST * numStraddlingPolys + (imbalance < 0 ? -imbalance : imbalance);
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestSplitPlane = candidatePlane;
+				bestBackPolyIndexes.swap(backPolyIndexes);
+				bestFrontPolyIndexes.swap(frontPolyIndexes);
+			}
+		}
+	}
+
+	if (bestCost == INT_MAX)
+	{
+		m_nodes[nodeIndex].m_firstPolyIndex = (int)m_polyIndexes.size();
+		m_nodes[nodeIndex].m_numPolys = numPolys;
+		m_polyIndexes.insert(m_polyIndexes.end(), polyIndexes.begin(), polyIndexes.end());
+		return;
+	}
+
+	int backChildIndex = (int)m_nodes.size();
+	m_nodes.push_back(BSP2TreeNode());
+	m_nodes.push_back(BSP2TreeNode());
+	m_nodes[nodeIndex].m_splitPlane = bestSplitPlane;
+	m_nodes[nodeIndex].m_childIndexes[0] = backChildIndex;
+	m_nodes[nodeIndex].m_childIndexes[1] = backChildIndex + 1;
+
+	BuildSubtree(backChildIndex, bestBackPolyIndexes, depth + 1, polyVertexes, convexHulls);
+	BuildSubtree(backChildIndex + 1, bestFrontPolyIndexes, depth + 1, polyVertexes, convexHulls);
+}
+
+RaycastResult2D BSP2Tree::RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, int& out_numNodesVisited, bool stopAtFirstHit) const
+{
+	RaycastResult2D closestResult;
+	closestResult.m_rayStartPosition = startPos;
+	closestResult.m_rayForwardNormal = fwdNormal;
+	closestResult.m_impactDistance = FLT_MAX;
+
+	if (m_nodes.empty())
+	{
+		return closestResult;
+	}
+
+	// Stack of nodes still to visit with the part of the ray inside each, the near side is always pushed last
+	int nodeStack[MAX_TREE_TRAVERSAL_DEPTH];
+	float nodeMinDistanceStack[MAX_TREE_TRAVERSAL_DEPTH];
+	float nodeMaxDistanceStack[MAX_TREE_TRAVERSAL_DEPTH];
+	int stackSize = 0;
+	nodeStack[stackSize] = 0;
+	nodeMinDistanceStack[stackSize] = 0.f;
+	nodeMaxDistanceStack[stackSize] = maxDistance;
+	stackSize++;
+
+	while (stackSize > 0)
+	{
+		stackSize--;
+		float minDistance = nodeMinDistanceStack[stackSize];
+		float maxDistanceInNode = nodeMaxDistanceStack[stackSize];
+		if (minDistance > closestResult.m_impactDistance)
+		{
+			continue;
+		}
+
+		out_numNodesVisited++;
+		BSP2TreeNode const& node = m_nodes[nodeStack[stackSize]];
+		if (node.IsLeaf())
+		{
+			for (int polyIndexIdx = node.m_firstPolyIndex; polyIndexIdx < node.m_firstPolyIndex + node.m_numPolys; polyIndexIdx++)
+			{
+				out_numHullTests++;
+				RaycastResult2D raycastVsConvexHullResult = raycastVsHull(m_polyIndexes[polyIndexIdx], startPos, fwdNormal, maxDistance);
+				if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+				{
+					closestResult = raycastVsConvexHullResult;
+					if (stopAtFirstHit)
+					{
+						return closestResult;
+					}
+				}
+			}
+
+			// Every node left on the stack starts beyond this one, so a hit within this node is the closest
+			if (closestResult.m_impactDistance <= maxDistanceInNode)
+			{
+				break;
+			}
+			continue;
+		}
+
+		float startAltitude = DotProduct2D(node.m_splitPlane.m_normal, startPos) - node.m_splitPlane.m_distanceFromOriginAlongNormal;
+		float fwdDotNormal = DotProduct2D(node.m_splitPlane.m_normal, fwdNormal);
+		int nearChildIdx = (startAltitude > 0.f || (startAltitude == 0.f && fwdDotNormal >= 0.f)) ? 1 : 0;
+		int nearChildIndex = node.m_childIndexes[nearChildIdx];
+		int farChildIndex = node.m_childIndexes[1 - nearChildIdx];
+
+		float splitDistance = fwdDotNormal != 0.f ? -startAltitude / fwdDotNormal : -1.f;
+		if (splitDistance <= 0.f || splitDistance > maxDistanceInNode)
+		{
+			// Ray never crosses the split plane within this node
+			nodeStack[stackSize] = nearChildIndex;
+			nodeMinDistanceStack[stackSize] = minDistance;
+			nodeMaxDistanceStack[stackSize] = maxDistanceInNode;
+			stackSize++;
+		}
+		else if (splitDistance < minDistance)
+		{
+			nodeStack[stackSize] = farChildIndex;
+			nodeMinDistanceStack[stackSize] = minDistance;
+			nodeMaxDistanceStack[stackSize] = maxDistanceInNode;
+			stackSize++;
+		}
+		else
+		{
+			nodeStack[stackSize] = farChildIndex;
+			nodeMinDistanceStack[stackSize] = splitDistance;
+			nodeMaxDistanceStack[stackSize] = maxDistanceInNode;
+			stackSize++;
+			nodeStack[stackSize] = nearChildIndex;
+			nodeMinDistanceStack[stackSize] = minDistance;
+			nodeMaxDistanceStack[stackSize] = splitDistance;
+			stackSize++;
+		}
+	}
+
+	return closestResult;
+}
+
+void BSP2Tree::AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	if (m_nodes.empty())
+	{
+		return;
+	}
+
+	std::vector<Plane2> regionPlanes;
+	AddVertsForSubtreeDebugDraw(0, regionPlanes, verts, lineThickness, color);
+}
+
+void BSP2Tree::AddVertsForSubtreeDebugDraw(int nodeIndex, std::vector<Plane2>& regionPlanes, std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	BSP2TreeNode const& node = m_nodes[nodeIndex];
+	if (node.IsLeaf())
+	{
+		return;
+	}
+
+	// Clip the split line to the region left by the ancestors' split planes
+	constexpr float HALF_LINE_LENGTH = 1000.f;
+	Vec2 lineCenter = node.m_splitPlane.m_normal * node.m_splitPlane.m_distanceFromOriginAlongNormal;
+	Vec2 lineDirection = node.m_splitPlane.m_normal.GetRotated90Degrees();
+	float minLineDistance = -HALF_LINE_LENGTH;
+	float maxLineDistance = HALF_LINE_LENGTH;
+	for (int planeIndex = 0; planeIndex < (int)regionPlanes.size(); planeIndex++)
+	{
+		float centerAltitude = DotProduct2D(regionPlanes[planeIndex].m_normal, lineCenter) - regionPlanes[planeIndex].m_distanceFromOriginAlongNormal;
+		float directionDotNormal = DotProduct2D(regionPlanes[planeIndex].m_normal, lineDirection);
+		if (directionDotNormal == 0.f)
+		{
+			maxLineDistance = centerAltitude > 0.f ? minLineDistance : maxLineDistance;
+			continue;
+		}
+		float crossingDistance = -centerAltitude / directionDotNormal;
+		if (directionDotNormal > 0.f)
+		{
+			maxLineDistance = fminf(maxLineDistance, crossingDistance);
+		}
+		else
+		{
+			minLineDistance = fmaxf(minLineDistance, crossingDistance);
+		}
+	}
+	if (minLineDistance < maxLineDistance)
+	{
+		AddVertsForLineSegment2D(verts, lineCenter + lineDirection * minLineDistance, lineCenter + lineDirection * maxLineDistance, lineThickness, color);
+	}
+
+	// Region planes point away from the region, so the back child keeps the split plane and the front child flips it
+	regionPlanes.push_back(node.m_splitPlane);
+	AddVertsForSubtreeDebugDraw(node.m_childIndexes[0], regionPlanes, verts, lineThickness, color);
+	regionPlanes.back().m_normal = -node.m_splitPlane.m_normal;
+	regionPlanes.back().m_distanceFromOriginAlongNormal = -node.m_splitPlane.m_distanceFromOriginAlongNormal;
+	AddVertsForSubtreeDebugDraw(node.m_childIndexes[1], regionPlanes, verts, lineThickness, color);
+	regionPlanes.pop_back();
+}
+
+uint32_t BSP2Tree::AppendToWriter(BufferWriter& writer) const
+{
+	uint32_t payloadSize = 0;
+	writer.AppendUint32((uint32_t)m_nodes.size());
+	payloadSize += sizeof(uint32_t);
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		BSP2TreeNode const& node = m_nodes[nodeIndex];
+		writer.AppendVec2(node.m_splitPlane.m_normal);
+		payloadSize += sizeof(Vec2);
+		writer.AppendFloat(node.m_splitPlane.m_distanceFromOriginAlongNormal);
+		payloadSize += sizeof(float);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[0]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[1]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUint32((uint32_t)node.m_firstPolyIndex);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUShort((uint16_t)node.m_numPolys);
+		payloadSize += sizeof(uint16_t);
+	}
+	writer.AppendUint32((uint32_t)m_polyIndexes.size());
+	payloadSize += sizeof(uint32_t);
+	for (int polyIndexIdx = 0; polyIndexIdx < (int)m_polyIndexes.size(); polyIndexIdx++)
+	{
+		writer.AppendUShort((uint16_t)m_polyIndexes[polyIndexIdx]);
+		payloadSize += sizeof(uint16_t);
+	}
+
+	return payloadSize;
+}
+
+bool BSP2Tree::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	uint32_t numNodes = parser.ParseUint32();
+	for (uint32_t nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		BSP2TreeNode node;
+		node.m_splitPlane.m_normal = parser.ParseVec2();
+		node.m_splitPlane.m_distanceFromOriginAlongNormal = parser.ParseFloat();
+		node.m_childIndexes[0] = (int)parser.ParseUint32();
+		node.m_childIndexes[1] = (int)parser.ParseUint32();
+		node.m_firstPolyIndex = (int)parser.ParseUint32();
+		node.m_numPolys = parser.ParseUShort();
+		m_nodes.push_back(node);
+	}
+	uint32_t numPolyIndexes = parser.ParseUint32();
+	for (uint32_t polyIndexIdx = 0; polyIndexIdx < numPolyIndexes; polyIndexIdx++)
+	{
+		m_polyIndexes.push_back(parser.ParseUShort());
+	}
+
+	if (!AreTreeIndexesValid(m_nodes, m_polyIndexes, numPolys, MAX_TREE_TRAVERSAL_DEPTH - 1))
+	{
+		Clear();
+		return false;
+	}
+
+	return true;
+}
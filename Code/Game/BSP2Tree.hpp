@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Game/HullRaycastFunction.hpp"
+
+#include "Engine/Math/ConvexHull2.hpp"
+#include "Engine/Math/ConvexPoly2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct RaycastResult2D;
+struct Vertex_PCU;
+struct Rgba8;
+class BufferParser;
+class BufferWriter;
+
+
+struct BSP2TreeNode
+{
+public:
+	bool IsLeaf() const { return m_childIndexes[0] == -1; }
+
+public:
+	Plane2 m_splitPlane;
+	// Back (behind the split plane) then front child
+	int m_childIndexes[2] = { -1, -1 };
+	int m_firstPolyIndex = 0;
+	int m_numPolys = 0;
+};
+
+class BSP2Tree
+{
+public:
+	~BSP2Tree() = default;
+	BSP2Tree() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys, std::vector<ConvexHull2> const& convexHulls);
+	void Clear();
+	bool IsEmpty() const { return m_nodes.empty(); }
+
+	RaycastResult2D RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, int& out_numNodesVisited, bool stopAtFirstHit = false) const;
+
+	void AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+private:
+	void BuildSubtree(int nodeIndex, std::vector<int> const& polyIndexes, int depth, std::vector<std::vector<Vec2>> const& polyVertexes, std::vector<ConvexHull2> const& convexHulls);
+	void AddVertsForSubtreeDebugDraw(int nodeIndex, std::vector<Plane2>& regionPlanes, std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+public:
+	static constexpr int MAX_POLYS_PER_LEAF = 2;
+	static constexpr int MAX_SPLIT_CANDIDATES = 16;
+	// Splitting a poly costs more than an unbalanced split, since it is tested again on both sides
+	static constexpr int STRADDLING_POLY_COST = 4;
+	static constexpr float PLANE_THICKNESS = 0.001f;
+
+	std::vector<BSP2TreeNode> m_nodes;
+	// Polys straddling a split plane are listed in every leaf they reach
+	std::vector<int> m_polyIndexes;
+};
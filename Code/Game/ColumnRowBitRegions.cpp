@@ -0,0 +1,295 @@
+#include "Game/ColumnRowBitRegions.hpp"
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+
+
+void ColumnRowBitRegions::Build(std::vector<ConvexPoly2> const& convexPolys, AABB2 const& bounds, int numColumns)
+{
+	Clear();
+
+	// Rows are sized to keep cells roughly square
+	Vec2 boundsDimensions = bounds.GetDimensions();
+	m_bounds = bounds;
+	m_numColumns = numColumns < 1 ? 1 : (numColumns > MAX_COLUMNS ? MAX_COLUMNS : numColumns);
+	m_numRows = (int)(m_numColumns * boundsDimensions.y / boundsDimensions.x + 0.5f);
+	m_numRows = m_numRows < 1 ? 1 : (m_numRows > MAX_COLUMNS ? MAX_COLUMNS : m_numRows);
+
+	int numPolys = (int)convexPolys.size();
+	m_numWordsPerMask = (numPolys + 63) / 64;
+	m_columnMasks.resize(m_numColumns * m_numWordsPerMask, 0ull);
+	m_rowMasks.resize(m_numRows * m_numWordsPerMask, 0ull);
+	m_outsideBoundsMask.resize(m_numWordsPerMask, 0ull);
+
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		std::vector<Vec2> const vertexes = convexPolys[polyIndex].GetVertexes();
+		AABB2 polyBounds(vertexes[0], vertexes[0]);
+		for (int vertexIndex = 1; vertexIndex < (int)vertexes.size(); vertexIndex++)
+		{
+			polyBounds.m_mins.x = fminf(polyBounds.m_mins.x, vertexes[vertexIndex].x);
+			polyBounds.m_mins.y = fminf(polyBounds.m_mins.y, vertexes[vertexIndex].y);
+			polyBounds.m_maxs.x = fmaxf(polyBounds.m_maxs.x, vertexes[vertexIndex].x);
+			polyBounds.m_maxs.y = fmaxf(polyBounds.m_maxs.y, vertexes[vertexIndex].y);
+		}
+
+		int wordIndex = polyIndex / 64;
+		uint64_t polyBit = 1ull << (polyIndex % 64);
+		if (polyBounds.m_mins.x < m_bounds.m_mins.x || polyBounds.m_mins.y < m_bounds.m_mins.y || polyBounds.m_maxs.x > m_bounds.m_maxs.x || polyBounds.m_maxs.y > m_bounds.m_maxs.y)
+		{
+			m_outsideBoundsMask[wordIndex] |= polyBit;
+			continue;
+		}
+
+		for (int column = GetColumnForX(polyBounds.m_mins.x); column <= GetColumnForX(polyBounds.m_maxs.x); column++)
+		{
+			m_columnMasks[column * m_numWordsPerMask + wordIndex] |= polyBit;
+		}
+		for (int row = GetRowForY(polyBounds.m_mins.y); row <= GetRowForY(polyBounds.m_maxs.y); row++)
+		{
+			m_rowMasks[row * m_numWordsPerMask + wordIndex] |= polyBit;
+		}
+	}
+}
+
+void ColumnRowBitRegions::Clear()
+{
+	m_numColumns = 0;
+	m_numRows = 0;
+	m_numWordsPerMask = 0;
+	m_columnMasks.clear();
+	m_rowMasks.clear();
+	m_outsideBoundsMask.clear();
+}
+
+int ColumnRowBitRegions::GetColumnForX(float x) const
+{
+	int column = (int)((x - m_bounds.m_mins.x) / (m_bounds.m_maxs.x - m_bounds.m_mins.x) * (float)m_numColumns);
+	return column < 0 ? 0 : (column >= m_numColumns ? m_numColumns - 1 : column);
+}
+
+int ColumnRowBitRegions::GetRowForY(float y) const
+{
+	int row = (int)((y - m_bounds.m_mins.y) / (m_bounds.m_maxs.y - m_bounds.m_mins.y) * (float)m_numRows);
+	return row < 0 ? 0 : (row >= m_numRows ? m_numRows - 1 : row);
+}
+
+void ColumnRowBitRegions::GetCandidatePolyMaskForRaycast(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, uint64_t* out_candidateMask) const
+{
+	for (int wordIndex = 0; wordIndex < m_numWordsPerMask; wordIndex++)
+	{
+		out_candidateMask[wordIndex] = m_outsideBoundsMask[wordIndex];
+	}
+
+	// Clip the ray to the region bounds
+	float entryDistance = 0.f;
+	float exitDistance = maxDistance;
+	for (int axis = 0; axis < 2; axis++)
+	{
+		float start = axis == 0 ? startPos.x : startPos.y;
+		float fwd = axis == 0 ? fwdNormal.x : fwdNormal.y;
+		float boundsMin = axis == 0 ? m_bounds.m_mins.x : m_bounds.m_mins.y;
+		float boundsMax = axis == 0 ? m_bounds.m_maxs.x : m_bounds.m_maxs.y;
+		if (fwd == 0.f)
+		{
+			if (start < boundsMin || start > boundsMax)
+			{
+				return;
+			}
+			continue;
+		}
+		float minPlaneDistance = (boundsMin - start) / fwd;
+		float maxPlaneDistance = (boundsMax - start) / fwd;
+		entryDistance = fmaxf(entryDistance, fminf(minPlaneDistance, maxPlaneDistance));
+		exitDistance = fminf(exitDistance, fmaxf(minPlaneDistance, maxPlaneDistance));
+	}
+	if (entryDistance > exitDistance)
+	{
+		return;
+	}
+
+	// For each column the ray crosses, the polys it can reach are that column's mask AND the OR of the rows the ray spans inside that column
+	Vec2 entryPos = startPos + fwdNormal * entryDistance;
+	Vec2 exitPos = startPos + fwdNormal * exitDistance;
+	float columnWidth = (m_bounds.m_maxs.x - m_bounds.m_mins.x) / (float)m_numColumns;
+	int firstColumn = GetColumnForX(entryPos.x);
+	int lastColumn = GetColumnForX(exitPos.x);
+	int columnStep = lastColumn >= firstColumn ? 1 : -1;
+	float deltaX = exitPos.x - entryPos.x;
+	for (int column = firstColumn; ; column += columnStep)
+	{
+		float columnMinX = m_bounds.m_mins.x + (float)column * columnWidth;
+		float segmentMinX = fmaxf(columnMinX, fminf(entryPos.x, exitPos.x));
+		float segmentMaxX = fminf(columnMinX + columnWidth, fmaxf(entryPos.x, exitPos.x));
+		float yAtSegmentMinX = entryPos.y;
+		float yAtSegmentMaxX = exitPos.y;
+		if (deltaX != 0.f)
+		{
+			yAtSegmentMinX = entryPos.y + (segmentMinX - entryPos.x) * (exitPos.y - entryPos.y) / deltaX;
+			yAtSegmentMaxX = entryPos.y + (segmentMaxX - entryPos.x) * (exitPos.y - entryPos.y) / deltaX;
+		}
+		int firstRow = GetRowForY(fminf(yAtSegmentMinX, yAtSegmentMaxX));
+		int lastRow = GetRowForY(fmaxf(yAtSegmentMinX, yAtSegmentMaxX));
+
+		uint64_t const* columnMask = &m_columnMasks[column * m_numWordsPerMask];
+		for (int wordIndex = 0; wordIndex < m_numWordsPerMask; wordIndex++)
+		{
+			if (columnMask[wordIndex] == 0ull)
+			{
+				continue;
+			}
+			uint64_t rowsMask = 0ull;
+			for (int row = firstRow; row <= lastRow; row++)
+			{
+				rowsMask |= m_rowMasks[row * m_numWordsPerMask + wordIndex];
+			}
+			out_candidateMask[wordIndex] |= columnMask[wordIndex] & rowsMask;
+		}
+
+		if (column == lastColumn)
+		{
+			break;
+		}
+	}
+}
+
+RaycastResult2D ColumnRowBitRegions::RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, std::vector<uint64_t>& candidateMaskScratch, int& out_numHullTests, bool stopAtFirstHit) const
+{
+	RaycastResult2D closestResult;
+	closestResult.m_rayStartPosition = startPos;
+	closestResult.m_rayForwardNormal = fwdNormal;
+	closestResult.m_impactDistance = FLT_MAX;
+
+	if (m_numWordsPerMask == 0)
+	{
+		return closestResult;
+	}
+
+	// The scratch mask is reserved by the caller, so resizing it stays off the heap
+	candidateMaskScratch.resize(m_numWordsPerMask);
+	GetCandidatePolyMaskForRaycast(startPos, fwdNormal, maxDistance, candidateMaskScratch.data());
+
+	for (int wordIndex = 0; wordIndex < m_numWordsPerMask; wordIndex++)
+	{
+		uint64_t candidateWord = candidateMaskScratch[wordIndex];
+		for (int bitIndex = 0; candidateWord != 0ull; bitIndex++, candidateWord >>= 1)
+		{
+			if ((candidateWord & 1ull) == 0ull)
+			{
+				continue;
+			}
+
+			out_numHullTests++;
+			RaycastResult2D raycastVsConvexHullResult = raycastVsHull(wordIndex * 64 + bitIndex, startPos, fwdNormal, maxDistance);
+			if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+			{
+				closestResult = raycastVsConvexHullResult;
+				if (stopAtFirstHit)
+				{
+					return closestResult;
+				}
+			}
+		}
+	}
+
+	return closestResult;
+}
+
+void ColumnRowBitRegions::AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	for (int column = 0; column <= m_numColumns; column++)
+	{
+		float x = m_bounds.m_mins.x + (float)column * (m_bounds.m_maxs.x - m_bounds.m_mins.x) / (float)m_numColumns;
+		AddVertsForLineSegment2D(verts, Vec2(x, m_bounds.m_mins.y), Vec2(x, m_bounds.m_maxs.y), lineThickness, color);
+	}
+	for (int row = 0; row <= m_numRows; row++)
+	{
+		float y = m_bounds.m_mins.y + (float)row * (m_bounds.m_maxs.y - m_bounds.m_mins.y) / (float)m_numRows;
+		AddVertsForLineSegment2D(verts, Vec2(m_bounds.m_mins.x, y), Vec2(m_bounds.m_maxs.x, y), lineThickness, color);
+	}
+}
+
+uint32_t ColumnRowBitRegions::AppendToWriter(BufferWriter& writer) const
+{
+	uint32_t payloadSize = 0;
+	writer.AppendVec2(m_bounds.m_mins);
+	payloadSize += sizeof(Vec2);
+	writer.AppendVec2(m_bounds.m_maxs);
+	payloadSize += sizeof(Vec2);
+	writer.AppendUShort((uint16_t)m_numColumns);
+	payloadSize += sizeof(uint16_t);
+	writer.AppendUShort((uint16_t)m_numRows);
+	payloadSize += sizeof(uint16_t);
+	for (int maskWordIndex = 0; maskWordIndex < (int)m_columnMasks.size(); maskWordIndex++)
+	{
+		writer.AppendUint64(m_columnMasks[maskWordIndex]);
+		payloadSize += sizeof(uint64_t);
+	}
+	for (int maskWordIndex = 0; maskWordIndex < (int)m_rowMasks.size(); maskWordIndex++)
+	{
+		writer.AppendUint64(m_rowMasks[maskWordIndex]);
+		payloadSize += sizeof(uint64_t);
+	}
+	for (int maskWordIndex = 0; maskWordIndex < (int)m_outsideBoundsMask.size(); maskWordIndex++)
+	{
+		writer.AppendUint64(m_outsideBoundsMask[maskWordIndex]);
+		payloadSize += sizeof(uint64_t);
+	}
+
+	return payloadSize;
+}
+
+bool ColumnRowBitRegions::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	m_bounds.m_mins = parser.ParseVec2();
+	m_bounds.m_maxs = parser.ParseVec2();
+	int numColumns = parser.ParseUShort();
+	int numRows = parser.ParseUShort();
+	if (numColumns < 1 || numColumns > MAX_COLUMNS || numRows < 1 || numRows > MAX_COLUMNS || !(m_bounds.m_maxs.x > m_bounds.m_mins.x) || !(m_bounds.m_maxs.y > m_bounds.m_mins.y))
+	{
+		return false;
+	}
+
+	m_numColumns = numColumns;
+	m_numRows = numRows;
+	m_numWordsPerMask = (numPolys + 63) / 64;
+	m_columnMasks.resize(m_numColumns * m_numWordsPerMask);
+	m_rowMasks.resize(m_numRows * m_numWordsPerMask);
+	m_outsideBoundsMask.resize(m_numWordsPerMask);
+	for (int maskWordIndex = 0; maskWordIndex < (int)m_columnMasks.size(); maskWordIndex++)
+	{
+		m_columnMasks[maskWordIndex] = parser.ParseUint64();
+	}
+	for (int maskWordIndex = 0; maskWordIndex < (int)m_rowMasks.size(); maskWordIndex++)
+	{
+		m_rowMasks[maskWordIndex] = parser.ParseUint64();
+	}
+	for (int maskWordIndex = 0; maskWordIndex < (int)m_outsideBoundsMask.size(); maskWordIndex++)
+	{
+		m_outsideBoundsMask[maskWordIndex] = parser.ParseUint64();
+	}
+
+	// Bits past the last poly would index outside the hull array during raycasts
+	if (numPolys % 64 != 0)
+	{
+		uint64_t unusedBitsMask = ~((1ull << (numPolys % 64)) - 1ull);
+		int lastWordIndex = m_numWordsPerMask - 1;
+		bool hasUnusedBitsSet = (m_outsideBoundsMask[lastWordIndex] & unusedBitsMask) != 0ull;
+		for (int column = 0; column < m_numColumns; column++)
+		{
+			hasUnusedBitsSet = hasUnusedBitsSet || (m_columnMasks[column * m_numWordsPerMask + lastWordIndex] & unusedBitsMask) != 0ull;
+		}
+		if (hasUnusedBitsSet)
+		{
+			Clear();
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Game/HullRaycastFunction.hpp"
+
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/ConvexHull2.hpp"
+#include "Engine/Math/ConvexPoly2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct RaycastResult2D;
+struct Vertex_PCU;
+struct Rgba8;
+class BufferParser;
+class BufferWriter;
+
+
+class ColumnRowBitRegions
+{
+public:
+	~ColumnRowBitRegions() = default;
+	ColumnRowBitRegions() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys, AABB2 const& bounds, int numColumns);
+	void Clear();
+	bool IsEmpty() const { return m_numColumns == 0; }
+
+	RaycastResult2D RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, std::vector<uint64_t>& candidateMaskScratch, int& out_numHullTests, bool stopAtFirstHit = false) const;
+	void GetCandidatePolyMaskForRaycast(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, uint64_t* out_candidateMask) const;
+
+	void AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+private:
+	int GetColumnForX(float x) const;
+	int GetRowForY(float y) const;
+
+public:
+	static constexpr int MAX_COLUMNS = 4096;
+
+	AABB2 m_bounds;
+	int m_numColumns = 0;
+	int m_numRows = 0;
+	// Each mask holds one bit per poly, spread over m_numWordsPerMask 64-bit words
+	int m_numWordsPerMask = 0;
+	std::vector<uint64_t> m_columnMasks;
+	std::vector<uint64_t> m_rowMasks;
+	// Polys reaching outside m_bounds are tested by every ray, since rays are clipped to m_bounds
+	std::vector<uint64_t> m_outsideBoundsMask;
+};
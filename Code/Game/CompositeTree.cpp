@@ -0,0 +1,343 @@
+#include "Game/CompositeTree.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/OBB2Tree.hpp"
+#include "Game/TreeUtils.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+
+#include <algorithm>
+
+
+void CompositeTree::Build(std::vector<ConvexPoly2> const& convexPolys)
+{
+	Clear();
+
+	int numPolys = (int)convexPolys.size();
+	if (numPolys == 0)
+	{
+		return;
+	}
+
+	std::vector<std::vector<Vec2>> polyVertexes;
+	std::vector<Vec2> polyCenters;
+	polyVertexes.reserve(numPolys);
+	polyCenters.reserve(numPolys);
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		polyVertexes.push_back(convexPolys[polyIndex].GetVertexes());
+		Vec2 center = Vec2::ZERO;
+		for (int vertexIndex = 0; vertexIndex < (int)polyVertexes[polyIndex].size(); vertexIndex++)
+		{
+			center += polyVertexes[polyIndex][vertexIndex];
+		}
+		center /= (float)polyVertexes[polyIndex].size();
+		polyCenters.push_back(center);
+		m_polyIndexes.push_back(polyIndex);
+	}
+
+	m_nodes.reserve(2 * numPolys / MAX_POLYS_PER_LEAF + 1);
+	m_nodes.push_back(CompositeTreeNode());
+	BuildSubtree(0, 0, numPolys, polyVertexes, polyCenters);
+}
+
+void CompositeTree::Clear()
+{
+	m_nodes.clear();
+	m_discCenters.clear();
+	m_discRadii.clear();
+	m_aabbs.clear();
+	m_obbs.clear();
+	m_polyIndexes.clear();
+}
+
+int CompositeTree::GetNumNodesWithBoundsType(CompositeBoundsType boundsType) const
+{
+	switch (boundsType)
+	{
+		case CompositeBoundsType::DISC:		return (int)m_discCenters.size();
+		case CompositeBoundsType::AABB2:	return (int)m_aabbs.size();
+		case CompositeBoundsType::OBB2:		return (int)m_obbs.size();
+	}
+
+	return 0;
+}
+
+void CompositeTree::BuildSubtree(int nodeIndex, int firstPolyIndex, int numPolys, std::vector<std::vector<Vec2>> const& polyVertexes, std::vector<Vec2> const& polyCenters)
+{
+	std::vector<Vec2> nodePoints;
+	AABB2 centroidBounds(polyCenters[m_polyIndexes[firstPolyIndex]], polyCenters[m_polyIndexes[firstPolyIndex]]);
+	for (int polyIndexIdx = firstPolyIndex; polyIndexIdx < firstPolyIndex + numPolys; polyIndexIdx++)
+	{
+		std::vector<Vec2> const& vertexes = polyVertexes[m_polyIndexes[polyIndexIdx]];
+		nodePoints.insert(nodePoints.end(), vertexes.begin(), vertexes.end());
+
+		Vec2 const& center = polyCenters[m_polyIndexes[polyIndexIdx]];
+		centroidBounds.m_mins.x = fminf(centroidBounds.m_mins.x, center.x);
+		centroidBounds.m_mins.y = fminf(centroidBounds.m_mins.y, center.y);
+		centroidBounds.m_maxs.x = fmaxf(centroidBounds.m_maxs.x, center.x);
+		centroidBounds.m_maxs.y = fmaxf(centroidBounds.m_maxs.y, center.y);
+	}
+	SetNodeBounds(m_nodes[nodeIndex], nodePoints);
+
+	if (numPolys <= MAX_POLYS_PER_LEAF)
+	{
+		m_nodes[nodeIndex].m_firstPolyIndex = firstPolyIndex;
+		m_nodes[nodeIndex].m_numPolys = numPolys;
+		return;
+	}
+
+	Vec2 centroidDimensions = centroidBounds.m_maxs - centroidBounds.m_mins;
+	bool splitAlongX = centroidDimensions.x >= centroidDimensions.y;
+	int numPolysOnLeft = numPolys / 2;
+	std::vector<int>::iterator rangeBegin = m_polyIndexes.begin() + firstPolyIndex;
+	std::nth_element(rangeBegin, rangeBegin + numPolysOnLeft, rangeBegin + numPolys, [&polyCenters, splitAlongX](int polyIndexA, int polyIndexB)
+	{
+		return splitAlongX ? polyCenters[polyIndexA].x < polyCenters[polyIndexB].x : polyCenters[polyIndexA].y < polyCenters[polyIndexB].y;
+	});
+
+	int leftChildIndex = (int)m_nodes.size();
+	m_nodes.push_back(CompositeTreeNode());
+	m_nodes.push_back(CompositeTreeNode());
+	m_nodes[nodeIndex].m_childIndexes[0] = leftChildIndex;
+	m_nodes[nodeIndex].m_childIndexes[1] = leftChildIndex + 1;
+
+	BuildSubtree(leftChildIndex, firstPolyIndex, numPolysOnLeft, polyVertexes, polyCenters);
+	BuildSubtree(leftChildIndex + 1, firstPolyIndex + numPolysOnLeft, numPolys - numPolysOnLeft, polyVertexes, polyCenters);
+}
+
+void CompositeTree::SetNodeBounds(CompositeTreeNode& node, std::vector<Vec2> const& points)
+{
+	AABB2 box(points[0], points[0]);
+	for (int pointIndex = 1; pointIndex < (int)points.size(); pointIndex++)
+	{
+		box.m_mins.x = fminf(box.m_mins.x, points[pointIndex].x);
+		box.m_mins.y = fminf(box.m_mins.y, points[pointIndex].y);
+		box.m_maxs.x = fmaxf(box.m_maxs.x, points[pointIndex].x);
+		box.m_maxs.y = fmaxf(box.m_maxs.y, points[pointIndex].y);
+	}
+
+	Vec2 discCenter = (box.m_mins + box.m_maxs) * 0.5f;
+	float discRadius = 0.f;
+	for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+	{
+		discRadius = fmaxf(discRadius, GetDistance2D(discCenter, points[pointIndex]));
+	}
+
+	OBB2 orientedBox = GetTightOBB2ForPoints(points);
+
+	// A random line crosses a convex shape with probability proportional to its perimeter,
+	// so expected cost of a node is its test cost scaled by its perimeter
+	Vec2 boxDimensions = box.GetDimensions();
+	float discCost = DISC_TEST_COST * 2.f * 3.14159265f * discRadius;
+	float aabbCost = AABB2_TEST_COST * 2.f * (boxDimensions.x + boxDimensions.y);
+	float obbCost = OBB2_TEST_COST * 4.f * (orientedBox.m_halfDimensions.x + orientedBox.m_halfDimensions.y);
+
+	if (discCost <= aabbCost && discCost <= obbCost)
+	{
+		node.m_boundsType = CompositeBoundsType::DISC;
+		node.m_boundsIndex = (int)m_discCenters.size();
+		m_discCenters.push_back(discCenter);
+		m_discRadii.push_back(discRadius);
+	}
+	else if (aabbCost <= obbCost)
+	{
+		node.m_boundsType = CompositeBoundsType::AABB2;
+		node.m_boundsIndex = (int)m_aabbs.size();
+		m_aabbs.push_back(box);
+	}
+	else
+	{
+		node.m_boundsType = CompositeBoundsType::OBB2;
+		node.m_boundsIndex = (int)m_obbs.size();
+		m_obbs.push_back(orientedBox);
+	}
+}
+
+bool CompositeTree::GetRayEntryDistanceVsNodeBounds(CompositeTreeNode const& node, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, float& out_entryDistance) const
+{
+	switch (node.m_boundsType)
+	{
+		case CompositeBoundsType::DISC:		return GetRayEntryDistanceVsDisc2D(startPos, fwdNormal, maxDistance, m_discCenters[node.m_boundsIndex], m_discRadii[node.m_boundsIndex], out_entryDistance);
+		case CompositeBoundsType::AABB2:	return GetRayEntryDistanceVsAABB2(startPos, fwdNormal, maxDistance, m_aabbs[node.m_boundsIndex], out_entryDistance);
+		case CompositeBoundsType::OBB2:		return GetRayEntryDistanceVsOBB2(startPos, fwdNormal, maxDistance, m_obbs[node.m_boundsIndex], out_entryDistance);
+	}
+
+	return false;
+}
+
+RaycastResult2D CompositeTree::RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit) const
+{
+	RaycastResult2D closestResult;
+	closestResult.m_rayStartPosition = startPos;
+	closestResult.m_rayForwardNormal = fwdNormal;
+	closestResult.m_impactDistance = FLT_MAX;
+
+	auto getEntryDistance = [this, &startPos, &fwdNormal, maxDistance](int nodeIndex, float& out_entryDistance)
+	{
+		return GetRayEntryDistanceVsNodeBounds(m_nodes[nodeIndex], startPos, fwdNormal, maxDistance, out_entryDistance);
+	};
+	auto visitNode = [this, &startPos, &fwdNormal, maxDistance, &raycastVsHull, stopAtFirstHit, &closestResult, &out_numHullTests](int nodeIndex, float& inout_cutoffDistance)
+	{
+		CompositeTreeNode const& node = m_nodes[nodeIndex];
+		if (!node.IsLeaf())
+		{
+			return true;
+		}
+
+		for (int polyIndexIdx = node.m_firstPolyIndex; polyIndexIdx < node.m_firstPolyIndex + node.m_numPolys; polyIndexIdx++)
+		{
+			out_numHullTests++;
+			RaycastResult2D raycastVsConvexHullResult = raycastVsHull(m_polyIndexes[polyIndexIdx], startPos, fwdNormal, maxDistance);
+			if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+			{
+				closestResult = raycastVsConvexHullResult;
+				if (stopAtFirstHit)
+				{
+					inout_cutoffDistance = -1.f;
+					return false;
+				}
+			}
+		}
+		inout_cutoffDistance = closestResult.m_impactDistance;
+		return false;
+	};
+	TraverseTreeNearestFirst<MAX_TREE_TRAVERSAL_DEPTH>(m_nodes, 0, getEntryDistance, visitNode);
+
+	return closestResult;
+}
+
+void CompositeTree::AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	for (int discIndex = 0; discIndex < (int)m_discCenters.size(); discIndex++)
+	{
+		AddVertsForRing2D(verts, m_discCenters[discIndex], m_discRadii[discIndex], lineThickness, color);
+	}
+	for (int boxIndex = 0; boxIndex < (int)m_aabbs.size(); boxIndex++)
+	{
+		AABB2 const& bounds = m_aabbs[boxIndex];
+		AddVertsForLineSegment2D(verts, bounds.m_mins, Vec2(bounds.m_maxs.x, bounds.m_mins.y), lineThickness, color);
+		AddVertsForLineSegment2D(verts, Vec2(bounds.m_maxs.x, bounds.m_mins.y), bounds.m_maxs, lineThickness, color);
+		AddVertsForLineSegment2D(verts, bounds.m_maxs, Vec2(bounds.m_mins.x, bounds.m_maxs.y), lineThickness, color);
+		AddVertsForLineSegment2D(verts, Vec2(bounds.m_mins.x, bounds.m_maxs.y), bounds.m_mins, lineThickness, color);
+	}
+	for (int boxIndex = 0; boxIndex < (int)m_obbs.size(); boxIndex++)
+	{
+		OBB2 const& bounds = m_obbs[boxIndex];
+		Vec2 iExtent = bounds.m_iBasisNormal * bounds.m_halfDimensions.x;
+		Vec2 jExtent = bounds.m_iBasisNormal.GetRotated90Degrees() * bounds.m_halfDimensions.y;
+		Vec2 corners[4] = { bounds.m_center - iExtent - jExtent, bounds.m_center + iExtent - jExtent, bounds.m_center + iExtent + jExtent, bounds.m_center - iExtent + jExtent };
+		for (int cornerIndex = 0; cornerIndex < 4; cornerIndex++)
+		{
+			AddVertsForLineSegment2D(verts, corners[cornerIndex], corners[(cornerIndex + 1) % 4], lineThickness, color);
+		}
+	}
+}
+
+uint32_t CompositeTree::AppendToWriter(BufferWriter& writer) const
+{
+	uint32_t payloadSize = 0;
+	writer.AppendUint32((uint32_t)m_nodes.size());
+	payloadSize += sizeof(uint32_t);
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		// Bounds are written inline after the type byte, so each node is only as large as its volume needs
+		CompositeTreeNode const& node = m_nodes[nodeIndex];
+		writer.AppendByte((uint8_t)node.m_boundsType);
+		payloadSize += sizeof(uint8_t);
+		switch (node.m_boundsType)
+		{
+			case CompositeBoundsType::DISC:
+				writer.AppendVec2(m_discCenters[node.m_boundsIndex]);
+				writer.AppendFloat(m_discRadii[node.m_boundsIndex]);
+				payloadSize += sizeof(Vec2) + sizeof(float);
+				break;
+			case CompositeBoundsType::AABB2:
+				writer.AppendVec2(m_aabbs[node.m_boundsIndex].m_mins);
+				writer.AppendVec2(m_aabbs[node.m_boundsIndex].m_maxs);
+				payloadSize += 2 * sizeof(Vec2);
+				break;
+			case CompositeBoundsType::OBB2:
+				writer.AppendVec2(m_obbs[node.m_boundsIndex].m_center);
+				writer.AppendVec2(m_obbs[node.m_boundsIndex].m_iBasisNormal);
+				writer.AppendVec2(m_obbs[node.m_boundsIndex].m_halfDimensions);
+				payloadSize += 3 * sizeof(Vec2);
+				break;
+		}
+		writer.AppendUint32((uint32_t)node.m_childIndexes[0]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[1]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUShort((uint16_t)node.m_firstPolyIndex);
+		payloadSize += sizeof(uint16_t);
+		writer.AppendUShort((uint16_t)node.m_numPolys);
+		payloadSize += sizeof(uint16_t);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < (int)m_polyIndexes.size(); polyIndexIdx++)
+	{
+		writer.AppendUShort((uint16_t)m_polyIndexes[polyIndexIdx]);
+		payloadSize += sizeof(uint16_t);
+	}
+
+	return payloadSize;
+}
+
+bool CompositeTree::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	uint32_t numNodes = parser.ParseUint32();
+	for (uint32_t nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		CompositeTreeNode node;
+		node.m_boundsType = (CompositeBoundsType)parser.ParseByte();
+		if (node.m_boundsType == CompositeBoundsType::DISC)
+		{
+			node.m_boundsIndex = (int)m_discCenters.size();
+			m_discCenters.push_back(parser.ParseVec2());
+			m_discRadii.push_back(parser.ParseFloat());
+		}
+		else if (node.m_boundsType == CompositeBoundsType::AABB2)
+		{
+			node.m_boundsIndex = (int)m_aabbs.size();
+			AABB2 box;
+			box.m_mins = parser.ParseVec2();
+			box.m_maxs = parser.ParseVec2();
+			m_aabbs.push_back(box);
+		}
+		else if (node.m_boundsType == CompositeBoundsType::OBB2)
+		{
+			node.m_boundsIndex = (int)m_obbs.size();
+			OBB2 orientedBox;
+			orientedBox.m_center = parser.ParseVec2();
+			orientedBox.m_iBasisNormal = parser.ParseVec2();
+			orientedBox.m_halfDimensions = parser.ParseVec2();
+			m_obbs.push_back(orientedBox);
+		}
+		else
+		{
+			// Size of the remaining node data depends on a type we do not know
+			Clear();
+			return false;
+		}
+		node.m_childIndexes[0] = (int)parser.ParseUint32();
+		node.m_childIndexes[1] = (int)parser.ParseUint32();
+		node.m_firstPolyIndex = parser.ParseUShort();
+		node.m_numPolys = parser.ParseUShort();
+		m_nodes.push_back(node);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < numPolys; polyIndexIdx++)
+	{
+		m_polyIndexes.push_back(parser.ParseUShort());
+	}
+
+	if (!AreTreeIndexesValid(m_nodes, m_polyIndexes, numPolys, MAX_TREE_TRAVERSAL_DEPTH - 1))
+	{
+		Clear();
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Game/HullRaycastFunction.hpp"
+
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/ConvexHull2.hpp"
+#include "Engine/Math/ConvexPoly2.hpp"
+#include "Engine/Math/OBB2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct RaycastResult2D;
+struct Vertex_PCU;
+struct Rgba8;
+class BufferParser;
+class BufferWriter;
+
+
+enum class CompositeBoundsType : uint8_t
+{
+	DISC,
+	AABB2,
+	OBB2,
+	NUM
+};
+
+struct CompositeTreeNode
+{
+public:
+	bool IsLeaf() const { return m_numPolys > 0; }
+
+public:
+	CompositeBoundsType m_boundsType = CompositeBoundsType::AABB2;
+	// Index into the bounds array for m_boundsType
+	int m_boundsIndex = 0;
+	int m_childIndexes[2] = { -1, -1 };
+	int m_firstPolyIndex = 0;
+	int m_numPolys = 0;
+};
+
+class CompositeTree
+{
+public:
+	~CompositeTree() = default;
+	CompositeTree() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys);
+	void Clear();
+	bool IsEmpty() const { return m_nodes.empty(); }
+
+	RaycastResult2D RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit = false) const;
+
+	void AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+	int GetNumNodesWithBoundsType(CompositeBoundsType boundsType) const;
+
+private:
+	void BuildSubtree(int nodeIndex, int firstPolyIndex, int numPolys, std::vector<std::vector<Vec2>> const& polyVertexes, std::vector<Vec2> const& polyCenters);
+	void SetNodeBounds(CompositeTreeNode& node, std::vector<Vec2> const& points);
+	bool GetRayEntryDistanceVsNodeBounds(CompositeTreeNode const& node, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, float& out_entryDistance) const;
+
+public:
+	static constexpr int MAX_POLYS_PER_LEAF = 2;
+
+	// Relative cost of one ray test against each bounds type, OBB pays for the transform into box space
+	static constexpr float DISC_TEST_COST = 1.f;
+	static constexpr float AABB2_TEST_COST = 1.2f;
+	static constexpr float OBB2_TEST_COST = 1.6f;
+
+	std::vector<CompositeTreeNode> m_nodes;
+	std::vector<Vec2> m_discCenters;
+	std::vector<float> m_discRadii;
+	std::vector<AABB2> m_aabbs;
+	std::vector<OBB2> m_obbs;
+	std::vector<int> m_polyIndexes;
+};
@@ -0,0 +1,374 @@
+#include "Game/ConvexHull2SoA.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/RayPacket4.hpp"
+
+#include "Engine/Math/RaycastUtils.hpp"
+
+#include <emmintrin.h>
+
+
+void ConvexHull2SoA::Build(std::vector<ConvexHull2> const& convexHulls)
+{
+	Clear();
+
+	m_hullFirstPlaneIndexes.reserve(convexHulls.size() + 1);
+	m_hullNumPlanes.reserve(convexHulls.size());
+	for (int hullIndex = 0; hullIndex < (int)convexHulls.size(); hullIndex++)
+	{
+		m_hullFirstPlaneIndexes.push_back((int)m_planeDistances.size());
+
+		std::vector<Plane2> const planes = convexHulls[hullIndex].GetPlanes();
+		m_hullNumPlanes.push_back((int)planes.size());
+		for (int planeIndex = 0; planeIndex < (int)planes.size(); planeIndex++)
+		{
+			m_planeNormalXs.push_back(planes[planeIndex].m_normal.x);
+			m_planeNormalYs.push_back(planes[planeIndex].m_normal.y);
+			m_planeDistances.push_back(planes[planeIndex].m_distanceFromOriginAlongNormal);
+		}
+
+		// Padding planes have a zero normal and every point behind them, so they never enter, exit or reject
+		while (m_planeDistances.size() % SIMD_WIDTH != 0)
+		{
+			m_planeNormalXs.push_back(0.f);
+			m_planeNormalYs.push_back(0.f);
+			m_planeDistances.push_back(1.f);
+		}
+	}
+	m_hullFirstPlaneIndexes.push_back((int)m_planeDistances.size());
+}
+
+bool ConvexHull2SoA::UpdateHullAtIndex(int hullIndex, ConvexHull2 const& convexHull)
+{
+	std::vector<Plane2> const planes = convexHull.GetPlanes();
+	int firstPlaneIndex = m_hullFirstPlaneIndexes[hullIndex];
+	int endPlaneIndex = m_hullFirstPlaneIndexes[hullIndex + 1];
+	if ((int)planes.size() > endPlaneIndex - firstPlaneIndex)
+	{
+		return false;
+	}
+
+	m_hullNumPlanes[hullIndex] = (int)planes.size();
+	for (int planeIndex = firstPlaneIndex; planeIndex < endPlaneIndex; planeIndex++)
+	{
+		int hullPlaneIndex = planeIndex - firstPlaneIndex;
+		bool isPaddingPlane = hullPlaneIndex >= (int)planes.size();
+		m_planeNormalXs[planeIndex] = isPaddingPlane ? 0.f : planes[hullPlaneIndex].m_normal.x;
+		m_planeNormalYs[planeIndex] = isPaddingPlane ? 0.f : planes[hullPlaneIndex].m_normal.y;
+		m_planeDistances[planeIndex] = isPaddingPlane ? 1.f : planes[hullPlaneIndex].m_distanceFromOriginAlongNormal;
+	}
+
+	return true;
+}
+
+void ConvexHull2SoA::Clear()
+{
+	m_hullFirstPlaneIndexes.clear();
+	m_hullNumPlanes.clear();
+	m_planeNormalXs.clear();
+	m_planeNormalYs.clear();
+	m_planeDistances.clear();
+}
+
+RaycastResult2D ConvexHull2SoA::RaycastVsConvexHull(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const
+{
+	RaycastResult2D result;
+	result.m_rayStartPosition = startPos;
+	result.m_rayForwardNormal = fwdNormal;
+	result.m_rayMaxLength = maxDistance;
+
+	__m128 const zero = _mm_setzero_ps();
+	__m128 const lowest = _mm_set1_ps(-FLT_MAX);
+	__m128 const highest = _mm_set1_ps(FLT_MAX);
+	__m128 const startX = _mm_set1_ps(startPos.x);
+	__m128 const startY = _mm_set1_ps(startPos.y);
+	__m128 const fwdX = _mm_set1_ps(fwdNormal.x);
+	__m128 const fwdY = _mm_set1_ps(fwdNormal.y);
+
+	// Clip the ray against SIMD_WIDTH planes at a time, keeping per-lane last entry (with its plane) and first exit
+	__m128 lastEntryDistances = lowest;
+	__m128i lastEntryPlaneIndexes = _mm_set1_epi32(-1);
+	__m128 firstExitDistances = highest;
+	__m128 isOutsideParallelPlane = zero;
+	__m128i planeIndexes = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i const planeIndexStep = _mm_set1_epi32(SIMD_WIDTH);
+
+	// Every hull starts on a multiple of SIMD_WIDTH floats, but std::vector only promises the heap's alignment, so the loads are unaligned
+	int firstPlaneIndex = m_hullFirstPlaneIndexes[hullIndex];
+	int endPlaneIndex = m_hullFirstPlaneIndexes[hullIndex + 1];
+	for (int planeIndex = firstPlaneIndex; planeIndex < endPlaneIndex; planeIndex += SIMD_WIDTH)
+	{
+		__m128 normalX = _mm_loadu_ps(&m_planeNormalXs[planeIndex]);
+		__m128 normalY = _mm_loadu_ps(&m_planeNormalYs[planeIndex]);
+		__m128 distance = _mm_loadu_ps(&m_planeDistances[planeIndex]);
+
+		__m128 startAltitude = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(normalX, startX), _mm_mul_ps(normalY, startY)), distance);
+		__m128 fwdDotNormal = _mm_add_ps(_mm_mul_ps(normalX, fwdX), _mm_mul_ps(normalY, fwdY));
+		__m128 impactDistance = _mm_div_ps(_mm_sub_ps(zero, startAltitude), fwdDotNormal);
+
+		__m128 isEntry = _mm_cmplt_ps(fwdDotNormal, zero);
+		__m128 isExit = _mm_cmpgt_ps(fwdDotNormal, zero);
+		isOutsideParallelPlane = _mm_or_ps(isOutsideParallelPlane, _mm_andnot_ps(_mm_or_ps(isEntry, isExit), _mm_cmpgt_ps(startAltitude, zero)));
+
+		__m128 entryDistance = _mm_or_ps(_mm_and_ps(isEntry, impactDistance), _mm_andnot_ps(isEntry, lowest));
+		__m128i isNewLastEntry = _mm_castps_si128(_mm_cmpgt_ps(entryDistance, lastEntryDistances));
+		lastEntryDistances = _mm_max_ps(lastEntryDistances, entryDistance);
+		lastEntryPlaneIndexes = _mm_or_si128(_mm_and_si128(isNewLastEntry, planeIndexes), _mm_andnot_si128(isNewLastEntry, lastEntryPlaneIndexes));
+
+		__m128 exitDistance = _mm_or_ps(_mm_and_ps(isExit, impactDistance), _mm_andnot_ps(isExit, highest));
+		firstExitDistances = _mm_min_ps(firstExitDistances, exitDistance);
+
+		planeIndexes = _mm_add_epi32(planeIndexes, planeIndexStep);
+	}
+
+	// A ray parallel to a plane it starts in front of can never get inside
+	if (_mm_movemask_ps(isOutsideParallelPlane) != 0)
+	{
+		return result;
+	}
+
+	alignas(16) float laneLastEntryDistances[SIMD_WIDTH];
+	alignas(16) int laneLastEntryPlaneIndexes[SIMD_WIDTH];
+	alignas(16) float laneFirstExitDistances[SIMD_WIDTH];
+	_mm_store_ps(laneLastEntryDistances, lastEntryDistances);
+	_mm_store_si128((__m128i*)laneLastEntryPlaneIndexes, lastEntryPlaneIndexes);
+	_mm_store_ps(laneFirstExitDistances, firstExitDistances);
+
+	float lastEntryDistance = laneLastEntryDistances[0];
+	int lastEntryPlaneIndex = laneLastEntryPlaneIndexes[0];
+	float firstExitDistance = fminf(maxDistance, laneFirstExitDistances[0]);
+	for (int laneIndex = 1; laneIndex < SIMD_WIDTH; laneIndex++)
+	{
+		if (laneLastEntryDistances[laneIndex] > lastEntryDistance)
+		{
+			lastEntryDistance = laneLastEntryDistances[laneIndex];
+			lastEntryPlaneIndex = laneLastEntryPlaneIndexes[laneIndex];
+		}
+		firstExitDistance = fminf(firstExitDistance, laneFirstExitDistances[laneIndex]);
+	}
+
+	// Entries at or before the start mean the ray starts inside the hull
+	float impactDistance = fmaxf(lastEntryDistance, 0.f);
+	if (impactDistance > firstExitDistance)
+	{
+		return result;
+	}
+
+	result.m_didImpact = true;
+	result.m_impactDistance = impactDistance;
+	result.m_impactPosition = startPos + fwdNormal * impactDistance;
+	if (lastEntryDistance <= 0.f)
+	{
+		result.m_impactNormal = -fwdNormal;
+	}
+	else
+	{
+		int planeIndex = firstPlaneIndex + lastEntryPlaneIndex;
+		result.m_impactNormal = Vec2(m_planeNormalXs[planeIndex], m_planeNormalYs[planeIndex]);
+	}
+
+	return result;
+}
+
+RaycastResult2D ConvexHull2SoA::RaycastVsConvexHullScalar(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const
+{
+	RaycastResult2D result;
+	result.m_rayStartPosition = startPos;
+	result.m_rayForwardNormal = fwdNormal;
+	result.m_rayMaxLength = maxDistance;
+
+	// Same clipping as the SIMD kernel one plane at a time, reading the flattened planes in place rather than copying them out of the hull
+	float lastEntryDistance = -FLT_MAX;
+	int lastEntryPlaneIndex = -1;
+	float firstExitDistance = maxDistance;
+	int firstPlaneIndex = m_hullFirstPlaneIndexes[hullIndex];
+	int endPlaneIndex = firstPlaneIndex + m_hullNumPlanes[hullIndex];
+	for (int planeIndex = firstPlaneIndex; planeIndex < endPlaneIndex; planeIndex++)
+	{
+		float startAltitude = m_planeNormalXs[planeIndex] * startPos.x + m_planeNormalYs[planeIndex] * startPos.y - m_planeDistances[planeIndex];
+		float fwdDotNormal = m_planeNormalXs[planeIndex] * fwdNormal.x + m_planeNormalYs[planeIndex] * fwdNormal.y;
+		if (fwdDotNormal == 0.f)
+		{
+			if (startAltitude > 0.f)
+			{
+				return result;
+			}
+			continue;
+		}
+
+		float impactDistance = -startAltitude / fwdDotNormal;
+		if (fwdDotNormal < 0.f)
+		{
+			if (impactDistance > lastEntryDistance)
+			{
+				lastEntryDistance = impactDistance;
+				lastEntryPlaneIndex = planeIndex;
+			}
+		}
+		else if (impactDistance < firstExitDistance)
+		{
+			firstExitDistance = impactDistance;
+		}
+	}
+
+	float impactDistance = fmaxf(lastEntryDistance, 0.f);
+	if (impactDistance > firstExitDistance)
+	{
+		return result;
+	}
+
+	result.m_didImpact = true;
+	result.m_impactDistance = impactDistance;
+	result.m_impactPosition = startPos + fwdNormal * impactDistance;
+	if (lastEntryDistance <= 0.f)
+	{
+		result.m_impactNormal = -fwdNormal;
+	}
+	else
+	{
+		result.m_impactNormal = Vec2(m_planeNormalXs[lastEntryPlaneIndex], m_planeNormalYs[lastEntryPlaneIndex]);
+	}
+
+	return result;
+}
+
+bool ConvexHull2SoA::DoesRayHitConvexHull(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const
+{
+	__m128 const zero = _mm_setzero_ps();
+	__m128 const lowest = _mm_set1_ps(-FLT_MAX);
+	__m128 const highest = _mm_set1_ps(FLT_MAX);
+	__m128 const startX = _mm_set1_ps(startPos.x);
+	__m128 const startY = _mm_set1_ps(startPos.y);
+	__m128 const fwdX = _mm_set1_ps(fwdNormal.x);
+	__m128 const fwdY = _mm_set1_ps(fwdNormal.y);
+
+	// Same clipping as RaycastVsConvexHull without tracking which plane the ray entered through
+	__m128 lastEntryDistances = zero;
+	__m128 firstExitDistances = _mm_set1_ps(maxDistance);
+	__m128 isOutsideParallelPlane = zero;
+
+	int firstPlaneIndex = m_hullFirstPlaneIndexes[hullIndex];
+	int endPlaneIndex = m_hullFirstPlaneIndexes[hullIndex + 1];
+	for (int planeIndex = firstPlaneIndex; planeIndex < endPlaneIndex; planeIndex += SIMD_WIDTH)
+	{
+		__m128 normalX = _mm_loadu_ps(&m_planeNormalXs[planeIndex]);
+		__m128 normalY = _mm_loadu_ps(&m_planeNormalYs[planeIndex]);
+		__m128 distance = _mm_loadu_ps(&m_planeDistances[planeIndex]);
+
+		__m128 startAltitude = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(normalX, startX), _mm_mul_ps(normalY, startY)), distance);
+		__m128 fwdDotNormal = _mm_add_ps(_mm_mul_ps(normalX, fwdX), _mm_mul_ps(normalY, fwdY));
+		__m128 impactDistance = _mm_div_ps(_mm_sub_ps(zero, startAltitude), fwdDotNormal);
+
+		__m128 isEntry = _mm_cmplt_ps(fwdDotNormal, zero);
+		__m128 isExit = _mm_cmpgt_ps(fwdDotNormal, zero);
+		isOutsideParallelPlane = _mm_or_ps(isOutsideParallelPlane, _mm_andnot_ps(_mm_or_ps(isEntry, isExit), _mm_cmpgt_ps(startAltitude, zero)));
+		lastEntryDistances = _mm_max_ps(lastEntryDistances, _mm_or_ps(_mm_and_ps(isEntry, impactDistance), _mm_andnot_ps(isEntry, lowest)));
+		firstExitDistances = _mm_min_ps(firstExitDistances, _mm_or_ps(_mm_and_ps(isExit, impactDistance), _mm_andnot_ps(isExit, highest)));
+	}
+
+	if (_mm_movemask_ps(isOutsideParallelPlane) != 0)
+	{
+		return false;
+	}
+
+	// Reduce the four lanes to the overall last entry and first exit
+	__m128 lastEntryDistance = _mm_max_ps(lastEntryDistances, _mm_shuffle_ps(lastEntryDistances, lastEntryDistances, _MM_SHUFFLE(2, 3, 0, 1)));
+	lastEntryDistance = _mm_max_ps(lastEntryDistance, _mm_shuffle_ps(lastEntryDistance, lastEntryDistance, _MM_SHUFFLE(1, 0, 3, 2)));
+	__m128 firstExitDistance = _mm_min_ps(firstExitDistances, _mm_shuffle_ps(firstExitDistances, firstExitDistances, _MM_SHUFFLE(2, 3, 0, 1)));
+	firstExitDistance = _mm_min_ps(firstExitDistance, _mm_shuffle_ps(firstExitDistance, firstExitDistance, _MM_SHUFFLE(1, 0, 3, 2)));
+	return _mm_comile_ss(lastEntryDistance, firstExitDistance) != 0;
+}
+
+bool ConvexHull2SoA::DoesRayHitConvexHullScalar(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const
+{
+	// Entries start at 0 so rays starting inside hit immediately
+	float lastEntryDistance = 0.f;
+	float firstExitDistance = maxDistance;
+	int firstPlaneIndex = m_hullFirstPlaneIndexes[hullIndex];
+	int endPlaneIndex = firstPlaneIndex + m_hullNumPlanes[hullIndex];
+	for (int planeIndex = firstPlaneIndex; planeIndex < endPlaneIndex; planeIndex++)
+	{
+		float startAltitude = m_planeNormalXs[planeIndex] * startPos.x + m_planeNormalYs[planeIndex] * startPos.y - m_planeDistances[planeIndex];
+		float fwdDotNormal = m_planeNormalXs[planeIndex] * fwdNormal.x + m_planeNormalYs[planeIndex] * fwdNormal.y;
+		if (fwdDotNormal == 0.f)
+		{
+			if (startAltitude > 0.f)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float impactDistance = -startAltitude / fwdDotNormal;
+		if (fwdDotNormal < 0.f)
+		{
+			lastEntryDistance = fmaxf(lastEntryDistance, impactDistance);
+		}
+		else
+		{
+			firstExitDistance = fminf(firstExitDistance, impactDistance);
+		}
+
+		if (lastEntryDistance > firstExitDistance)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ConvexHull2SoA::RaycastPacketVsConvexHull(RayPacket4 const& packet, int activeLaneMask, int hullIndex, float* inout_closestImpactDistances) const
+{
+	__m128 const zero = _mm_setzero_ps();
+	__m128 const lowest = _mm_set1_ps(-FLT_MAX);
+	__m128 const highest = _mm_set1_ps(FLT_MAX);
+	__m128 startX = _mm_load_ps(packet.m_startXs);
+	__m128 startY = _mm_load_ps(packet.m_startYs);
+	__m128 fwdX = _mm_load_ps(packet.m_fwdXs);
+	__m128 fwdY = _mm_load_ps(packet.m_fwdYs);
+	__m128 closestImpactDistances = _mm_loadu_ps(inout_closestImpactDistances);
+
+	// Entries start at 0 so rays starting inside hit immediately, and exits past the closest hit so far can never improve it
+	__m128 lastEntryDistances = zero;
+	__m128 firstExitDistances = _mm_min_ps(_mm_load_ps(packet.m_maxDistances), closestImpactDistances);
+	__m128 isOutsideParallelPlane = zero;
+
+	int firstPlaneIndex = m_hullFirstPlaneIndexes[hullIndex];
+	int endPlaneIndex = firstPlaneIndex + m_hullNumPlanes[hullIndex];
+	for (int planeIndex = firstPlaneIndex; planeIndex < endPlaneIndex; planeIndex++)
+	{
+		__m128 normalX = _mm_set1_ps(m_planeNormalXs[planeIndex]);
+		__m128 normalY = _mm_set1_ps(m_planeNormalYs[planeIndex]);
+		__m128 distance = _mm_set1_ps(m_planeDistances[planeIndex]);
+
+		__m128 startAltitude = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(normalX, startX), _mm_mul_ps(normalY, startY)), distance);
+		__m128 fwdDotNormal = _mm_add_ps(_mm_mul_ps(normalX, fwdX), _mm_mul_ps(normalY, fwdY));
+		__m128 impactDistance = _mm_div_ps(_mm_sub_ps(zero, startAltitude), fwdDotNormal);
+
+		__m128 isEntry = _mm_cmplt_ps(fwdDotNormal, zero);
+		__m128 isExit = _mm_cmpgt_ps(fwdDotNormal, zero);
+		isOutsideParallelPlane = _mm_or_ps(isOutsideParallelPlane, _mm_andnot_ps(_mm_or_ps(isEntry, isExit), _mm_cmpgt_ps(startAltitude, zero)));
+		lastEntryDistances = _mm_max_ps(lastEntryDistances, _mm_or_ps(_mm_and_ps(isEntry, impactDistance), _mm_andnot_ps(isEntry, lowest)));
+		firstExitDistances = _mm_min_ps(firstExitDistances, _mm_or_ps(_mm_and_ps(isExit, impactDistance), _mm_andnot_ps(isExit, highest)));
+
+		// Stop clipping once every active lane has terminated with a miss
+		__m128 isMiss = _mm_or_ps(isOutsideParallelPlane, _mm_cmpgt_ps(lastEntryDistances, firstExitDistances));
+		if ((_mm_movemask_ps(isMiss) & activeLaneMask) == activeLaneMask)
+		{
+			return;
+		}
+	}
+
+	__m128 isMiss = _mm_or_ps(isOutsideParallelPlane, _mm_cmpgt_ps(lastEntryDistances, firstExitDistances));
+	int hitLaneMask = ~_mm_movemask_ps(isMiss) & activeLaneMask;
+	alignas(16) float laneLastEntryDistances[SIMD_WIDTH];
+	_mm_store_ps(laneLastEntryDistances, lastEntryDistances);
+	for (int laneIndex = 0; laneIndex < SIMD_WIDTH; laneIndex++)
+	{
+		if ((hitLaneMask & (1 << laneIndex)) != 0 && laneLastEntryDistances[laneIndex] < inout_closestImpactDistances[laneIndex])
+		{
+			inout_closestImpactDistances[laneIndex] = laneLastEntryDistances[laneIndex];
+		}
+	}
+}
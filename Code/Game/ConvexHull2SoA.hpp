@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Engine/Math/ConvexHull2.hpp"
+
+#include <vector>
+
+struct RaycastResult2D;
+struct RayPacket4;
+
+
+class ConvexHull2SoA
+{
+public:
+	~ConvexHull2SoA() = default;
+	ConvexHull2SoA() = default;
+
+	void Build(std::vector<ConvexHull2> const& convexHulls);
+	// Rewrites one hull's planes in place; returns false when they no longer fit its padded slot and a full Build is needed
+	bool UpdateHullAtIndex(int hullIndex, ConvexHull2 const& convexHull);
+	void Clear();
+	bool IsEmpty() const { return m_hullFirstPlaneIndexes.empty(); }
+	int GetNumHulls() const { return m_hullFirstPlaneIndexes.empty() ? 0 : (int)m_hullFirstPlaneIndexes.size() - 1; }
+
+	RaycastResult2D RaycastVsConvexHull(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const;
+	RaycastResult2D RaycastVsConvexHullScalar(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const;
+	// Any-hit queries: no impact position or normal, and the scalar kernel returns as soon as the ray's interval is empty
+	bool DoesRayHitConvexHull(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const;
+	bool DoesRayHitConvexHullScalar(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const;
+	void RaycastPacketVsConvexHull(RayPacket4 const& packet, int activeLaneMask, int hullIndex, float* inout_closestImpactDistances) const;
+
+public:
+	static constexpr int SIMD_WIDTH = 4;
+
+	// Planes for hull i are [m_hullFirstPlaneIndexes[i], m_hullFirstPlaneIndexes[i + 1]), padded to a multiple of SIMD_WIDTH
+	std::vector<int> m_hullFirstPlaneIndexes;
+	// Plane counts without padding, for kernels that put rays rather than planes in the SIMD lanes
+	std::vector<int> m_hullNumPlanes;
+	std::vector<float> m_planeNormalXs;
+	std::vector<float> m_planeNormalYs;
+	std::vector<float> m_planeDistances;
+};
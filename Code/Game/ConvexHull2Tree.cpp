@@ -0,0 +1,387 @@
+#include "Game/ConvexHull2Tree.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/TreeUtils.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+
+#include <algorithm>
+
+
+void ConvexHull2Tree::Build(std::vector<ConvexPoly2> const& convexPolys, int maxPlanesPerNode)
+{
+	Clear();
+	m_maxPlanesPerNode = maxPlanesPerNode < MIN_PLANES_PER_NODE ? MIN_PLANES_PER_NODE : maxPlanesPerNode;
+
+	int numPolys = (int)convexPolys.size();
+	if (numPolys == 0)
+	{
+		return;
+	}
+
+	std::vector<std::vector<Vec2>> polyVertexes;
+	std::vector<Vec2> polyCenters;
+	polyVertexes.reserve(numPolys);
+	polyCenters.reserve(numPolys);
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		polyVertexes.push_back(convexPolys[polyIndex].GetVertexes());
+		Vec2 center = Vec2::ZERO;
+		for (int vertexIndex = 0; vertexIndex < (int)polyVertexes[polyIndex].size(); vertexIndex++)
+		{
+			center += polyVertexes[polyIndex][vertexIndex];
+		}
+		center /= (float)polyVertexes[polyIndex].size();
+		polyCenters.push_back(center);
+		m_polyIndexes.push_back(polyIndex);
+	}
+
+	m_nodes.reserve(2 * numPolys / MAX_POLYS_PER_LEAF + 1);
+	m_nodes.push_back(ConvexHull2TreeNode());
+	BuildSubtree(0, 0, numPolys, polyVertexes, polyCenters);
+}
+
+void ConvexHull2Tree::Clear()
+{
+	m_nodes.clear();
+	m_planes.clear();
+	m_polyIndexes.clear();
+}
+
+void ConvexHull2Tree::BuildSubtree(int nodeIndex, int firstPolyIndex, int numPolys, std::vector<std::vector<Vec2>> const& polyVertexes, std::vector<Vec2> const& polyCenters)
+{
+	// The hull of every vertex under this node is the hull of the children's hulls
+	std::vector<Vec2> nodePoints;
+	AABB2 centroidBounds(polyCenters[m_polyIndexes[firstPolyIndex]], polyCenters[m_polyIndexes[firstPolyIndex]]);
+	for (int polyIndexIdx = firstPolyIndex; polyIndexIdx < firstPolyIndex + numPolys; polyIndexIdx++)
+	{
+		std::vector<Vec2> const& vertexes = polyVertexes[m_polyIndexes[polyIndexIdx]];
+		nodePoints.insert(nodePoints.end(), vertexes.begin(), vertexes.end());
+
+		Vec2 const& center = polyCenters[m_polyIndexes[polyIndexIdx]];
+		centroidBounds.m_mins.x = fminf(centroidBounds.m_mins.x, center.x);
+		centroidBounds.m_mins.y = fminf(centroidBounds.m_mins.y, center.y);
+		centroidBounds.m_maxs.x = fmaxf(centroidBounds.m_maxs.x, center.x);
+		centroidBounds.m_maxs.y = fmaxf(centroidBounds.m_maxs.y, center.y);
+	}
+	std::vector<Vec2> hullVertexes = GetConvexHullOfPoints(nodePoints);
+	SimplifyConvexHullToMaxEdges(hullVertexes, m_maxPlanesPerNode);
+
+	m_nodes[nodeIndex].m_firstPlaneIndex = (int)m_planes.size();
+	if (hullVertexes.size() >= 3)
+	{
+		for (int vertexIndex = 0; vertexIndex < (int)hullVertexes.size(); vertexIndex++)
+		{
+			Vec2 const& edgeStart = hullVertexes[vertexIndex];
+			Vec2 const& edgeEnd = hullVertexes[(vertexIndex + 1) % (int)hullVertexes.size()];
+			Vec2 edge = edgeEnd - edgeStart;
+			Plane2 edgePlane;
+			edgePlane.m_normal = Vec2(edge.y, -edge.x).GetNormalized();
+			edgePlane.m_distanceFromOriginAlongNormal = DotProduct2D(edgePlane.m_normal, edgeStart);
+			m_planes.push_back(edgePlane);
+		}
+	}
+	m_nodes[nodeIndex].m_numPlanes = (int)m_planes.size() - m_nodes[nodeIndex].m_firstPlaneIndex;
+
+	if (numPolys <= MAX_POLYS_PER_LEAF)
+	{
+		m_nodes[nodeIndex].m_firstPolyIndex = firstPolyIndex;
+		m_nodes[nodeIndex].m_numPolys = numPolys;
+		return;
+	}
+
+	Vec2 centroidDimensions = centroidBounds.m_maxs - centroidBounds.m_mins;
+	bool splitAlongX = centroidDimensions.x >= centroidDimensions.y;
+	int numPolysOnLeft = numPolys / 2;
+	std::vector<int>::iterator rangeBegin = m_polyIndexes.begin() + firstPolyIndex;
+	std::nth_element(rangeBegin, rangeBegin + numPolysOnLeft, rangeBegin + numPolys, [&polyCenters, splitAlongX](int polyIndexA, int polyIndexB)
+	{
+		return splitAlongX ? polyCenters[polyIndexA].x < polyCenters[polyIndexB].x : polyCenters[polyIndexA].y < polyCenters[polyIndexB].y;
+	});
+
+	int leftChildIndex = (int)m_nodes.size();
+	m_nodes.push_back(ConvexHull2TreeNode());
+	m_nodes.push_back(ConvexHull2TreeNode());
+	m_nodes[nodeIndex].m_childIndexes[0] = leftChildIndex;
+	m_nodes[nodeIndex].m_childIndexes[1] = leftChildIndex + 1;
+
+	BuildSubtree(leftChildIndex, firstPolyIndex, numPolysOnLeft, polyVertexes, polyCenters);
+	BuildSubtree(leftChildIndex + 1, firstPolyIndex + numPolysOnLeft, numPolys - numPolysOnLeft, polyVertexes, polyCenters);
+}
+
+RaycastResult2D ConvexHull2Tree::RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit) const
+{
+	RaycastResult2D closestResult;
+	closestResult.m_rayStartPosition = startPos;
+	closestResult.m_rayForwardNormal = fwdNormal;
+	closestResult.m_impactDistance = FLT_MAX;
+
+	auto getEntryDistance = [this, &startPos, &fwdNormal, maxDistance](int nodeIndex, float& out_entryDistance)
+	{
+		ConvexHull2TreeNode const& node = m_nodes[nodeIndex];
+		return GetRayEntryDistanceVsPlanes(startPos, fwdNormal, maxDistance, m_planes.data() + node.m_firstPlaneIndex, node.m_numPlanes, out_entryDistance);
+	};
+	auto visitNode = [this, &startPos, &fwdNormal, maxDistance, &raycastVsHull, stopAtFirstHit, &closestResult, &out_numHullTests](int nodeIndex, float& inout_cutoffDistance)
+	{
+		ConvexHull2TreeNode const& node = m_nodes[nodeIndex];
+		if (!node.IsLeaf())
+		{
+			return true;
+		}
+
+		for (int polyIndexIdx = node.m_firstPolyIndex; polyIndexIdx < node.m_firstPolyIndex + node.m_numPolys; polyIndexIdx++)
+		{
+			out_numHullTests++;
+			RaycastResult2D raycastVsConvexHullResult = raycastVsHull(m_polyIndexes[polyIndexIdx], startPos, fwdNormal, maxDistance);
+			if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+			{
+				closestResult = raycastVsConvexHullResult;
+				if (stopAtFirstHit)
+				{
+					inout_cutoffDistance = -1.f;
+					return false;
+				}
+			}
+		}
+		inout_cutoffDistance = closestResult.m_impactDistance;
+		return false;
+	};
+	TraverseTreeNearestFirst<MAX_TREE_TRAVERSAL_DEPTH>(m_nodes, 0, getEntryDistance, visitNode);
+
+	return closestResult;
+}
+
+void ConvexHull2Tree::AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	// Planes are stored in counter-clockwise edge order, so each hull corner is where consecutive planes meet
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		ConvexHull2TreeNode const& node = m_nodes[nodeIndex];
+		std::vector<Vec2> corners;
+		for (int planeIdx = 0; planeIdx < node.m_numPlanes; planeIdx++)
+		{
+			Plane2 const& previousPlane = m_planes[node.m_firstPlaneIndex + (planeIdx + node.m_numPlanes - 1) % node.m_numPlanes];
+			Plane2 const& plane = m_planes[node.m_firstPlaneIndex + planeIdx];
+			float determinant = previousPlane.m_normal.x * plane.m_normal.y - previousPlane.m_normal.y * plane.m_normal.x;
+			if (determinant == 0.f)
+			{
+				continue;
+			}
+			float cornerX = (previousPlane.m_distanceFromOriginAlongNormal * plane.m_normal.y - plane.m_distanceFromOriginAlongNormal * previousPlane.m_normal.y) / determinant;
+			float cornerY = (previousPlane.m_normal.x * plane.m_distanceFromOriginAlongNormal - plane.m_normal.x * previousPlane.m_distanceFromOriginAlongNormal) / determinant;
+			corners.push_back(Vec2(cornerX, cornerY));
+		}
+		for (int cornerIndex = 0; cornerIndex < (int)corners.size(); cornerIndex++)
+		{
+			AddVertsForLineSegment2D(verts, corners[cornerIndex], corners[(cornerIndex + 1) % (int)corners.size()], lineThickness, color);
+		}
+	}
+}
+
+uint32_t ConvexHull2Tree::AppendToWriter(BufferWriter& writer) const
+{
+	uint32_t payloadSize = 0;
+	writer.AppendByte((uint8_t)m_maxPlanesPerNode);
+	payloadSize += sizeof(uint8_t);
+	writer.AppendUint32((uint32_t)m_nodes.size());
+	payloadSize += sizeof(uint32_t);
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		ConvexHull2TreeNode const& node = m_nodes[nodeIndex];
+		writer.AppendByte((uint8_t)node.m_numPlanes);
+		payloadSize += sizeof(uint8_t);
+		for (int planeIdx = 0; planeIdx < node.m_numPlanes; planeIdx++)
+		{
+			Plane2 const& plane = m_planes[node.m_firstPlaneIndex + planeIdx];
+			writer.AppendVec2(plane.m_normal);
+			payloadSize += sizeof(Vec2);
+			writer.AppendFloat(plane.m_distanceFromOriginAlongNormal);
+			payloadSize += sizeof(float);
+		}
+		writer.AppendUint32((uint32_t)node.m_childIndexes[0]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[1]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUShort((uint16_t)node.m_firstPolyIndex);
+		payloadSize += sizeof(uint16_t);
+		writer.AppendUShort((uint16_t)node.m_numPolys);
+		payloadSize += sizeof(uint16_t);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < (int)m_polyIndexes.size(); polyIndexIdx++)
+	{
+		writer.AppendUShort((uint16_t)m_polyIndexes[polyIndexIdx]);
+		payloadSize += sizeof(uint16_t);
+	}
+
+	return payloadSize;
+}
+
+bool ConvexHull2Tree::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	m_maxPlanesPerNode = parser.ParseByte();
+	uint32_t numNodes = parser.ParseUint32();
+	for (uint32_t nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		ConvexHull2TreeNode node;
+		node.m_firstPlaneIndex = (int)m_planes.size();
+		node.m_numPlanes = parser.ParseByte();
+		for (int planeIdx = 0; planeIdx < node.m_numPlanes; planeIdx++)
+		{
+			Plane2 plane;
+			plane.m_normal = parser.ParseVec2();
+			plane.m_distanceFromOriginAlongNormal = parser.ParseFloat();
+			m_planes.push_back(plane);
+		}
+		node.m_childIndexes[0] = (int)parser.ParseUint32();
+		node.m_childIndexes[1] = (int)parser.ParseUint32();
+		node.m_firstPolyIndex = parser.ParseUShort();
+		node.m_numPolys = parser.ParseUShort();
+		m_nodes.push_back(node);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < numPolys; polyIndexIdx++)
+	{
+		m_polyIndexes.push_back(parser.ParseUShort());
+	}
+
+	if (!AreTreeIndexesValid(m_nodes, m_polyIndexes, numPolys, MAX_TREE_TRAVERSAL_DEPTH - 1))
+	{
+		Clear();
+		return false;
+	}
+
+	return true;
+}
+
+std::vector<Vec2> GetConvexHullOfPoints(std::vector<Vec2> const& points)
+{
+	// Andrew's monotone chain, returns the hull in counter-clockwise order without collinear vertexes
+	std::vector<Vec2> sortedPoints = points;
+	std::sort(sortedPoints.begin(), sortedPoints.end(), [](Vec2 const& pointA, Vec2 const& pointB)
+	{
+		return pointA.x < pointB.x || (pointA.x == pointB.x && pointA.y < pointB.y);
+	});
+
+	int numPoints = (int)sortedPoints.size();
+	if (numPoints < 3)
+	{
+		return sortedPoints;
+	}
+
+	std::vector<Vec2> hullVertexes(2 * numPoints);
+	int numHullVertexes = 0;
+	for (int pointIndex = 0; pointIndex < numPoints; pointIndex++)
+	{
+		while (numHullVertexes >= 2 && CrossProduct2D(hullVertexes[numHullVertexes - 1] - hullVertexes[numHullVertexes - 2], sortedPoints[pointIndex] - hullVertexes[numHullVertexes - 2]) <= 0.f)
+		{
+			numHullVertexes--;
+		}
+		hullVertexes[numHullVertexes++] = sortedPoints[pointIndex];
+	}
+	int lowerHullSize = numHullVertexes + 1;
+	for (int pointIndex = numPoints - 2; pointIndex >= 0; pointIndex--)
+	{
+		while (numHullVertexes >= lowerHullSize && CrossProduct2D(hullVertexes[numHullVertexes - 1] - hullVertexes[numHullVertexes - 2], sortedPoints[pointIndex] - hullVertexes[numHullVertexes - 2]) <= 0.f)
+		{
+			numHullVertexes--;
+		}
+		hullVertexes[numHullVertexes++] = sortedPoints[pointIndex];
+	}
+
+	// Last vertex repeats the first
+	hullVertexes.resize(numHullVertexes - 1);
+	return hullVertexes;
+}
+
+void SimplifyConvexHullToMaxEdges(std::vector<Vec2>& hullVertexes, int maxEdges)
+{
+	// Repeatedly drop the edge whose removal adds the least area: its neighboring edges are extended until
+	// they meet, so the simplified hull still encloses the original one and culling stays conservative
+	while ((int)hullVertexes.size() > maxEdges)
+	{
+		int numVertexes = (int)hullVertexes.size();
+		int bestEdgeIndex = -1;
+		float bestAddedArea = FLT_MAX;
+		Vec2 bestReplacementVertex;
+		for (int edgeIndex = 0; edgeIndex < numVertexes; edgeIndex++)
+		{
+			Vec2 const& previousVertex = hullVertexes[(edgeIndex + numVertexes - 1) % numVertexes];
+			Vec2 const& edgeStart = hullVertexes[edgeIndex];
+			Vec2 const& edgeEnd = hullVertexes[(edgeIndex + 1) % numVertexes];
+			Vec2 const& nextVertex = hullVertexes[(edgeIndex + 2) % numVertexes];
+
+			Vec2 previousEdgeDirection = edgeStart - previousVertex;
+			Vec2 nextEdgeDirection = nextVertex - edgeEnd;
+			float directionsCross = CrossProduct2D(previousEdgeDirection, nextEdgeDirection);
+			if (directionsCross <= 0.f)
+			{
+				// Neighboring edges are parallel or diverge, they never meet on the outside
+				continue;
+			}
+
+			float distanceAlongPreviousEdge = CrossProduct2D(edgeEnd - edgeStart, nextEdgeDirection) / directionsCross;
+			if (distanceAlongPreviousEdge < 0.f)
+			{
+				continue;
+			}
+			Vec2 replacementVertex = edgeStart + previousEdgeDirection * distanceAlongPreviousEdge;
+			float addedArea = 0.5f * fabsf(CrossProduct2D(replacementVertex - edgeStart, edgeEnd - edgeStart));
+			if (addedArea < bestAddedArea)
+			{
+				bestAddedArea = addedArea;
+				bestEdgeIndex = edgeIndex;
+				bestReplacementVertex = replacementVertex;
+			}
+		}
+
+		if (bestEdgeIndex == -1)
+		{
+			return;
+		}
+
+		int edgeEndIndex = (bestEdgeIndex + 1) % numVertexes;
+		hullVertexes[bestEdgeIndex] = bestReplacementVertex;
+		hullVertexes.erase(hullVertexes.begin() + edgeEndIndex);
+	}
+}
+
+bool GetRayEntryDistanceVsPlanes(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, Plane2 const* planes, int numPlanes, float& out_entryDistance)
+{
+	// Same entry/exit clipping as RaycastVsConvexHull2, without computing the impact normal or position
+	float lastEntryDistance = 0.f;
+	float firstExitDistance = maxDistance;
+	for (int planeIndex = 0; planeIndex < numPlanes; planeIndex++)
+	{
+		float startDistanceFromPlane = DotProduct2D(planes[planeIndex].m_normal, startPos) - planes[planeIndex].m_distanceFromOriginAlongNormal;
+		float fwdDotNormal = DotProduct2D(planes[planeIndex].m_normal, fwdNormal);
+		if (fwdDotNormal == 0.f)
+		{
+			if (startDistanceFromPlane > 0.f)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float impactDistance = -startDistanceFromPlane / fwdDotNormal;
+		if (fwdDotNormal < 0.f)
+		{
+			lastEntryDistance = fmaxf(lastEntryDistance, impactDistance);
+		}
+		else
+		{
+			firstExitDistance = fminf(firstExitDistance, impactDistance);
+		}
+
+		if (lastEntryDistance > firstExitDistance)
+		{
+			return false;
+		}
+	}
+
+	out_entryDistance = lastEntryDistance;
+	return true;
+}
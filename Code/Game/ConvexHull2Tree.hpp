@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Game/HullRaycastFunction.hpp"
+
+#include "Engine/Math/ConvexHull2.hpp"
+#include "Engine/Math/ConvexPoly2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct RaycastResult2D;
+struct Vertex_PCU;
+struct Rgba8;
+class BufferParser;
+class BufferWriter;
+
+
+struct ConvexHull2TreeNode
+{
+public:
+	bool IsLeaf() const { return m_numPolys > 0; }
+
+public:
+	int m_firstPlaneIndex = 0;
+	int m_numPlanes = 0;
+	int m_childIndexes[2] = { -1, -1 };
+	int m_firstPolyIndex = 0;
+	int m_numPolys = 0;
+};
+
+class ConvexHull2Tree
+{
+public:
+	~ConvexHull2Tree() = default;
+	ConvexHull2Tree() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys, int maxPlanesPerNode = DEFAULT_MAX_PLANES_PER_NODE);
+	void Clear();
+	bool IsEmpty() const { return m_nodes.empty(); }
+
+	RaycastResult2D RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit = false) const;
+
+	void AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+private:
+	void BuildSubtree(int nodeIndex, int firstPolyIndex, int numPolys, std::vector<std::vector<Vec2>> const& polyVertexes, std::vector<Vec2> const& polyCenters);
+
+public:
+	static constexpr int MAX_POLYS_PER_LEAF = 4;
+	static constexpr int DEFAULT_MAX_PLANES_PER_NODE = 8;
+	static constexpr int MIN_PLANES_PER_NODE = 3;
+
+	int m_maxPlanesPerNode = DEFAULT_MAX_PLANES_PER_NODE;
+	std::vector<ConvexHull2TreeNode> m_nodes;
+	std::vector<Plane2> m_planes;
+	std::vector<int> m_polyIndexes;
+};
+
+std::vector<Vec2> GetConvexHullOfPoints(std::vector<Vec2> const& points);
+void SimplifyConvexHullToMaxEdges(std::vector<Vec2>& hullVertexes, int maxEdges);
+bool GetRayEntryDistanceVsPlanes(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, Plane2 const* planes, int numPlanes, float& out_entryDistance);
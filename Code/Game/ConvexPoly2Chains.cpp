@@ -0,0 +1,190 @@
+#include "Game/ConvexPoly2Chains.hpp"
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Math/RaycastUtils.hpp"
+
+#include <algorithm>
+
+
+void ConvexPoly2Chains::Build(std::vector<ConvexPoly2> const& convexPolys)
+{
+	Clear();
+
+	m_polyFirstVertexIndexes.reserve(convexPolys.size() + 1);
+	m_polyMinAngleEdgeIndexes.resize(convexPolys.size());
+	for (int polyIndex = 0; polyIndex < (int)convexPolys.size(); polyIndex++)
+	{
+		std::vector<Vec2> const vertexes = convexPolys[polyIndex].GetVertexes();
+		m_polyFirstVertexIndexes.push_back((int)m_vertexes.size());
+		m_vertexes.insert(m_vertexes.end(), vertexes.begin(), vertexes.end());
+	}
+	m_polyFirstVertexIndexes.push_back((int)m_vertexes.size());
+	m_sortedEdgeNormalAngles.resize(m_vertexes.size());
+
+	for (int polyIndex = 0; polyIndex < (int)convexPolys.size(); polyIndex++)
+	{
+		SetChainForPolyAtIndex(polyIndex, convexPolys[polyIndex].GetVertexes());
+	}
+}
+
+bool ConvexPoly2Chains::UpdatePolyAtIndex(int polyIndex, ConvexPoly2 const& convexPoly)
+{
+	std::vector<Vec2> const vertexes = convexPoly.GetVertexes();
+	if ((int)vertexes.size() != GetNumVertexes(polyIndex))
+	{
+		return false;
+	}
+
+	SetChainForPolyAtIndex(polyIndex, vertexes);
+	return true;
+}
+
+void ConvexPoly2Chains::Clear()
+{
+	m_polyFirstVertexIndexes.clear();
+	m_vertexes.clear();
+	m_sortedEdgeNormalAngles.clear();
+	m_polyMinAngleEdgeIndexes.clear();
+}
+
+void ConvexPoly2Chains::SetChainForPolyAtIndex(int polyIndex, std::vector<Vec2> const& ccwVertexes)
+{
+	int firstVertexIndex = m_polyFirstVertexIndexes[polyIndex];
+	int numVertexes = (int)ccwVertexes.size();
+	if (numVertexes == 0)
+	{
+		m_polyMinAngleEdgeIndexes[polyIndex] = 0;
+		return;
+	}
+
+	// Outward normals of a CCW poly turn counterclockwise edge by edge, so the angles only wrap once
+	int minAngleEdgeIndex = 0;
+	float minAngle = FLT_MAX;
+	for (int edgeIndex = 0; edgeIndex < numVertexes; edgeIndex++)
+	{
+		Vec2 const& edgeStart = ccwVertexes[edgeIndex];
+		Vec2 const& edgeEnd = ccwVertexes[(edgeIndex + 1) % numVertexes];
+		float edgeNormalAngle = atan2f(-(edgeEnd.x - edgeStart.x), edgeEnd.y - edgeStart.y);
+		m_vertexes[firstVertexIndex + edgeIndex] = edgeStart;
+		m_sortedEdgeNormalAngles[firstVertexIndex + edgeIndex] = edgeNormalAngle;
+		if (edgeNormalAngle < minAngle)
+		{
+			minAngle = edgeNormalAngle;
+			minAngleEdgeIndex = edgeIndex;
+		}
+	}
+
+	std::rotate(m_sortedEdgeNormalAngles.begin() + firstVertexIndex, m_sortedEdgeNormalAngles.begin() + firstVertexIndex + minAngleEdgeIndex, m_sortedEdgeNormalAngles.begin() + firstVertexIndex + numVertexes);
+	m_polyMinAngleEdgeIndexes[polyIndex] = minAngleEdgeIndex;
+}
+
+int ConvexPoly2Chains::GetExtremeVertexIndex(int polyIndex, Vec2 const& direction) const
+{
+	// The vertex farthest along a direction sits between the last edge whose normal angle is below the direction's and the first at or above it
+	int firstVertexIndex = m_polyFirstVertexIndexes[polyIndex];
+	int numVertexes = GetNumVertexes(polyIndex);
+	float directionAngle = atan2f(direction.y, direction.x);
+	float const* sortedAnglesBegin = m_sortedEdgeNormalAngles.data() + firstVertexIndex;
+	int sortedEdgeIndex = (int)(std::lower_bound(sortedAnglesBegin, sortedAnglesBegin + numVertexes, directionAngle) - sortedAnglesBegin);
+	if (sortedEdgeIndex == numVertexes)
+	{
+		sortedEdgeIndex = 0;
+	}
+
+	return (m_polyMinAngleEdgeIndexes[polyIndex] + sortedEdgeIndex) % numVertexes;
+}
+
+RaycastResult2D ConvexPoly2Chains::RaycastVsConvexPoly(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int polyIndex) const
+{
+	RaycastResult2D result;
+	result.m_rayStartPosition = startPos;
+	result.m_rayForwardNormal = fwdNormal;
+	result.m_rayMaxLength = maxDistance;
+
+	int numVertexes = GetNumVertexes(polyIndex);
+	if (numVertexes < 3)
+	{
+		return result;
+	}
+
+	// Signed distance of each vertex to the ray's infinite line, positive on its left
+	Vec2 const* vertexes = m_vertexes.data() + m_polyFirstVertexIndexes[polyIndex];
+	Vec2 leftNormal(-fwdNormal.y, fwdNormal.x);
+	float startAltitude = leftNormal.x * startPos.x + leftNormal.y * startPos.y;
+	auto getVertexAltitude = [vertexes, numVertexes, &leftNormal, startAltitude](int vertexIndex)
+	{
+		Vec2 const& vertex = vertexes[vertexIndex % numVertexes];
+		return leftNormal.x * vertex.x + leftNormal.y * vertex.y - startAltitude;
+	};
+
+	int leftmostVertexIndex = GetExtremeVertexIndex(polyIndex, leftNormal);
+	int rightmostVertexIndex = GetExtremeVertexIndex(polyIndex, -leftNormal);
+	if (getVertexAltitude(leftmostVertexIndex) < 0.f || getVertexAltitude(rightmostVertexIndex) > 0.f || leftmostVertexIndex == rightmostVertexIndex)
+	{
+		return result;
+	}
+
+	// Altitudes only rise going CCW from the rightmost vertex to the leftmost and only fall on the way back,
+	// so each half of the chain has exactly one edge crossing the line
+	int crossingEdgeIndexes[2] = {};
+	int chainFirstVertexIndexes[2] = { rightmostVertexIndex, leftmostVertexIndex };
+	int chainLengths[2] = { (leftmostVertexIndex - rightmostVertexIndex + numVertexes) % numVertexes, (rightmostVertexIndex - leftmostVertexIndex + numVertexes) % numVertexes };
+	for (int chainIndex = 0; chainIndex < 2; chainIndex++)
+	{
+		float altitudeSign = chainIndex == 0 ? 1.f : -1.f;
+		int lowOffset = 0;
+		int highOffset = chainLengths[chainIndex];
+		while (highOffset - lowOffset > 1)
+		{
+			int midOffset = (lowOffset + highOffset) / 2;
+			if (altitudeSign * getVertexAltitude(chainFirstVertexIndexes[chainIndex] + midOffset) <= 0.f)
+			{
+				lowOffset = midOffset;
+			}
+			else
+			{
+				highOffset = midOffset;
+			}
+		}
+		crossingEdgeIndexes[chainIndex] = (chainFirstVertexIndexes[chainIndex] + lowOffset) % numVertexes;
+	}
+
+	float crossingDistances[2] = {};
+	for (int chainIndex = 0; chainIndex < 2; chainIndex++)
+	{
+		int edgeStartIndex = crossingEdgeIndexes[chainIndex];
+		float edgeStartAltitude = getVertexAltitude(edgeStartIndex);
+		float edgeEndAltitude = getVertexAltitude(edgeStartIndex + 1);
+		float crossingFraction = edgeStartAltitude != edgeEndAltitude ? edgeStartAltitude / (edgeStartAltitude - edgeEndAltitude) : 0.f;
+		Vec2 const& edgeStart = vertexes[edgeStartIndex];
+		Vec2 const& edgeEnd = vertexes[(edgeStartIndex + 1) % numVertexes];
+		Vec2 crossingPosition = edgeStart + (edgeEnd - edgeStart) * crossingFraction;
+		crossingDistances[chainIndex] = (crossingPosition.x - startPos.x) * fwdNormal.x + (crossingPosition.y - startPos.y) * fwdNormal.y;
+	}
+
+	int entryChainIndex = crossingDistances[0] <= crossingDistances[1] ? 0 : 1;
+	float entryDistance = crossingDistances[entryChainIndex];
+	float exitDistance = crossingDistances[1 - entryChainIndex];
+	if (exitDistance < 0.f || entryDistance > maxDistance)
+	{
+		return result;
+	}
+
+	float impactDistance = fmaxf(entryDistance, 0.f);
+	result.m_didImpact = true;
+	result.m_impactDistance = impactDistance;
+	result.m_impactPosition = startPos + fwdNormal * impactDistance;
+	if (entryDistance <= 0.f)
+	{
+		result.m_impactNormal = -fwdNormal;
+	}
+	else
+	{
+		Vec2 const& edgeStart = vertexes[crossingEdgeIndexes[entryChainIndex]];
+		Vec2 const& edgeEnd = vertexes[(crossingEdgeIndexes[entryChainIndex] + 1) % numVertexes];
+		result.m_impactNormal = Vec2(edgeEnd.y - edgeStart.y, -(edgeEnd.x - edgeStart.x)).GetNormalized();
+	}
+
+	return result;
+}
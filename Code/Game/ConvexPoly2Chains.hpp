@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Engine/Math/ConvexPoly2.hpp"
+
+#include <vector>
+
+struct RaycastResult2D;
+
+
+// Flattened CCW vertex chains with each poly's outward edge normal angles stored in ascending order, so a ray can find
+// the poly's extreme vertexes and the two edges its line crosses by binary search instead of clipping against every plane
+class ConvexPoly2Chains
+{
+public:
+	~ConvexPoly2Chains() = default;
+	ConvexPoly2Chains() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys);
+	// Rewrites one poly's chain in place; returns false when its vertex count changed and a full Build is needed
+	bool UpdatePolyAtIndex(int polyIndex, ConvexPoly2 const& convexPoly);
+	void Clear();
+	bool IsEmpty() const { return m_polyFirstVertexIndexes.empty(); }
+	int GetNumVertexes(int polyIndex) const { return m_polyFirstVertexIndexes[polyIndex + 1] - m_polyFirstVertexIndexes[polyIndex]; }
+
+	RaycastResult2D RaycastVsConvexPoly(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int polyIndex) const;
+
+private:
+	void SetChainForPolyAtIndex(int polyIndex, std::vector<Vec2> const& ccwVertexes);
+	int GetExtremeVertexIndex(int polyIndex, Vec2 const& direction) const;
+
+public:
+	// Vertexes for poly i are [m_polyFirstVertexIndexes[i], m_polyFirstVertexIndexes[i + 1])
+	std::vector<int> m_polyFirstVertexIndexes;
+	std::vector<Vec2> m_vertexes;
+	// Edge j runs from vertex j to vertex j + 1; angles are rotated to start at the poly's smallest, m_polyMinAngleEdgeIndexes
+	std::vector<float> m_sortedEdgeNormalAngles;
+	std::vector<int> m_polyMinAngleEdgeIndexes;
+};
@@ -0,0 +1,347 @@
+#include "Game/ConvexPoly2Tree.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/TreeUtils.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+
+#include <algorithm>
+
+
+void ConvexPoly2Tree::Build(std::vector<ConvexPoly2> const& convexPolys)
+{
+	Clear();
+
+	int numPolys = (int)convexPolys.size();
+	if (numPolys == 0)
+	{
+		return;
+	}
+
+	std::vector<AABB2> polyBounds;
+	std::vector<Vec2> polyCenters;
+	polyBounds.reserve(numPolys);
+	polyCenters.reserve(numPolys);
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		AABB2 bounds = GetBoundsForConvexPoly2(convexPolys[polyIndex]);
+		polyBounds.push_back(bounds);
+		polyCenters.push_back((bounds.m_mins + bounds.m_maxs) * 0.5f);
+		m_polyIndexes.push_back(polyIndex);
+	}
+
+	m_nodes.reserve(2 * numPolys / MAX_POLYS_PER_LEAF + 1);
+	m_nodes.push_back(ConvexPoly2TreeNode());
+	BuildSubtree(0, 0, numPolys, polyBounds, polyCenters);
+	LinkParentAndLeafIndexes();
+}
+
+void ConvexPoly2Tree::Clear()
+{
+	m_nodes.clear();
+	m_polyIndexes.clear();
+	m_leafNodeIndexForPoly.clear();
+}
+
+void ConvexPoly2Tree::BuildSubtree(int nodeIndex, int firstPolyIndex, int numPolys, std::vector<AABB2> const& polyBounds, std::vector<Vec2> const& polyCenters)
+{
+	AABB2 nodeBounds = polyBounds[m_polyIndexes[firstPolyIndex]];
+	AABB2 centroidBounds(polyCenters[m_polyIndexes[firstPolyIndex]], polyCenters[m_polyIndexes[firstPolyIndex]]);
+	for (int polyIndexIdx = firstPolyIndex + 1; polyIndexIdx < firstPolyIndex + numPolys; polyIndexIdx++)
+	{
+		AABB2 const& bounds = polyBounds[m_polyIndexes[polyIndexIdx]];
+		nodeBounds.m_mins.x = fminf(nodeBounds.m_mins.x, bounds.m_mins.x);
+		nodeBounds.m_mins.y = fminf(nodeBounds.m_mins.y, bounds.m_mins.y);
+		nodeBounds.m_maxs.x = fmaxf(nodeBounds.m_maxs.x, bounds.m_maxs.x);
+		nodeBounds.m_maxs.y = fmaxf(nodeBounds.m_maxs.y, bounds.m_maxs.y);
+
+		Vec2 const& center = polyCenters[m_polyIndexes[polyIndexIdx]];
+		centroidBounds.m_mins.x = fminf(centroidBounds.m_mins.x, center.x);
+		centroidBounds.m_mins.y = fminf(centroidBounds.m_mins.y, center.y);
+		centroidBounds.m_maxs.x = fmaxf(centroidBounds.m_maxs.x, center.x);
+		centroidBounds.m_maxs.y = fmaxf(centroidBounds.m_maxs.y, center.y);
+	}
+	m_nodes[nodeIndex].m_bounds = nodeBounds;
+
+	if (numPolys <= MAX_POLYS_PER_LEAF)
+	{
+		m_nodes[nodeIndex].m_firstPolyIndex = firstPolyIndex;
+		m_nodes[nodeIndex].m_numPolys = numPolys;
+		return;
+	}
+
+	Vec2 centroidDimensions = centroidBounds.m_maxs - centroidBounds.m_mins;
+	bool splitAlongX = centroidDimensions.x >= centroidDimensions.y;
+	int numPolysOnLeft = numPolys / 2;
+	std::vector<int>::iterator rangeBegin = m_polyIndexes.begin() + firstPolyIndex;
+	std::nth_element(rangeBegin, rangeBegin + numPolysOnLeft, rangeBegin + numPolys, [&polyCenters, splitAlongX](int polyIndexA, int polyIndexB)
+	{
+		return splitAlongX ? polyCenters[polyIndexA].x < polyCenters[polyIndexB].x : polyCenters[polyIndexA].y < polyCenters[polyIndexB].y;
+	});
+
+	int leftChildIndex = (int)m_nodes.size();
+	m_nodes.push_back(ConvexPoly2TreeNode());
+	m_nodes.push_back(ConvexPoly2TreeNode());
+	m_nodes[nodeIndex].m_childIndexes[0] = leftChildIndex;
+	m_nodes[nodeIndex].m_childIndexes[1] = leftChildIndex + 1;
+
+	BuildSubtree(leftChildIndex, firstPolyIndex, numPolysOnLeft, polyBounds, polyCenters);
+	BuildSubtree(leftChildIndex + 1, firstPolyIndex + numPolysOnLeft, numPolys - numPolysOnLeft, polyBounds, polyCenters);
+}
+
+void ConvexPoly2Tree::LinkParentAndLeafIndexes()
+{
+	m_leafNodeIndexForPoly.assign(m_polyIndexes.size(), -1);
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		ConvexPoly2TreeNode const& node = m_nodes[nodeIndex];
+		if (node.IsLeaf())
+		{
+			for (int polyIndexIdx = node.m_firstPolyIndex; polyIndexIdx < node.m_firstPolyIndex + node.m_numPolys; polyIndexIdx++)
+			{
+				m_leafNodeIndexForPoly[m_polyIndexes[polyIndexIdx]] = nodeIndex;
+			}
+			continue;
+		}
+		m_nodes[node.m_childIndexes[0]].m_parentIndex = nodeIndex;
+		m_nodes[node.m_childIndexes[1]].m_parentIndex = nodeIndex;
+	}
+}
+
+void ConvexPoly2Tree::RefitPolyAtIndex(int polyIndex, std::vector<ConvexPoly2> const& convexPolys)
+{
+	if (polyIndex < 0 || polyIndex >= (int)m_leafNodeIndexForPoly.size())
+	{
+		return;
+	}
+
+	// Recompute the leaf from its polys, then every ancestor from its two children
+	int nodeIndex = m_leafNodeIndexForPoly[polyIndex];
+	ConvexPoly2TreeNode& leaf = m_nodes[nodeIndex];
+	leaf.m_bounds = GetBoundsForConvexPoly2(convexPolys[m_polyIndexes[leaf.m_firstPolyIndex]]);
+	for (int polyIndexIdx = leaf.m_firstPolyIndex + 1; polyIndexIdx < leaf.m_firstPolyIndex + leaf.m_numPolys; polyIndexIdx++)
+	{
+		AABB2 bounds = GetBoundsForConvexPoly2(convexPolys[m_polyIndexes[polyIndexIdx]]);
+		leaf.m_bounds.m_mins.x = fminf(leaf.m_bounds.m_mins.x, bounds.m_mins.x);
+		leaf.m_bounds.m_mins.y = fminf(leaf.m_bounds.m_mins.y, bounds.m_mins.y);
+		leaf.m_bounds.m_maxs.x = fmaxf(leaf.m_bounds.m_maxs.x, bounds.m_maxs.x);
+		leaf.m_bounds.m_maxs.y = fmaxf(leaf.m_bounds.m_maxs.y, bounds.m_maxs.y);
+	}
+
+	nodeIndex = leaf.m_parentIndex;
+	while (nodeIndex != -1)
+	{
+		ConvexPoly2TreeNode& node = m_nodes[nodeIndex];
+		AABB2 const& leftBounds = m_nodes[node.m_childIndexes[0]].m_bounds;
+		AABB2 const& rightBounds = m_nodes[node.m_childIndexes[1]].m_bounds;
+		node.m_bounds.m_mins.x = fminf(leftBounds.m_mins.x, rightBounds.m_mins.x);
+		node.m_bounds.m_mins.y = fminf(leftBounds.m_mins.y, rightBounds.m_mins.y);
+		node.m_bounds.m_maxs.x = fmaxf(leftBounds.m_maxs.x, rightBounds.m_maxs.x);
+		node.m_bounds.m_maxs.y = fmaxf(leftBounds.m_maxs.y, rightBounds.m_maxs.y);
+		nodeIndex = node.m_parentIndex;
+	}
+}
+
+int ConvexPoly2Tree::GetPolyIndexContainingPoint(Vec2 const& point, std::vector<ConvexPoly2> const& convexPolys) const
+{
+	// Overlapping polys are resolved to the lowest index, same as a linear scan in poly order
+	int containingPolyIndex = -1;
+	if (m_nodes.empty())
+	{
+		return containingPolyIndex;
+	}
+
+	auto getEntryDistance = [this, &point](int nodeIndex, float& out_entryDistance)
+	{
+		AABB2 const& bounds = m_nodes[nodeIndex].m_bounds;
+		out_entryDistance = 0.f;
+		return point.x >= bounds.m_mins.x && point.x <= bounds.m_maxs.x && point.y >= bounds.m_mins.y && point.y <= bounds.m_maxs.y;
+	};
+	auto visitNode = [this, &point, &convexPolys, &containingPolyIndex](int nodeIndex, float& inout_cutoffDistance)
+	{
+		UNUSED(inout_cutoffDistance);
+		ConvexPoly2TreeNode const& node = m_nodes[nodeIndex];
+		if (!node.IsLeaf())
+		{
+			return true;
+		}
+
+		for (int polyIndexIdx = node.m_firstPolyIndex; polyIndexIdx < node.m_firstPolyIndex + node.m_numPolys; polyIndexIdx++)
+		{
+			int polyIndex = m_polyIndexes[polyIndexIdx];
+			if ((containingPolyIndex == -1 || polyIndex < containingPolyIndex) && IsPointInsideConvexPoly2(point, convexPolys[polyIndex]))
+			{
+				containingPolyIndex = polyIndex;
+			}
+		}
+		return false;
+	};
+	TraverseTreeNearestFirst<MAX_TREE_TRAVERSAL_DEPTH>(m_nodes, 0, getEntryDistance, visitNode);
+
+	return containingPolyIndex;
+}
+
+void ConvexPoly2Tree::GetPolyIndexesOverlappingConvexPoly2(ConvexPoly2 const& convexPoly, std::vector<ConvexPoly2> const& convexPolys, std::vector<int>& out_polyIndexes) const
+{
+	if (m_nodes.empty())
+	{
+		return;
+	}
+
+	AABB2 queryBounds = GetBoundsForConvexPoly2(convexPoly);
+
+	auto getEntryDistance = [this, &queryBounds](int nodeIndex, float& out_entryDistance)
+	{
+		AABB2 const& bounds = m_nodes[nodeIndex].m_bounds;
+		out_entryDistance = 0.f;
+		return queryBounds.m_maxs.x >= bounds.m_mins.x && queryBounds.m_mins.x <= bounds.m_maxs.x && queryBounds.m_maxs.y >= bounds.m_mins.y && queryBounds.m_mins.y <= bounds.m_maxs.y;
+	};
+	auto visitNode = [this, &convexPoly, &convexPolys, &out_polyIndexes](int nodeIndex, float& inout_cutoffDistance)
+	{
+		UNUSED(inout_cutoffDistance);
+		ConvexPoly2TreeNode const& node = m_nodes[nodeIndex];
+		if (!node.IsLeaf())
+		{
+			return true;
+		}
+
+		for (int polyIndexIdx = node.m_firstPolyIndex; polyIndexIdx < node.m_firstPolyIndex + node.m_numPolys; polyIndexIdx++)
+		{
+			int polyIndex = m_polyIndexes[polyIndexIdx];
+			if (DoConvexPoly2sOverlap(convexPoly, convexPolys[polyIndex]))
+			{
+				out_polyIndexes.push_back(polyIndex);
+			}
+		}
+		return false;
+	};
+	TraverseTreeNearestFirst<MAX_TREE_TRAVERSAL_DEPTH>(m_nodes, 0, getEntryDistance, visitNode);
+}
+
+uint32_t ConvexPoly2Tree::AppendToWriter(BufferWriter& writer) const
+{
+	uint32_t payloadSize = 0;
+	writer.AppendUint32((uint32_t)m_nodes.size());
+	payloadSize += sizeof(uint32_t);
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		ConvexPoly2TreeNode const& node = m_nodes[nodeIndex];
+		writer.AppendVec2(node.m_bounds.m_mins);
+		payloadSize += sizeof(Vec2);
+		writer.AppendVec2(node.m_bounds.m_maxs);
+		payloadSize += sizeof(Vec2);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[0]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[1]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUShort((uint16_t)node.m_firstPolyIndex);
+		payloadSize += sizeof(uint16_t);
+		writer.AppendUShort((uint16_t)node.m_numPolys);
+		payloadSize += sizeof(uint16_t);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < (int)m_polyIndexes.size(); polyIndexIdx++)
+	{
+		writer.AppendUShort((uint16_t)m_polyIndexes[polyIndexIdx]);
+		payloadSize += sizeof(uint16_t);
+	}
+
+	return payloadSize;
+}
+
+bool ConvexPoly2Tree::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	uint32_t numNodes = parser.ParseUint32();
+	for (uint32_t nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		ConvexPoly2TreeNode node;
+		node.m_bounds.m_mins = parser.ParseVec2();
+		node.m_bounds.m_maxs = parser.ParseVec2();
+		node.m_childIndexes[0] = (int)parser.ParseUint32();
+		node.m_childIndexes[1] = (int)parser.ParseUint32();
+		node.m_firstPolyIndex = parser.ParseUShort();
+		node.m_numPolys = parser.ParseUShort();
+		m_nodes.push_back(node);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < numPolys; polyIndexIdx++)
+	{
+		m_polyIndexes.push_back(parser.ParseUShort());
+	}
+
+	if (!AreTreeIndexesValid(m_nodes, m_polyIndexes, numPolys, MAX_TREE_TRAVERSAL_DEPTH - 1))
+	{
+		Clear();
+		return false;
+	}
+
+	// Parent and leaf links are not saved, refitting needs them
+	LinkParentAndLeafIndexes();
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		if (m_leafNodeIndexForPoly[polyIndex] == -1)
+		{
+			Clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+AABB2 GetBoundsForConvexPoly2(ConvexPoly2 const& convexPoly)
+{
+	std::vector<Vec2> const vertexes = convexPoly.GetVertexes();
+	AABB2 bounds(vertexes[0], vertexes[0]);
+	for (int vertexIndex = 1; vertexIndex < (int)vertexes.size(); vertexIndex++)
+	{
+		bounds.m_mins.x = fminf(bounds.m_mins.x, vertexes[vertexIndex].x);
+		bounds.m_mins.y = fminf(bounds.m_mins.y, vertexes[vertexIndex].y);
+		bounds.m_maxs.x = fmaxf(bounds.m_maxs.x, vertexes[vertexIndex].x);
+		bounds.m_maxs.y = fmaxf(bounds.m_maxs.y, vertexes[vertexIndex].y);
+	}
+	return bounds;
+}
+
+bool DoConvexPoly2sOverlap(ConvexPoly2 const& convexPolyA, ConvexPoly2 const& convexPolyB)
+{
+	// Separating axis test, the only candidate axes for two convex polys are their edge normals
+	std::vector<Vec2> const vertexesA = convexPolyA.GetVertexes();
+	std::vector<Vec2> const vertexesB = convexPolyB.GetVertexes();
+	std::vector<Vec2> const* polyVertexes[2] = { &vertexesA, &vertexesB };
+
+	for (int polyIdx = 0; polyIdx < 2; polyIdx++)
+	{
+		std::vector<Vec2> const& edgeVertexes = *polyVertexes[polyIdx];
+		for (int edgeIndex = 0; edgeIndex < (int)edgeVertexes.size(); edgeIndex++)
+		{
+			Vec2 edge = edgeVertexes[(edgeIndex + 1) % (int)edgeVertexes.size()] - edgeVertexes[edgeIndex];
+			Vec2 axis(-edge.y, edge.x);
+
+			float minA = FLT_MAX;
+			float maxA = -FLT_MAX;
+			for (int vertexIndex = 0; vertexIndex < (int)vertexesA.size(); vertexIndex++)
+			{
+				float projection = DotProduct2D(vertexesA[vertexIndex], axis);
+				minA = fminf(minA, projection);
+				maxA = fmaxf(maxA, projection);
+			}
+			float minB = FLT_MAX;
+			float maxB = -FLT_MAX;
+			for (int vertexIndex = 0; vertexIndex < (int)vertexesB.size(); vertexIndex++)
+			{
+				float projection = DotProduct2D(vertexesB[vertexIndex], axis);
+				minB = fminf(minB, projection);
+				maxB = fmaxf(maxB, projection);
+			}
+
+			if (maxA < minB || maxB < minA)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
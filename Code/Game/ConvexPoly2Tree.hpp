@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/ConvexPoly2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class BufferParser;
+class BufferWriter;
+
+
+struct ConvexPoly2TreeNode
+{
+public:
+	bool IsLeaf() const { return m_numPolys > 0; }
+
+public:
+	AABB2 m_bounds;
+	int m_parentIndex = -1;
+	int m_childIndexes[2] = { -1, -1 };
+	int m_firstPolyIndex = 0;
+	int m_numPolys = 0;
+};
+
+class ConvexPoly2Tree
+{
+public:
+	~ConvexPoly2Tree() = default;
+	ConvexPoly2Tree() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys);
+	void Clear();
+	bool IsEmpty() const { return m_nodes.empty(); }
+
+	void RefitPolyAtIndex(int polyIndex, std::vector<ConvexPoly2> const& convexPolys);
+
+	int GetPolyIndexContainingPoint(Vec2 const& point, std::vector<ConvexPoly2> const& convexPolys) const;
+	void GetPolyIndexesOverlappingConvexPoly2(ConvexPoly2 const& convexPoly, std::vector<ConvexPoly2> const& convexPolys, std::vector<int>& out_polyIndexes) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+private:
+	void BuildSubtree(int nodeIndex, int firstPolyIndex, int numPolys, std::vector<AABB2> const& polyBounds, std::vector<Vec2> const& polyCenters);
+	void LinkParentAndLeafIndexes();
+
+public:
+	static constexpr int MAX_POLYS_PER_LEAF = 4;
+
+	std::vector<ConvexPoly2TreeNode> m_nodes;
+	std::vector<int> m_polyIndexes;
+	// Leaf node holding each poly, so moving a poly only refits the path from that leaf to the root
+	std::vector<int> m_leafNodeIndexForPoly;
+};
+
+AABB2 GetBoundsForConvexPoly2(ConvexPoly2 const& convexPoly);
+bool DoConvexPoly2sOverlap(ConvexPoly2 const& convexPolyA, ConvexPoly2 const& convexPolyB);
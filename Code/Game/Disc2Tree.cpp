@@ -0,0 +1,224 @@
+#include "Game/Disc2Tree.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/TreeUtils.hpp"
+#include "Game/VisualTestConvexScene.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+
+#include <algorithm>
+
+
+void Disc2Tree::Build(std::vector<BoundingDisc> const& boundingDiscs)
+{
+	Clear();
+
+	int numPolys = (int)boundingDiscs.size();
+	if (numPolys == 0)
+	{
+		return;
+	}
+
+	// Morton order puts spatially close discs next to each other, so merging neighbors pairs up nearby discs
+	AABB2 centerBounds(boundingDiscs[0].m_center, boundingDiscs[0].m_center);
+	for (int polyIndex = 1; polyIndex < numPolys; polyIndex++)
+	{
+		Vec2 const& center = boundingDiscs[polyIndex].m_center;
+		centerBounds.m_mins.x = fminf(centerBounds.m_mins.x, center.x);
+		centerBounds.m_mins.y = fminf(centerBounds.m_mins.y, center.y);
+		centerBounds.m_maxs.x = fmaxf(centerBounds.m_maxs.x, center.x);
+		centerBounds.m_maxs.y = fmaxf(centerBounds.m_maxs.y, center.y);
+	}
+
+	std::vector<uint32_t> mortonCodes;
+	mortonCodes.reserve(numPolys);
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		mortonCodes.push_back(GetMortonCodeForPosition(boundingDiscs[polyIndex].m_center, centerBounds));
+		m_polyIndexes.push_back(polyIndex);
+	}
+	std::sort(m_polyIndexes.begin(), m_polyIndexes.end(), [&mortonCodes](int polyIndexA, int polyIndexB)
+	{
+		return mortonCodes[polyIndexA] < mortonCodes[polyIndexB];
+	});
+
+	m_nodes.reserve(2 * numPolys - 1);
+	std::vector<int> currentLevelNodeIndexes;
+	for (int polyIndexIdx = 0; polyIndexIdx < numPolys; polyIndexIdx++)
+	{
+		BoundingDisc const& disc = boundingDiscs[m_polyIndexes[polyIndexIdx]];
+		Disc2TreeNode leaf;
+		leaf.m_center = disc.m_center;
+		leaf.m_radius = disc.m_radius;
+		leaf.m_firstPolyIndex = polyIndexIdx;
+		leaf.m_numPolys = 1;
+		currentLevelNodeIndexes.push_back((int)m_nodes.size());
+		m_nodes.push_back(leaf);
+	}
+
+	// Merge neighboring pairs level by level; an odd node out is carried up to the next level unchanged
+	while (currentLevelNodeIndexes.size() > 1)
+	{
+		std::vector<int> nextLevelNodeIndexes;
+		for (int levelIndex = 0; levelIndex < (int)currentLevelNodeIndexes.size(); levelIndex += 2)
+		{
+			if (levelIndex + 1 == (int)currentLevelNodeIndexes.size())
+			{
+				nextLevelNodeIndexes.push_back(currentLevelNodeIndexes[levelIndex]);
+				continue;
+			}
+
+			Disc2TreeNode parent;
+			parent.m_childIndexes[0] = currentLevelNodeIndexes[levelIndex];
+			parent.m_childIndexes[1] = currentLevelNodeIndexes[levelIndex + 1];
+			Disc2TreeNode const& childA = m_nodes[parent.m_childIndexes[0]];
+			Disc2TreeNode const& childB = m_nodes[parent.m_childIndexes[1]];
+			GetMergedDisc2D(childA.m_center, childA.m_radius, childB.m_center, childB.m_radius, parent.m_center, parent.m_radius);
+			nextLevelNodeIndexes.push_back((int)m_nodes.size());
+			m_nodes.push_back(parent);
+		}
+		currentLevelNodeIndexes = nextLevelNodeIndexes;
+	}
+}
+
+void Disc2Tree::Clear()
+{
+	m_nodes.clear();
+	m_polyIndexes.clear();
+}
+
+RaycastResult2D Disc2Tree::RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit) const
+{
+	RaycastResult2D closestResult;
+	closestResult.m_rayStartPosition = startPos;
+	closestResult.m_rayForwardNormal = fwdNormal;
+	closestResult.m_impactDistance = FLT_MAX;
+
+	auto getEntryDistance = [this, &startPos, &fwdNormal, maxDistance](int nodeIndex, float& out_entryDistance)
+	{
+		Disc2TreeNode const& node = m_nodes[nodeIndex];
+		return GetRayEntryDistanceVsDisc2D(startPos, fwdNormal, maxDistance, node.m_center, node.m_radius, out_entryDistance);
+	};
+	auto visitNode = [this, &startPos, &fwdNormal, maxDistance, &raycastVsHull, stopAtFirstHit, &closestResult, &out_numHullTests](int nodeIndex, float& inout_cutoffDistance)
+	{
+		Disc2TreeNode const& node = m_nodes[nodeIndex];
+		if (!node.IsLeaf())
+		{
+			return true;
+		}
+
+		for (int polyIndexIdx = node.m_firstPolyIndex; polyIndexIdx < node.m_firstPolyIndex + node.m_numPolys; polyIndexIdx++)
+		{
+			out_numHullTests++;
+			RaycastResult2D raycastVsConvexHullResult = raycastVsHull(m_polyIndexes[polyIndexIdx], startPos, fwdNormal, maxDistance);
+			if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+			{
+				closestResult = raycastVsConvexHullResult;
+				if (stopAtFirstHit)
+				{
+					inout_cutoffDistance = -1.f;
+					return false;
+				}
+			}
+		}
+		inout_cutoffDistance = closestResult.m_impactDistance;
+		return false;
+	};
+	TraverseTreeNearestFirst<MAX_TREE_TRAVERSAL_DEPTH>(m_nodes, GetRootIndex(), getEntryDistance, visitNode);
+
+	return closestResult;
+}
+
+void Disc2Tree::AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		if (!m_nodes[nodeIndex].IsLeaf())
+		{
+			AddVertsForRing2D(verts, m_nodes[nodeIndex].m_center, m_nodes[nodeIndex].m_radius, lineThickness, color);
+		}
+	}
+}
+
+uint32_t Disc2Tree::AppendToWriter(BufferWriter& writer) const
+{
+	uint32_t payloadSize = 0;
+	writer.AppendUint32((uint32_t)m_nodes.size());
+	payloadSize += sizeof(uint32_t);
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		Disc2TreeNode const& node = m_nodes[nodeIndex];
+		writer.AppendVec2(node.m_center);
+		payloadSize += sizeof(Vec2);
+		writer.AppendFloat(node.m_radius);
+		payloadSize += sizeof(float);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[0]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[1]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUShort((uint16_t)node.m_firstPolyIndex);
+		payloadSize += sizeof(uint16_t);
+		writer.AppendUShort((uint16_t)node.m_numPolys);
+		payloadSize += sizeof(uint16_t);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < (int)m_polyIndexes.size(); polyIndexIdx++)
+	{
+		writer.AppendUShort((uint16_t)m_polyIndexes[polyIndexIdx]);
+		payloadSize += sizeof(uint16_t);
+	}
+
+	return payloadSize;
+}
+
+bool Disc2Tree::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	uint32_t numNodes = parser.ParseUint32();
+	for (uint32_t nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		Disc2TreeNode node;
+		node.m_center = parser.ParseVec2();
+		node.m_radius = parser.ParseFloat();
+		node.m_childIndexes[0] = (int)parser.ParseUint32();
+		node.m_childIndexes[1] = (int)parser.ParseUint32();
+		node.m_firstPolyIndex = parser.ParseUShort();
+		node.m_numPolys = parser.ParseUShort();
+		m_nodes.push_back(node);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < numPolys; polyIndexIdx++)
+	{
+		m_polyIndexes.push_back(parser.ParseUShort());
+	}
+
+	if (!AreTreeIndexesValid(m_nodes, m_polyIndexes, numPolys, MAX_TREE_TRAVERSAL_DEPTH - 1, TreeNodeOrder::CHILDREN_FIRST))
+	{
+		Clear();
+		return false;
+	}
+
+	return true;
+}
+
+void GetMergedDisc2D(Vec2 const& centerA, float radiusA, Vec2 const& centerB, float radiusB, Vec2& out_center, float& out_radius)
+{
+	float centerDistance = GetDistance2D(centerA, centerB);
+	if (centerDistance + radiusB <= radiusA)
+	{
+		out_center = centerA;
+		out_radius = radiusA;
+		return;
+	}
+	if (centerDistance + radiusA <= radiusB)
+	{
+		out_center = centerB;
+		out_radius = radiusB;
+		return;
+	}
+
+	// Smallest disc touching the far sides of both discs along the line through their centers
+	out_radius = 0.5f * (centerDistance + radiusA + radiusB);
+	out_center = centerA + (centerB - centerA) * ((out_radius - radiusA) / centerDistance);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Game/HullRaycastFunction.hpp"
+
+#include "Engine/Math/ConvexHull2.hpp"
+#include "Engine/Math/Vec2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct BoundingDisc;
+struct RaycastResult2D;
+struct Vertex_PCU;
+struct Rgba8;
+class BufferParser;
+class BufferWriter;
+
+
+struct Disc2TreeNode
+{
+public:
+	bool IsLeaf() const { return m_numPolys > 0; }
+
+public:
+	Vec2 m_center = Vec2::ZERO;
+	float m_radius = 0.f;
+	int m_childIndexes[2] = { -1, -1 };
+	int m_firstPolyIndex = 0;
+	int m_numPolys = 0;
+};
+
+class Disc2Tree
+{
+public:
+	~Disc2Tree() = default;
+	Disc2Tree() = default;
+
+	void Build(std::vector<BoundingDisc> const& boundingDiscs);
+	void Clear();
+	bool IsEmpty() const { return m_nodes.empty(); }
+	int GetRootIndex() const { return (int)m_nodes.size() - 1; }
+
+	RaycastResult2D RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit = false) const;
+
+	void AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+public:
+
+	// Nodes are stored bottom-up: one leaf per poly first, then each merged level, root last
+	std::vector<Disc2TreeNode> m_nodes;
+	std::vector<int> m_polyIndexes;
+};
+
+void GetMergedDisc2D(Vec2 const& centerA, float radiusA, Vec2 const& centerB, float radiusB, Vec2& out_center, float& out_radius);
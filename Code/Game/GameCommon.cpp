@@ -1,6 +1,13 @@
 #include "Game/GameCommon.hpp"
 
+#include <cstdlib>
+#include <new>
+
 BitmapFont* g_squirrelFont = nullptr;
+#if defined(TRACK_HEAP_ALLOCATIONS)
+// Per thread, so a timed section only sees its own allocations and not those of the engine's other threads
+static thread_local long long s_numHeapAllocationsOnThisThread = 0;
+#endif
 char const* CONVEX_SCENE_4CC_CODE = "GHCS";
 char const* CONVEX_HEADER_END_4CC_CODE = "ENDH";
 char const* CONVEX_CHUNK_4CC_CODE = "GHCK";
@@ -147,4 +154,296 @@ void DrawBoxOutline(AABB2 const& boundedBox, float thickness, Rgba8 const& color
 	DebugDrawLine(Vec2(topRight.x, bottomLeft.y), topRight, thickness, color);
 	DebugDrawLine(topRight, Vec2(bottomLeft.x, topRight.y), thickness, color);
 	DebugDrawLine(Vec2(bottomLeft.x, topRight.y), bottomLeft, thickness, color);
-}
\ No newline at end of file
+}
+
+bool GetRayEntryDistanceVsAABB2(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, AABB2 const& box, float& out_entryDistance)
+{
+	// Slab test, cheaper than RaycastVsAABB2 since no impact position or normal is needed for culling
+	float entryDistance = 0.f;
+	float exitDistance = maxDistance;
+
+	if (fwdNormal.x != 0.f)
+	{
+		float oneOverFwdX = 1.f / fwdNormal.x;
+		float minsXDistance = (box.m_mins.x - startPos.x) * oneOverFwdX;
+		float maxsXDistance = (box.m_maxs.x - startPos.x) * oneOverFwdX;
+		entryDistance = fmaxf(entryDistance, fminf(minsXDistance, maxsXDistance));
+		exitDistance = fminf(exitDistance, fmaxf(minsXDistance, maxsXDistance));
+	}
+	else if (startPos.x < box.m_mins.x || startPos.x > box.m_maxs.x)
+	{
+		return false;
+	}
+
+	if (fwdNormal.y != 0.f)
+	{
+		float oneOverFwdY = 1.f / fwdNormal.y;
+		float minsYDistance = (box.m_mins.y - startPos.y) * oneOverFwdY;
+		float maxsYDistance = (box.m_maxs.y - startPos.y) * oneOverFwdY;
+		entryDistance = fmaxf(entryDistance, fminf(minsYDistance, maxsYDistance));
+		exitDistance = fminf(exitDistance, fmaxf(minsYDistance, maxsYDistance));
+	}
+	else if (startPos.y < box.m_mins.y || startPos.y > box.m_maxs.y)
+	{
+		return false;
+	}
+
+	if (entryDistance > exitDistance)
+	{
+		return false;
+	}
+
+	out_entryDistance = entryDistance;
+	return true;
+}
+
+bool GetRayEntryDistanceVsOBB2(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, OBB2 const& orientedBox, float& out_entryDistance)
+{
+	// Move the ray into the box's local space, where the box is an AABB2 centered at the origin
+	Vec2 const& iBasis = orientedBox.m_iBasisNormal;
+	Vec2 jBasis = iBasis.GetRotated90Degrees();
+	Vec2 displacementCenterToStart = startPos - orientedBox.m_center;
+	Vec2 localStartPos(DotProduct2D(displacementCenterToStart, iBasis), DotProduct2D(displacementCenterToStart, jBasis));
+	Vec2 localFwdNormal(DotProduct2D(fwdNormal, iBasis), DotProduct2D(fwdNormal, jBasis));
+
+	return GetRayEntryDistanceVsAABB2(localStartPos, localFwdNormal, maxDistance, AABB2(-orientedBox.m_halfDimensions, orientedBox.m_halfDimensions), out_entryDistance);
+}
+
+bool GetRayEntryDistanceVsDisc2D(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, Vec2 const& discCenter, float discRadius, float& out_entryDistance)
+{
+	Vec2 displacementStartToCenter = discCenter - startPos;
+	float centerDistanceAlongRay = DotProduct2D(displacementStartToCenter, fwdNormal);
+	float centerDistanceSquared = DotProduct2D(displacementStartToCenter, displacementStartToCenter);
+	float discRadiusSquared = discRadius * discRadius;
+	if (centerDistanceSquared <= discRadiusSquared)
+	{
+		out_entryDistance = 0.f;
+		return true;
+	}
+	if (centerDistanceAlongRay < 0.f)
+	{
+		return false;
+	}
+
+	float perpendicularDistanceSquared = centerDistanceSquared - centerDistanceAlongRay * centerDistanceAlongRay;
+	if (perpendicularDistanceSquared > discRadiusSquared)
+	{
+		return false;
+	}
+
+	float entryDistance = centerDistanceAlongRay - sqrtf(discRadiusSquared - perpendicularDistanceSquared);
+	if (entryDistance > maxDistance)
+	{
+		return false;
+	}
+
+	out_entryDistance = entryDistance;
+	return true;
+}
+
+uint32_t GetMortonCodeForPosition(Vec2 const& position, AABB2 const& bounds)
+{
+	// 16 bits per axis, x bits in even positions and y bits in odd positions
+	Vec2 boundsDimensions = bounds.m_maxs - bounds.m_mins;
+	float normalizedX = boundsDimensions.x > 0.f ? GetClamped((position.x - bounds.m_mins.x) / boundsDimensions.x, 0.f, 1.f) : 0.f;
+	float normalizedY = boundsDimensions.y > 0.f ? GetClamped((position.y - bounds.m_mins.y) / boundsDimensions.y, 0.f, 1.f) : 0.f;
+	uint32_t mortonCode = 0;
+	uint32_t quantizedX = (uint32_t)(normalizedX * 65535.f);
+	uint32_t quantizedY = (uint32_t)(normalizedY * 65535.f);
+	for (int bitIndex = 0; bitIndex < 16; bitIndex++)
+	{
+		mortonCode |= ((quantizedX >> bitIndex) & 1u) << (2 * bitIndex);
+		mortonCode |= ((quantizedY >> bitIndex) & 1u) << (2 * bitIndex + 1);
+	}
+
+	return mortonCode;
+}
+
+static void GetDiscThroughTwoPoints(Vec2 const& pointA, Vec2 const& pointB, Vec2& out_discCenter, float& out_discRadius)
+{
+	out_discCenter = (pointA + pointB) * 0.5f;
+	out_discRadius = GetDistance2D(pointA, pointB) * 0.5f;
+}
+
+static void GetDiscThroughThreePoints(Vec2 const& pointA, Vec2 const& pointB, Vec2 const& pointC, Vec2& out_discCenter, float& out_discRadius)
+{
+	// Circumcircle; (nearly) collinear points fall back to the disc spanning the farthest pair
+	Vec2 displacementAToB = pointB - pointA;
+	Vec2 displacementAToC = pointC - pointA;
+	float determinant = 2.f * CrossProduct2D(displacementAToB, displacementAToC);
+	if (fabsf(determinant) < 1e-12f)
+	{
+		GetDiscThroughTwoPoints(pointA, pointB, out_discCenter, out_discRadius);
+		Vec2 candidateCenter;
+		float candidateRadius = 0.f;
+		GetDiscThroughTwoPoints(pointA, pointC, candidateCenter, candidateRadius);
+		if (candidateRadius > out_discRadius)
+		{
+			out_discCenter = candidateCenter;
+			out_discRadius = candidateRadius;
+		}
+		GetDiscThroughTwoPoints(pointB, pointC, candidateCenter, candidateRadius);
+		if (candidateRadius > out_discRadius)
+		{
+			out_discCenter = candidateCenter;
+			out_discRadius = candidateRadius;
+		}
+		return;
+	}
+
+	float lengthSquaredAToB = DotProduct2D(displacementAToB, displacementAToB);
+	float lengthSquaredAToC = DotProduct2D(displacementAToC, displacementAToC);
+	Vec2 centerOffset((displacementAToC.y * lengthSquaredAToB - displacementAToB.y * lengthSquaredAToC) / determinant, (displacementAToB.x * lengthSquaredAToC - displacementAToC.x * lengthSquaredAToB) / determinant);
+	out_discCenter = pointA + centerOffset;
+	out_discRadius = centerOffset.GetLength();
+}
+
+void GetMinimalEnclosingDisc2D(std::vector<Vec2> const& points, Vec2& out_discCenter, float& out_discRadius)
+{
+	out_discCenter = points.empty() ? Vec2::ZERO : points[0];
+	out_discRadius = 0.f;
+
+	// Welzl's algorithm unrolled into its iterative form: whenever a point falls outside, it must lie on the boundary of the disc for the points so far
+	constexpr float CONTAINMENT_TOLERANCE = 1.0001f;
+	for (int pointIndex = 1; pointIndex < (int)points.size(); pointIndex++)
+	{
+		if (GetDistance2D(out_discCenter, points[pointIndex]) <= out_discRadius * CONTAINMENT_TOLERANCE)
+		{
+			continue;
+		}
+
+		out_discCenter = points[pointIndex];
+		out_discRadius = 0.f;
+		for (int firstBoundaryIndex = 0; firstBoundaryIndex < pointIndex; firstBoundaryIndex++)
+		{
+			if (GetDistance2D(out_discCenter, points[firstBoundaryIndex]) <= out_discRadius * CONTAINMENT_TOLERANCE)
+			{
+				continue;
+			}
+
+			GetDiscThroughTwoPoints(points[pointIndex], points[firstBoundaryIndex], out_discCenter, out_discRadius);
+			for (int secondBoundaryIndex = 0; secondBoundaryIndex < firstBoundaryIndex; secondBoundaryIndex++)
+			{
+				if (GetDistance2D(out_discCenter, points[secondBoundaryIndex]) <= out_discRadius * CONTAINMENT_TOLERANCE)
+				{
+					continue;
+				}
+
+				GetDiscThroughThreePoints(points[pointIndex], points[firstBoundaryIndex], points[secondBoundaryIndex], out_discCenter, out_discRadius);
+			}
+		}
+	}
+
+	// The tolerance above can leave points a hair outside; grow to the farthest one so the disc stays a conservative proxy
+	for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+	{
+		out_discRadius = fmaxf(out_discRadius, GetDistance2D(out_discCenter, points[pointIndex]));
+	}
+}
+
+OBB2 GetMinimalAreaOBB2ForConvexPolygon(std::vector<Vec2> const& ccwVertexes)
+{
+	int numVertexes = (int)ccwVertexes.size();
+	if (numVertexes < 3)
+	{
+		Vec2 mins = numVertexes > 0 ? ccwVertexes[0] : Vec2::ZERO;
+		Vec2 maxs = numVertexes > 1 ? ccwVertexes[1] : mins;
+		return OBB2((mins + maxs) * 0.5f, Vec2(1.f, 0.f), Vec2(fabsf(maxs.x - mins.x), fabsf(maxs.y - mins.y)) * 0.5f);
+	}
+
+	// The minimal box has one side flush with a hull edge. Rotating calipers walk the three other extreme vertexes
+	// (farthest along the edge, farthest from it, farthest behind it) forward as the edge direction turns, so each only goes around once
+	int maxAlongEdgeIndex = 0;
+	int maxAwayFromEdgeIndex = 0;
+	int minAlongEdgeIndex = 0;
+	bool haveExtremeVertexes = false;
+	float bestArea = FLT_MAX;
+	OBB2 bestBox;
+	for (int edgeIndex = 0; edgeIndex < numVertexes; edgeIndex++)
+	{
+		Vec2 const& edgeStart = ccwVertexes[edgeIndex];
+		Vec2 edgeDirection = ccwVertexes[(edgeIndex + 1) % numVertexes] - edgeStart;
+		if (edgeDirection == Vec2::ZERO)
+		{
+			continue;
+		}
+		edgeDirection = edgeDirection.GetNormalized();
+		Vec2 inwardDirection = edgeDirection.GetRotated90Degrees();
+
+		if (!haveExtremeVertexes)
+		{
+			haveExtremeVertexes = true;
+			for (int vertexIndex = 1; vertexIndex < numVertexes; vertexIndex++)
+			{
+				Vec2 displacement = ccwVertexes[vertexIndex] - edgeStart;
+				maxAlongEdgeIndex = DotProduct2D(displacement, edgeDirection) > DotProduct2D(ccwVertexes[maxAlongEdgeIndex] - edgeStart, edgeDirection) ? vertexIndex : maxAlongEdgeIndex;
+				maxAwayFromEdgeIndex = DotProduct2D(displacement, inwardDirection) > DotProduct2D(ccwVertexes[maxAwayFromEdgeIndex] - edgeStart, inwardDirection) ? vertexIndex : maxAwayFromEdgeIndex;
+				minAlongEdgeIndex = DotProduct2D(displacement, edgeDirection) < DotProduct2D(ccwVertexes[minAlongEdgeIndex] - edgeStart, edgeDirection) ? vertexIndex : minAlongEdgeIndex;
+			}
+		}
+		else
+		{
+			for (int step = 0; step < numVertexes && DotProduct2D(ccwVertexes[(maxAlongEdgeIndex + 1) % numVertexes] - ccwVertexes[maxAlongEdgeIndex], edgeDirection) > 0.f; step++)
+			{
+				maxAlongEdgeIndex = (maxAlongEdgeIndex + 1) % numVertexes;
+			}
+			for (int step = 0; step < numVertexes && DotProduct2D(ccwVertexes[(maxAwayFromEdgeIndex + 1) % numVertexes] - ccwVertexes[maxAwayFromEdgeIndex], inwardDirection) > 0.f; step++)
+			{
+				maxAwayFromEdgeIndex = (maxAwayFromEdgeIndex + 1) % numVertexes;
+			}
+			for (int step = 0; step < numVertexes && DotProduct2D(ccwVertexes[(minAlongEdgeIndex + 1) % numVertexes] - ccwVertexes[minAlongEdgeIndex], edgeDirection) < 0.f; step++)
+			{
+				minAlongEdgeIndex = (minAlongEdgeIndex + 1) % numVertexes;
+			}
+		}
+
+		float maxAlongEdge = DotProduct2D(ccwVertexes[maxAlongEdgeIndex] - edgeStart, edgeDirection);
+		float minAlongEdge = DotProduct2D(ccwVertexes[minAlongEdgeIndex] - edgeStart, edgeDirection);
+		float maxAwayFromEdge = DotProduct2D(ccwVertexes[maxAwayFromEdgeIndex] - edgeStart, inwardDirection);
+		float area = (maxAlongEdge - minAlongEdge) * maxAwayFromEdge;
+		if (area < bestArea)
+		{
+			bestArea = area;
+			Vec2 center = edgeStart + edgeDirection * (0.5f * (minAlongEdge + maxAlongEdge)) + inwardDirection * (0.5f * maxAwayFromEdge);
+			bestBox = OBB2(center, edgeDirection, Vec2(0.5f * (maxAlongEdge - minAlongEdge), 0.5f * maxAwayFromEdge));
+		}
+	}
+
+	// Pad by a tiny fraction of the box so vertexes on its sides are not lost to rounding in the ray test
+	bestBox.m_halfDimensions += Vec2(1.f, 1.f) * (1e-4f * (bestBox.m_halfDimensions.x + bestBox.m_halfDimensions.y));
+	return bestBox;
+}
+
+long long GetNumHeapAllocationsOnThisThread()
+{
+#if defined(TRACK_HEAP_ALLOCATIONS)
+	return s_numHeapAllocationsOnThisThread;
+#else
+	return 0;
+#endif
+}
+
+#if defined(TRACK_HEAP_ALLOCATIONS)
+// The array and nothrow forms forward to these, so replacing the scalar pair is enough to count everything
+void* operator new(size_t size)
+{
+	s_numHeapAllocationsOnThisThread++;
+	void* memory = malloc(size > 0 ? size : 1);
+	if (memory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t size) noexcept
+{
+	UNUSED(size);
+	free(memory);
+}
+#endif
@@ -41,7 +41,9 @@ extern char const* CONVEX_SCENE_TOC_4CC_CODE;
 extern char const* CONVEX_SCENE_TOC_END_4CC_CODE;
 constexpr uint8_t COHORT_ID = 33;
 constexpr uint8_t MAJOR_VERSION = 1;
-constexpr uint8_t MINOR_VERSION = 1;
+constexpr uint8_t MINOR_VERSION = 2;
+// TILED_BIT_REGIONS chunks store their grid dimensions from this minor version on
+constexpr uint8_t MIN_MINOR_VERSION_WITH_BIT_REGION_GRID_SIZE = 2;
 
 enum class ChunkType : uint8_t
 {
@@ -63,4 +65,18 @@ enum class ChunkType : uint8_t
 	BSP2_TREE = 0x8B,
 	BVH_COMPOSITE_TREE = 0x8C,
 	BVH_CONVEX_POLY_TREE = 0x8D,
+	HIERARCHICAL_BIT_BUCKETS = 0x8E,
 };
+
+bool GetRayEntryDistanceVsAABB2(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, AABB2 const& box, float& out_entryDistance);
+bool GetRayEntryDistanceVsOBB2(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, OBB2 const& orientedBox, float& out_entryDistance);
+bool GetRayEntryDistanceVsDisc2D(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, Vec2 const& discCenter, float discRadius, float& out_entryDistance);
+uint32_t GetMortonCodeForPosition(Vec2 const& position, AABB2 const& bounds);
+void GetMinimalEnclosingDisc2D(std::vector<Vec2> const& points, Vec2& out_discCenter, float& out_discRadius);
+OBB2 GetMinimalAreaOBB2ForConvexPolygon(std::vector<Vec2> const& ccwVertexes);
+
+// Debug builds count every global operator new on each thread, so hot loops can check that they stay off the heap
+#if defined(_DEBUG)
+#define TRACK_HEAP_ALLOCATIONS
+#endif
+long long GetNumHeapAllocationsOnThisThread();
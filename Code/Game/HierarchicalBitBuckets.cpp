@@ -0,0 +1,347 @@
+#include "Game/HierarchicalBitBuckets.hpp"
+
+#include "Game/GameCommon.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+
+
+static int CountSetBits(uint64_t bits)
+{
+	bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+	bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+	bits = (bits + (bits >> 4)) & 0x0f0f0f0f0f0f0f0full;
+	return (int)((bits * 0x0101010101010101ull) >> 56);
+}
+
+static int GetFineTileForGridCoordinate(float gridCoordinate)
+{
+	int tile = (int)floorf(gridCoordinate);
+	return tile < 0 ? 0 : (tile >= HierarchicalBitBuckets::FINE_TILES_PER_SIDE ? HierarchicalBitBuckets::FINE_TILES_PER_SIDE - 1 : tile);
+}
+
+void HierarchicalBitBuckets::Build(std::vector<ConvexPoly2> const& convexPolys, AABB2 const& bounds)
+{
+	Clear();
+
+	m_bounds = bounds;
+	int numPolys = (int)convexPolys.size();
+	m_polyCoarseMasks.resize(numPolys, 0ull);
+	m_polyFineMaskStartIndexes.resize(numPolys, 0);
+
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		m_polyFineMaskStartIndexes[polyIndex] = (int)m_fineMasks.size();
+
+		std::vector<Vec2> const vertexes = convexPolys[polyIndex].GetVertexes();
+		bool isOutsideBounds = false;
+		for (int vertexIndex = 0; vertexIndex < (int)vertexes.size(); vertexIndex++)
+		{
+			Vec2 const& vertex = vertexes[vertexIndex];
+			isOutsideBounds = isOutsideBounds || vertex.x < m_bounds.m_mins.x || vertex.y < m_bounds.m_mins.y || vertex.x > m_bounds.m_maxs.x || vertex.y > m_bounds.m_maxs.y;
+		}
+		if (isOutsideBounds)
+		{
+			m_outsideBoundsPolyIndexes.push_back(polyIndex);
+			continue;
+		}
+
+		// Like the bit bucket grid, polys mark the tiles their edges touch
+		HierarchicalBitMask polyMask;
+		for (int vertexIndex = 0; vertexIndex < (int)vertexes.size(); vertexIndex++)
+		{
+			AddSegmentToMask(vertexes[vertexIndex], vertexes[(vertexIndex + 1) % (int)vertexes.size()], polyMask);
+		}
+
+		m_polyCoarseMasks[polyIndex] = polyMask.m_coarseMask;
+		for (int superTileIndex = 0; superTileIndex < 64; superTileIndex++)
+		{
+			if ((polyMask.m_coarseMask & (1ull << superTileIndex)) != 0ull)
+			{
+				m_fineMasks.push_back(polyMask.m_fineMasks[superTileIndex]);
+			}
+		}
+	}
+}
+
+void HierarchicalBitBuckets::Clear()
+{
+	m_polyCoarseMasks.clear();
+	m_polyFineMaskStartIndexes.clear();
+	m_fineMasks.clear();
+	m_outsideBoundsPolyIndexes.clear();
+}
+
+void HierarchicalBitBuckets::AddSegmentToMask(Vec2 const& start, Vec2 const& end, HierarchicalBitMask& mask) const
+{
+	float tileWidth = (m_bounds.m_maxs.x - m_bounds.m_mins.x) / (float)FINE_TILES_PER_SIDE;
+	float tileHeight = (m_bounds.m_maxs.y - m_bounds.m_mins.y) / (float)FINE_TILES_PER_SIDE;
+	float startX = (start.x - m_bounds.m_mins.x) / tileWidth;
+	float startY = (start.y - m_bounds.m_mins.y) / tileHeight;
+	float endX = (end.x - m_bounds.m_mins.x) / tileWidth;
+	float endY = (end.y - m_bounds.m_mins.y) / tileHeight;
+
+	int tileX = GetFineTileForGridCoordinate(startX);
+	int tileY = GetFineTileForGridCoordinate(startY);
+	int endTileX = GetFineTileForGridCoordinate(endX);
+	int endTileY = GetFineTileForGridCoordinate(endY);
+
+	// Walk the fine tiles the segment crosses, parameterized from 0 at start to 1 at end
+	float deltaX = endX - startX;
+	float deltaY = endY - startY;
+	int stepX = deltaX < 0.f ? -1 : 1;
+	int stepY = deltaY < 0.f ? -1 : 1;
+	float tDeltaX = deltaX != 0.f ? 1.f / fabsf(deltaX) : FLT_MAX;
+	float tDeltaY = deltaY != 0.f ? 1.f / fabsf(deltaY) : FLT_MAX;
+	float tNextX = deltaX != 0.f ? (stepX > 0 ? (float)(tileX + 1) - startX : startX - (float)tileX) * tDeltaX : FLT_MAX;
+	float tNextY = deltaY != 0.f ? (stepY > 0 ? (float)(tileY + 1) - startY : startY - (float)tileY) * tDeltaY : FLT_MAX;
+
+	while (true)
+	{
+		int superTileIndex = (tileY / FINE_TILES_PER_SUPER_TILE_SIDE) * SUPER_TILES_PER_SIDE + tileX / FINE_TILES_PER_SUPER_TILE_SIDE;
+		uint64_t superTileBit = 1ull << superTileIndex;
+		if ((mask.m_coarseMask & superTileBit) == 0ull)
+		{
+			mask.m_coarseMask |= superTileBit;
+			mask.m_superTileIndexes[mask.m_numSuperTiles] = (uint8_t)superTileIndex;
+			mask.m_numSuperTiles++;
+			mask.m_fineMasks[superTileIndex] = 0ull;
+		}
+		mask.m_fineMasks[superTileIndex] |= 1ull << ((tileY % FINE_TILES_PER_SUPER_TILE_SIDE) * FINE_TILES_PER_SUPER_TILE_SIDE + tileX % FINE_TILES_PER_SUPER_TILE_SIDE);
+
+		if (tileX == endTileX && tileY == endTileY)
+		{
+			return;
+		}
+		if (tNextX < tNextY)
+		{
+			if (tNextX > 1.f)
+			{
+				return;
+			}
+			tileX += stepX;
+			tNextX += tDeltaX;
+		}
+		else
+		{
+			if (tNextY > 1.f)
+			{
+				return;
+			}
+			tileY += stepY;
+			tNextY += tDeltaY;
+		}
+		if (tileX < 0 || tileY < 0 || tileX >= FINE_TILES_PER_SIDE || tileY >= FINE_TILES_PER_SIDE)
+		{
+			return;
+		}
+	}
+}
+
+void HierarchicalBitBuckets::GetMaskForRaycast(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HierarchicalBitMask& out_rayMask) const
+{
+	out_rayMask.m_coarseMask = 0ull;
+	out_rayMask.m_numSuperTiles = 0;
+
+	// Clip the ray to the bucket bounds
+	float entryDistance = 0.f;
+	float exitDistance = maxDistance;
+	for (int axis = 0; axis < 2; axis++)
+	{
+		float start = axis == 0 ? startPos.x : startPos.y;
+		float fwd = axis == 0 ? fwdNormal.x : fwdNormal.y;
+		float boundsMin = axis == 0 ? m_bounds.m_mins.x : m_bounds.m_mins.y;
+		float boundsMax = axis == 0 ? m_bounds.m_maxs.x : m_bounds.m_maxs.y;
+		if (fwd == 0.f)
+		{
+			if (start < boundsMin || start > boundsMax)
+			{
+				return;
+			}
+			continue;
+		}
+		float minPlaneDistance = (boundsMin - start) / fwd;
+		float maxPlaneDistance = (boundsMax - start) / fwd;
+		entryDistance = fmaxf(entryDistance, fminf(minPlaneDistance, maxPlaneDistance));
+		exitDistance = fminf(exitDistance, fmaxf(minPlaneDistance, maxPlaneDistance));
+	}
+	if (entryDistance > exitDistance)
+	{
+		return;
+	}
+
+	// Fine masks are only built for the super-tiles the ray crosses
+	AddSegmentToMask(startPos + fwdNormal * entryDistance, startPos + fwdNormal * exitDistance, out_rayMask);
+}
+
+bool HierarchicalBitBuckets::DoesPolyOverlapRayMask(int polyIndex, HierarchicalBitMask const& rayMask) const
+{
+	uint64_t polyCoarseMask = m_polyCoarseMasks[polyIndex];
+	if ((polyCoarseMask & rayMask.m_coarseMask) == 0ull)
+	{
+		return false;
+	}
+
+	uint64_t const* polyFineMasks = &m_fineMasks[m_polyFineMaskStartIndexes[polyIndex]];
+	for (int rayTileIndex = 0; rayTileIndex < rayMask.m_numSuperTiles; rayTileIndex++)
+	{
+		int superTileIndex = rayMask.m_superTileIndexes[rayTileIndex];
+		uint64_t superTileBit = 1ull << superTileIndex;
+		if ((polyCoarseMask & superTileBit) == 0ull)
+		{
+			continue;
+		}
+
+		// The poly's fine masks are packed, so its fine mask for this super-tile comes after one for each lower set coarse bit
+		int fineMaskIndex = CountSetBits(polyCoarseMask & (superTileBit - 1ull));
+		if ((polyFineMasks[fineMaskIndex] & rayMask.m_fineMasks[superTileIndex]) != 0ull)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+RaycastResult2D HierarchicalBitBuckets::RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit) const
+{
+	RaycastResult2D closestResult;
+	closestResult.m_rayStartPosition = startPos;
+	closestResult.m_rayForwardNormal = fwdNormal;
+	closestResult.m_impactDistance = FLT_MAX;
+
+	HierarchicalBitMask rayMask;
+	GetMaskForRaycast(startPos, fwdNormal, maxDistance, rayMask);
+
+	for (int outsideIndex = 0; outsideIndex < (int)m_outsideBoundsPolyIndexes.size(); outsideIndex++)
+	{
+		out_numHullTests++;
+		RaycastResult2D raycastVsConvexHullResult = raycastVsHull(m_outsideBoundsPolyIndexes[outsideIndex], startPos, fwdNormal, maxDistance);
+		if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+		{
+			closestResult = raycastVsConvexHullResult;
+			if (stopAtFirstHit)
+			{
+				return closestResult;
+			}
+		}
+	}
+
+	if (rayMask.m_coarseMask == 0ull)
+	{
+		return closestResult;
+	}
+
+	for (int polyIndex = 0; polyIndex < (int)m_polyCoarseMasks.size(); polyIndex++)
+	{
+		if (!DoesPolyOverlapRayMask(polyIndex, rayMask))
+		{
+			continue;
+		}
+
+		out_numHullTests++;
+		RaycastResult2D raycastVsConvexHullResult = raycastVsHull(polyIndex, startPos, fwdNormal, maxDistance);
+		if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+		{
+			closestResult = raycastVsConvexHullResult;
+			if (stopAtFirstHit)
+			{
+				return closestResult;
+			}
+		}
+	}
+
+	return closestResult;
+}
+
+void HierarchicalBitBuckets::AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	for (int tileLine = 0; tileLine <= FINE_TILES_PER_SIDE; tileLine++)
+	{
+		// Super-tile boundaries are drawn thicker than the fine tile lines inside them
+		float thickness = tileLine % FINE_TILES_PER_SUPER_TILE_SIDE == 0 ? lineThickness : 0.25f * lineThickness;
+		float x = m_bounds.m_mins.x + (float)tileLine * (m_bounds.m_maxs.x - m_bounds.m_mins.x) / (float)FINE_TILES_PER_SIDE;
+		float y = m_bounds.m_mins.y + (float)tileLine * (m_bounds.m_maxs.y - m_bounds.m_mins.y) / (float)FINE_TILES_PER_SIDE;
+		AddVertsForLineSegment2D(verts, Vec2(x, m_bounds.m_mins.y), Vec2(x, m_bounds.m_maxs.y), thickness, color);
+		AddVertsForLineSegment2D(verts, Vec2(m_bounds.m_mins.x, y), Vec2(m_bounds.m_maxs.x, y), thickness, color);
+	}
+}
+
+uint32_t HierarchicalBitBuckets::AppendToWriter(BufferWriter& writer) const
+{
+	uint32_t payloadSize = 0;
+	writer.AppendVec2(m_bounds.m_mins);
+	payloadSize += sizeof(Vec2);
+	writer.AppendVec2(m_bounds.m_maxs);
+	payloadSize += sizeof(Vec2);
+	writer.AppendUint32((uint32_t)m_fineMasks.size());
+	payloadSize += sizeof(uint32_t);
+	for (int polyIndex = 0; polyIndex < (int)m_polyCoarseMasks.size(); polyIndex++)
+	{
+		writer.AppendUint64(m_polyCoarseMasks[polyIndex]);
+		payloadSize += sizeof(uint64_t);
+	}
+	for (int fineMaskIndex = 0; fineMaskIndex < (int)m_fineMasks.size(); fineMaskIndex++)
+	{
+		writer.AppendUint64(m_fineMasks[fineMaskIndex]);
+		payloadSize += sizeof(uint64_t);
+	}
+	writer.AppendUShort((uint16_t)m_outsideBoundsPolyIndexes.size());
+	payloadSize += sizeof(uint16_t);
+	for (int outsideIndex = 0; outsideIndex < (int)m_outsideBoundsPolyIndexes.size(); outsideIndex++)
+	{
+		writer.AppendUShort((uint16_t)m_outsideBoundsPolyIndexes[outsideIndex]);
+		payloadSize += sizeof(uint16_t);
+	}
+
+	return payloadSize;
+}
+
+bool HierarchicalBitBuckets::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	m_bounds.m_mins = parser.ParseVec2();
+	m_bounds.m_maxs = parser.ParseVec2();
+	int numFineMasks = (int)parser.ParseUint32();
+	if (!(m_bounds.m_maxs.x > m_bounds.m_mins.x) || !(m_bounds.m_maxs.y > m_bounds.m_mins.y) || numFineMasks < 0 || numFineMasks > numPolys * 64)
+	{
+		return false;
+	}
+
+	// Fine mask start indexes are not saved since they follow from the coarse masks
+	m_polyCoarseMasks.resize(numPolys);
+	m_polyFineMaskStartIndexes.resize(numPolys);
+	int numFineMasksForCoarseMasks = 0;
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		m_polyCoarseMasks[polyIndex] = parser.ParseUint64();
+		m_polyFineMaskStartIndexes[polyIndex] = numFineMasksForCoarseMasks;
+		numFineMasksForCoarseMasks += CountSetBits(m_polyCoarseMasks[polyIndex]);
+	}
+	if (numFineMasksForCoarseMasks != numFineMasks)
+	{
+		Clear();
+		return false;
+	}
+	m_fineMasks.resize(numFineMasks);
+	for (int fineMaskIndex = 0; fineMaskIndex < numFineMasks; fineMaskIndex++)
+	{
+		m_fineMasks[fineMaskIndex] = parser.ParseUint64();
+	}
+
+	int numOutsideBoundsPolys = parser.ParseUShort();
+	for (int outsideIndex = 0; outsideIndex < numOutsideBoundsPolys; outsideIndex++)
+	{
+		int polyIndex = parser.ParseUShort();
+		if (polyIndex >= numPolys)
+		{
+			Clear();
+			return false;
+		}
+		m_outsideBoundsPolyIndexes.push_back(polyIndex);
+	}
+
+	return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Game/HullRaycastFunction.hpp"
+
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/ConvexHull2.hpp"
+#include "Engine/Math/ConvexPoly2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct RaycastResult2D;
+struct Vertex_PCU;
+struct Rgba8;
+class BufferParser;
+class BufferWriter;
+
+
+struct HierarchicalBitMask
+{
+public:
+	// One bit per super-tile, then one 8x8 fine mask per super-tile with its coarse bit set
+	uint64_t m_coarseMask = 0ull;
+	// Super-tiles in the order they were first touched, so only these fine masks are ever read
+	int m_numSuperTiles = 0;
+	uint8_t m_superTileIndexes[64] = {};
+	uint64_t m_fineMasks[64];
+};
+
+class HierarchicalBitBuckets
+{
+public:
+	~HierarchicalBitBuckets() = default;
+	HierarchicalBitBuckets() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys, AABB2 const& bounds);
+	void Clear();
+	bool IsEmpty() const { return m_polyCoarseMasks.empty(); }
+
+	RaycastResult2D RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit = false) const;
+	void GetMaskForRaycast(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HierarchicalBitMask& out_rayMask) const;
+	bool DoesPolyOverlapRayMask(int polyIndex, HierarchicalBitMask const& rayMask) const;
+
+	void AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+private:
+	void AddSegmentToMask(Vec2 const& start, Vec2 const& end, HierarchicalBitMask& mask) const;
+
+public:
+	static constexpr int SUPER_TILES_PER_SIDE = 8;
+	static constexpr int FINE_TILES_PER_SUPER_TILE_SIDE = 8;
+	static constexpr int FINE_TILES_PER_SIDE = SUPER_TILES_PER_SIDE * FINE_TILES_PER_SUPER_TILE_SIDE;
+
+	AABB2 m_bounds;
+	std::vector<uint64_t> m_polyCoarseMasks;
+	// Fine masks for a poly start at m_polyFineMaskStartIndexes[polyIndex], one per set coarse bit in ascending super-tile order
+	std::vector<int> m_polyFineMaskStartIndexes;
+	std::vector<uint64_t> m_fineMasks;
+	// Polys reaching outside m_bounds are tested by every ray, since rays are clipped to m_bounds
+	std::vector<int> m_outsideBoundsPolyIndexes;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <functional>
+
+struct RaycastResult2D;
+struct Vec2;
+
+
+// Raycasts the hull of one scene poly. Acceleration structures call this for the polys that survive their culling, so the
+// scene decides which hull kernel runs; build it once per batch, since a capture of only a pointer stays off the heap.
+typedef std::function<RaycastResult2D(int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance)> HullRaycastFunction;
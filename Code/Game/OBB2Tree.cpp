@@ -0,0 +1,249 @@
+#include "Game/OBB2Tree.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/TreeUtils.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+
+#include <algorithm>
+
+
+void OBB2Tree::Build(std::vector<ConvexPoly2> const& convexPolys)
+{
+	Clear();
+
+	int numPolys = (int)convexPolys.size();
+	if (numPolys == 0)
+	{
+		return;
+	}
+
+	std::vector<std::vector<Vec2>> polyVertexes;
+	std::vector<Vec2> polyCenters;
+	polyVertexes.reserve(numPolys);
+	polyCenters.reserve(numPolys);
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		polyVertexes.push_back(convexPolys[polyIndex].GetVertexes());
+		Vec2 center = Vec2::ZERO;
+		for (int vertexIndex = 0; vertexIndex < (int)polyVertexes[polyIndex].size(); vertexIndex++)
+		{
+			center += polyVertexes[polyIndex][vertexIndex];
+		}
+		center /= (float)polyVertexes[polyIndex].size();
+		polyCenters.push_back(center);
+		m_polyIndexes.push_back(polyIndex);
+	}
+
+	m_nodes.reserve(2 * numPolys);
+	m_nodes.push_back(OBB2TreeNode());
+	BuildSubtree(0, 0, numPolys, polyVertexes, polyCenters);
+}
+
+void OBB2Tree::Clear()
+{
+	m_nodes.clear();
+	m_polyIndexes.clear();
+}
+
+void OBB2Tree::BuildSubtree(int nodeIndex, int firstPolyIndex, int numPolys, std::vector<std::vector<Vec2>> const& polyVertexes, std::vector<Vec2> const& polyCenters)
+{
+	std::vector<Vec2> nodePoints;
+	for (int polyIndexIdx = firstPolyIndex; polyIndexIdx < firstPolyIndex + numPolys; polyIndexIdx++)
+	{
+		std::vector<Vec2> const& vertexes = polyVertexes[m_polyIndexes[polyIndexIdx]];
+		nodePoints.insert(nodePoints.end(), vertexes.begin(), vertexes.end());
+	}
+	OBB2 nodeBounds = GetTightOBB2ForPoints(nodePoints);
+	m_nodes[nodeIndex].m_bounds = nodeBounds;
+
+	if (numPolys <= MAX_POLYS_PER_LEAF)
+	{
+		m_nodes[nodeIndex].m_firstPolyIndex = firstPolyIndex;
+		m_nodes[nodeIndex].m_numPolys = numPolys;
+		return;
+	}
+
+	// Split at the median poly center along the node box's long axis
+	Vec2 splitAxis = nodeBounds.m_halfDimensions.x >= nodeBounds.m_halfDimensions.y ? nodeBounds.m_iBasisNormal : nodeBounds.m_iBasisNormal.GetRotated90Degrees();
+	int numPolysOnLeft = numPolys / 2;
+	std::vector<int>::iterator rangeBegin = m_polyIndexes.begin() + firstPolyIndex;
+	std::nth_element(rangeBegin, rangeBegin + numPolysOnLeft, rangeBegin + numPolys, [&polyCenters, &splitAxis](int polyIndexA, int polyIndexB)
+	{
+		return DotProduct2D(polyCenters[polyIndexA], splitAxis) < DotProduct2D(polyCenters[polyIndexB], splitAxis);
+	});
+
+	int leftChildIndex = (int)m_nodes.size();
+	m_nodes.push_back(OBB2TreeNode());
+	m_nodes.push_back(OBB2TreeNode());
+	m_nodes[nodeIndex].m_childIndexes[0] = leftChildIndex;
+	m_nodes[nodeIndex].m_childIndexes[1] = leftChildIndex + 1;
+
+	BuildSubtree(leftChildIndex, firstPolyIndex, numPolysOnLeft, polyVertexes, polyCenters);
+	BuildSubtree(leftChildIndex + 1, firstPolyIndex + numPolysOnLeft, numPolys - numPolysOnLeft, polyVertexes, polyCenters);
+}
+
+RaycastResult2D OBB2Tree::RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit) const
+{
+	RaycastResult2D closestResult;
+	closestResult.m_rayStartPosition = startPos;
+	closestResult.m_rayForwardNormal = fwdNormal;
+	closestResult.m_impactDistance = FLT_MAX;
+
+	auto getEntryDistance = [this, &startPos, &fwdNormal, maxDistance](int nodeIndex, float& out_entryDistance)
+	{
+		return GetRayEntryDistanceVsOBB2(startPos, fwdNormal, maxDistance, m_nodes[nodeIndex].m_bounds, out_entryDistance);
+	};
+	auto visitNode = [this, &startPos, &fwdNormal, maxDistance, &raycastVsHull, stopAtFirstHit, &closestResult, &out_numHullTests](int nodeIndex, float& inout_cutoffDistance)
+	{
+		OBB2TreeNode const& node = m_nodes[nodeIndex];
+		if (!node.IsLeaf())
+		{
+			return true;
+		}
+
+		for (int polyIndexIdx = node.m_firstPolyIndex; polyIndexIdx < node.m_firstPolyIndex + node.m_numPolys; polyIndexIdx++)
+		{
+			out_numHullTests++;
+			RaycastResult2D raycastVsConvexHullResult = raycastVsHull(m_polyIndexes[polyIndexIdx], startPos, fwdNormal, maxDistance);
+			if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+			{
+				closestResult = raycastVsConvexHullResult;
+				if (stopAtFirstHit)
+				{
+					inout_cutoffDistance = -1.f;
+					return false;
+				}
+			}
+		}
+		inout_cutoffDistance = closestResult.m_impactDistance;
+		return false;
+	};
+	TraverseTreeNearestFirst<MAX_TREE_TRAVERSAL_DEPTH>(m_nodes, 0, getEntryDistance, visitNode);
+
+	return closestResult;
+}
+
+void OBB2Tree::AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		OBB2 const& bounds = m_nodes[nodeIndex].m_bounds;
+		Vec2 iExtent = bounds.m_iBasisNormal * bounds.m_halfDimensions.x;
+		Vec2 jExtent = bounds.m_iBasisNormal.GetRotated90Degrees() * bounds.m_halfDimensions.y;
+		Vec2 corners[4] = { bounds.m_center - iExtent - jExtent, bounds.m_center + iExtent - jExtent, bounds.m_center + iExtent + jExtent, bounds.m_center - iExtent + jExtent };
+		for (int cornerIndex = 0; cornerIndex < 4; cornerIndex++)
+		{
+			AddVertsForLineSegment2D(verts, corners[cornerIndex], corners[(cornerIndex + 1) % 4], lineThickness, color);
+		}
+	}
+}
+
+uint32_t OBB2Tree::AppendToWriter(BufferWriter& writer) const
+{
+	uint32_t payloadSize = 0;
+	writer.AppendUint32((uint32_t)m_nodes.size());
+	payloadSize += sizeof(uint32_t);
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		OBB2TreeNode const& node = m_nodes[nodeIndex];
+		writer.AppendVec2(node.m_bounds.m_center);
+		payloadSize += sizeof(Vec2);
+		writer.AppendVec2(node.m_bounds.m_iBasisNormal);
+		payloadSize += sizeof(Vec2);
+		writer.AppendVec2(node.m_bounds.m_halfDimensions);
+		payloadSize += sizeof(Vec2);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[0]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUint32((uint32_t)node.m_childIndexes[1]);
+		payloadSize += sizeof(uint32_t);
+		writer.AppendUShort((uint16_t)node.m_firstPolyIndex);
+		payloadSize += sizeof(uint16_t);
+		writer.AppendUShort((uint16_t)node.m_numPolys);
+		payloadSize += sizeof(uint16_t);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < (int)m_polyIndexes.size(); polyIndexIdx++)
+	{
+		writer.AppendUShort((uint16_t)m_polyIndexes[polyIndexIdx]);
+		payloadSize += sizeof(uint16_t);
+	}
+
+	return payloadSize;
+}
+
+bool OBB2Tree::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	uint32_t numNodes = parser.ParseUint32();
+	for (uint32_t nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		OBB2TreeNode node;
+		node.m_bounds.m_center = parser.ParseVec2();
+		node.m_bounds.m_iBasisNormal = parser.ParseVec2();
+		node.m_bounds.m_halfDimensions = parser.ParseVec2();
+		node.m_childIndexes[0] = (int)parser.ParseUint32();
+		node.m_childIndexes[1] = (int)parser.ParseUint32();
+		node.m_firstPolyIndex = parser.ParseUShort();
+		node.m_numPolys = parser.ParseUShort();
+		m_nodes.push_back(node);
+	}
+	for (int polyIndexIdx = 0; polyIndexIdx < numPolys; polyIndexIdx++)
+	{
+		m_polyIndexes.push_back(parser.ParseUShort());
+	}
+
+	if (!AreTreeIndexesValid(m_nodes, m_polyIndexes, numPolys, MAX_TREE_TRAVERSAL_DEPTH - 1))
+	{
+		Clear();
+		return false;
+	}
+
+	return true;
+}
+
+OBB2 GetTightOBB2ForPoints(std::vector<Vec2> const& points)
+{
+	// Principal axis of the point covariance is the long axis for elongated point sets
+	Vec2 mean = Vec2::ZERO;
+	for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+	{
+		mean += points[pointIndex];
+	}
+	mean /= (float)points.size();
+
+	float covarianceXX = 0.f;
+	float covarianceXY = 0.f;
+	float covarianceYY = 0.f;
+	for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+	{
+		Vec2 displacement = points[pointIndex] - mean;
+		covarianceXX += displacement.x * displacement.x;
+		covarianceXY += displacement.x * displacement.y;
+		covarianceYY += displacement.y * displacement.y;
+	}
+	float principalAxisDegrees = 0.5f * Atan2Degrees(2.f * covarianceXY, covarianceXX - covarianceYY);
+	Vec2 iBasis = Vec2::MakeFromPolarDegrees(principalAxisDegrees);
+	Vec2 jBasis = iBasis.GetRotated90Degrees();
+
+	// Extents along the principal axes, the box center may be offset from the mean
+	float minI = FLT_MAX;
+	float maxI = -FLT_MAX;
+	float minJ = FLT_MAX;
+	float maxJ = -FLT_MAX;
+	for (int pointIndex = 0; pointIndex < (int)points.size(); pointIndex++)
+	{
+		float projectionI = DotProduct2D(points[pointIndex] - mean, iBasis);
+		float projectionJ = DotProduct2D(points[pointIndex] - mean, jBasis);
+		minI = fminf(minI, projectionI);
+		maxI = fmaxf(maxI, projectionI);
+		minJ = fminf(minJ, projectionJ);
+		maxJ = fmaxf(maxJ, projectionJ);
+	}
+
+	Vec2 center = mean + iBasis * (0.5f * (minI + maxI)) + jBasis * (0.5f * (minJ + maxJ));
+	Vec2 halfDimensions(0.5f * (maxI - minI), 0.5f * (maxJ - minJ));
+	return OBB2(center, iBasis, halfDimensions);
+}
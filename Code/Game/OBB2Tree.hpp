@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Game/HullRaycastFunction.hpp"
+
+#include "Engine/Math/ConvexHull2.hpp"
+#include "Engine/Math/ConvexPoly2.hpp"
+#include "Engine/Math/OBB2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct RaycastResult2D;
+struct Vertex_PCU;
+struct Rgba8;
+class BufferParser;
+class BufferWriter;
+
+
+struct OBB2TreeNode
+{
+public:
+	bool IsLeaf() const { return m_numPolys > 0; }
+
+public:
+	OBB2 m_bounds;
+	int m_childIndexes[2] = { -1, -1 };
+	int m_firstPolyIndex = 0;
+	int m_numPolys = 0;
+};
+
+class OBB2Tree
+{
+public:
+	~OBB2Tree() = default;
+	OBB2Tree() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys);
+	void Clear();
+	bool IsEmpty() const { return m_nodes.empty(); }
+
+	RaycastResult2D RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit = false) const;
+
+	void AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+private:
+	void BuildSubtree(int nodeIndex, int firstPolyIndex, int numPolys, std::vector<std::vector<Vec2>> const& polyVertexes, std::vector<Vec2> const& polyCenters);
+
+public:
+	// One poly per leaf so every leaf box hugs a single (possibly long and thin) poly
+	static constexpr int MAX_POLYS_PER_LEAF = 1;
+
+	std::vector<OBB2TreeNode> m_nodes;
+	std::vector<int> m_polyIndexes;
+};
+
+OBB2 GetTightOBB2ForPoints(std::vector<Vec2> const& points);
@@ -0,0 +1,90 @@
+#include "Game/PackedConvexScene.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/RayPacket4.hpp"
+
+
+void PackedConvexScene::Build(std::vector<ConvexPoly2> const& convexPolys, std::vector<ConvexHull2> const& convexHulls)
+{
+	m_hulls.Build(convexHulls);
+	m_polys.Build(convexPolys);
+	m_boundingDiscCenterXs.assign(convexHulls.size(), 0.f);
+	m_boundingDiscCenterYs.assign(convexHulls.size(), 0.f);
+	m_boundingDiscRadii.assign(convexHulls.size(), -1.f);
+	m_isBoundingDiscVisible.assign(convexHulls.size(), 0);
+}
+
+bool PackedConvexScene::UpdatePolyAtIndex(int polyIndex, ConvexPoly2 const& convexPoly, ConvexHull2 const& convexHull)
+{
+	return m_hulls.UpdateHullAtIndex(polyIndex, convexHull) && m_polys.UpdatePolyAtIndex(polyIndex, convexPoly);
+}
+
+void PackedConvexScene::SetBoundingDiscAtIndex(int polyIndex, Vec2 const& center, float radius, bool isVisible)
+{
+	m_boundingDiscCenterXs[polyIndex] = center.x;
+	m_boundingDiscCenterYs[polyIndex] = center.y;
+	m_boundingDiscRadii[polyIndex] = radius;
+	m_isBoundingDiscVisible[polyIndex] = isVisible ? 1 : 0;
+}
+
+void PackedConvexScene::Clear()
+{
+	m_hulls.Clear();
+	m_polys.Clear();
+	m_boundingDiscCenterXs.clear();
+	m_boundingDiscCenterYs.clear();
+	m_boundingDiscRadii.clear();
+	m_isBoundingDiscVisible.clear();
+}
+
+size_t PackedConvexScene::GetNumHullAndDiscBytes() const
+{
+	size_t numHullBytes = (m_hulls.m_hullFirstPlaneIndexes.size() + m_hulls.m_hullNumPlanes.size()) * sizeof(int) + m_hulls.m_planeDistances.size() * 3 * sizeof(float);
+	size_t numDiscBytes = (m_boundingDiscCenterXs.size() + m_boundingDiscCenterYs.size() + m_boundingDiscRadii.size()) * sizeof(float);
+	return numHullBytes + numDiscBytes;
+}
+
+bool PackedConvexScene::DoesRayHitBoundingDisc(int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance) const
+{
+	if (!HasBoundingDisc(polyIndex))
+	{
+		return true;
+	}
+
+	float entryDistance = 0.f;
+	return GetRayEntryDistanceVsDisc2D(startPos, fwdNormal, maxDistance, GetBoundingDiscCenter(polyIndex), m_boundingDiscRadii[polyIndex], entryDistance);
+}
+
+int PackedConvexScene::GetRayPacket4LanesHittingBoundingDisc(int polyIndex, RayPacket4 const& packet) const
+{
+	if (!HasBoundingDisc(polyIndex))
+	{
+		return (1 << RayPacket4::NUM_LANES) - 1;
+	}
+
+	return GetRayPacket4LanesHittingDisc2D(packet, GetBoundingDiscCenter(polyIndex), m_boundingDiscRadii[polyIndex]);
+}
+
+void PackedConvexScene::AddVertsForPolyFill(std::vector<Vertex_PCU>& verts, int polyIndex, Rgba8 const& color) const
+{
+	// Triangle fan around the first vertex
+	int numVertexes = GetNumVertexes(polyIndex);
+	Vec2 const& fanCenter = GetVertex(polyIndex, 0);
+	for (int vertexIndex = 1; vertexIndex < numVertexes - 1; vertexIndex++)
+	{
+		Vec2 const& fanVertexA = GetVertex(polyIndex, vertexIndex);
+		Vec2 const& fanVertexB = GetVertex(polyIndex, vertexIndex + 1);
+		verts.push_back(Vertex_PCU(Vec3(fanCenter.x, fanCenter.y, 0.f), color, Vec2(0.f, 0.f)));
+		verts.push_back(Vertex_PCU(Vec3(fanVertexA.x, fanVertexA.y, 0.f), color, Vec2(0.f, 0.f)));
+		verts.push_back(Vertex_PCU(Vec3(fanVertexB.x, fanVertexB.y, 0.f), color, Vec2(0.f, 0.f)));
+	}
+}
+
+void PackedConvexScene::AddVertsForPolyOutline(std::vector<Vertex_PCU>& verts, int polyIndex, float thickness, Rgba8 const& color) const
+{
+	int numVertexes = GetNumVertexes(polyIndex);
+	for (int vertexIndex = 0; vertexIndex < numVertexes; vertexIndex++)
+	{
+		AddVertsForLineSegment2D(verts, GetVertex(polyIndex, vertexIndex), GetVertex(polyIndex, (vertexIndex + 1) % numVertexes), thickness, color);
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Game/ConvexHull2SoA.hpp"
+#include "Game/ConvexPoly2Chains.hpp"
+
+#include <vector>
+
+struct RayPacket4;
+struct Rgba8;
+struct Vertex_PCU;
+
+
+// The whole scene in a handful of flat buffers: planes in one buffer padded to SIMD-width groups, vertexes in another, each indexed by
+// per-poly offsets, and bounding discs as parallel arrays. Data every ray reads is kept apart from data only rendering reads,
+// so scanning hulls never drags visibility flags through the cache.
+class PackedConvexScene
+{
+public:
+	~PackedConvexScene() = default;
+	PackedConvexScene() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys, std::vector<ConvexHull2> const& convexHulls);
+	// Rewrites one poly in place; returns false when its vertex or plane count changed and a full Build is needed
+	bool UpdatePolyAtIndex(int polyIndex, ConvexPoly2 const& convexPoly, ConvexHull2 const& convexHull);
+	void SetBoundingDiscAtIndex(int polyIndex, Vec2 const& center, float radius, bool isVisible);
+	void Clear();
+	bool IsEmpty() const { return m_hulls.IsEmpty(); }
+	int GetNumPolys() const { return m_hulls.GetNumHulls(); }
+	int GetNumVertexes(int polyIndex) const { return m_polys.GetNumVertexes(polyIndex); }
+	Vec2 const& GetVertex(int polyIndex, int vertexIndex) const { return m_polys.m_vertexes[m_polys.m_polyFirstVertexIndexes[polyIndex] + vertexIndex]; }
+	int GetNumPlanes(int polyIndex) const { return m_hulls.m_hullNumPlanes[polyIndex]; }
+	bool HasBoundingDisc(int polyIndex) const { return m_boundingDiscRadii[polyIndex] >= 0.f; }
+	Vec2 GetBoundingDiscCenter(int polyIndex) const { return Vec2(m_boundingDiscCenterXs[polyIndex], m_boundingDiscCenterYs[polyIndex]); }
+	// Footprint of the hull planes and bounding discs, the data culling reads; vertex chains are left out
+	size_t GetNumHullAndDiscBytes() const;
+
+	// Polys without a bounding disc are never rejected
+	bool DoesRayHitBoundingDisc(int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance) const;
+	int GetRayPacket4LanesHittingBoundingDisc(int polyIndex, RayPacket4 const& packet) const;
+
+	void AddVertsForPolyFill(std::vector<Vertex_PCU>& verts, int polyIndex, Rgba8 const& color) const;
+	void AddVertsForPolyOutline(std::vector<Vertex_PCU>& verts, int polyIndex, float thickness, Rgba8 const& color) const;
+
+public:
+	// Hot: read by the raycast kernels and narrow phase
+	ConvexHull2SoA m_hulls;
+	ConvexPoly2Chains m_polys;
+	// A negative radius marks a poly with no bounding disc loaded
+	std::vector<float> m_boundingDiscCenterXs;
+	std::vector<float> m_boundingDiscCenterYs;
+	std::vector<float> m_boundingDiscRadii;
+
+	// Cold: only read when rendering
+	std::vector<unsigned char> m_isBoundingDiscVisible;
+};
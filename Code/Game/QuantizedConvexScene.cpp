@@ -0,0 +1,262 @@
+#include "Game/QuantizedConvexScene.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/PackedConvexScene.hpp"
+
+#include <emmintrin.h>
+
+
+void QuantizedConvexScene::Build(PackedConvexScene const& packedScene, AABB2 const& sceneBounds)
+{
+	Clear();
+
+	// Twice the scene's half extent leaves room for polys dragged past its edges before anything stops fitting
+	Vec2 sceneHalfDimensions = sceneBounds.GetDimensions() * 0.5f;
+	float maxSceneHalfDimension = sceneHalfDimensions.x > sceneHalfDimensions.y ? sceneHalfDimensions.x : sceneHalfDimensions.y;
+	m_origin = (sceneBounds.m_mins + sceneBounds.m_maxs) * 0.5f;
+	m_quantizationStep = maxSceneHalfDimension > 0.f ? 2.f * maxSceneHalfDimension / (float)INT16_MAX : 1.f;
+
+	int numPolys = packedScene.GetNumPolys();
+	m_hullFirstPlaneIndexes.reserve(numPolys + 1);
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		m_hullFirstPlaneIndexes.push_back((int)m_planes.size());
+		m_planes.resize(m_planes.size() + packedScene.GetNumPlanes(polyIndex));
+	}
+	m_hullFirstPlaneIndexes.push_back((int)m_planes.size());
+	m_planes.resize(m_planes.size() + SIMD_WIDTH - 1);
+	m_discs.resize(numPolys);
+
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		EncodePolyAtIndex(polyIndex, packedScene);
+	}
+}
+
+bool QuantizedConvexScene::UpdatePolyAtIndex(int polyIndex, PackedConvexScene const& packedScene)
+{
+	if (m_hullFirstPlaneIndexes[polyIndex + 1] - m_hullFirstPlaneIndexes[polyIndex] != packedScene.GetNumPlanes(polyIndex))
+	{
+		return false;
+	}
+
+	EncodePolyAtIndex(polyIndex, packedScene);
+	return true;
+}
+
+void QuantizedConvexScene::Clear()
+{
+	m_hullFirstPlaneIndexes.clear();
+	m_planes.clear();
+	m_discs.clear();
+}
+
+size_t QuantizedConvexScene::GetNumBytes() const
+{
+	return m_hullFirstPlaneIndexes.size() * sizeof(int) + m_planes.size() * sizeof(QuantizedPlane2) + m_discs.size() * sizeof(QuantizedDisc2);
+}
+
+void QuantizedConvexScene::EncodePolyAtIndex(int polyIndex, PackedConvexScene const& packedScene)
+{
+	// Each quantized plane is pushed out to the poly's farthest vertex along the quantized normal, then one step further
+	// so float rounding in the ray test cannot cut into the exact hull
+	int firstPlaneIndex = m_hullFirstPlaneIndexes[polyIndex];
+	int numPlanes = m_hullFirstPlaneIndexes[polyIndex + 1] - firstPlaneIndex;
+	int firstPackedPlaneIndex = packedScene.m_hulls.m_hullFirstPlaneIndexes[polyIndex];
+	int numVertexes = packedScene.GetNumVertexes(polyIndex);
+	bool doAllPlanesFit = numVertexes > 0;
+	for (int planeIndex = 0; planeIndex < numPlanes && doAllPlanesFit; planeIndex++)
+	{
+		Vec2 exactNormal(packedScene.m_hulls.m_planeNormalXs[firstPackedPlaneIndex + planeIndex], packedScene.m_hulls.m_planeNormalYs[firstPackedPlaneIndex + planeIndex]);
+		uint16_t normalCode = EncodeNormal(exactNormal);
+		Vec2 quantizedNormal = DecodeNormal(normalCode);
+
+		double maxVertexDistance = -DBL_MAX;
+		for (int vertexIndex = 0; vertexIndex < numVertexes; vertexIndex++)
+		{
+			Vec2 const& vertex = packedScene.GetVertex(polyIndex, vertexIndex);
+			double vertexDistance = (double)quantizedNormal.x * ((double)vertex.x - (double)m_origin.x) + (double)quantizedNormal.y * ((double)vertex.y - (double)m_origin.y);
+			maxVertexDistance = vertexDistance > maxVertexDistance ? vertexDistance : maxVertexDistance;
+		}
+
+		double quantizedDistance = ceil(maxVertexDistance / (double)m_quantizationStep) + 1.0;
+		if (quantizedDistance > (double)INT16_MAX || quantizedDistance < -(double)INT16_MAX)
+		{
+			doAllPlanesFit = false;
+			continue;
+		}
+
+		m_planes[firstPlaneIndex + planeIndex].m_normalCode = normalCode;
+		m_planes[firstPlaneIndex + planeIndex].m_distance = (int16_t)quantizedDistance;
+	}
+	if (!doAllPlanesFit && numPlanes > 0)
+	{
+		m_planes[firstPlaneIndex].m_distance = UNQUANTIZED_HULL_DISTANCE;
+	}
+
+	// Disc centers are rounded to the nearest step and the radius grows by the rounding error
+	QuantizedDisc2& quantizedDisc = m_discs[polyIndex];
+	quantizedDisc.m_radius = NO_DISC_RADIUS;
+	if (!packedScene.HasBoundingDisc(polyIndex))
+	{
+		return;
+	}
+
+	Vec2 exactCenter = packedScene.GetBoundingDiscCenter(polyIndex);
+	float quantizedCenterX = roundf((exactCenter.x - m_origin.x) / m_quantizationStep);
+	float quantizedCenterY = roundf((exactCenter.y - m_origin.y) / m_quantizationStep);
+	quantizedCenterX = quantizedCenterX > (float)INT16_MAX ? (float)INT16_MAX : (quantizedCenterX < -(float)INT16_MAX ? -(float)INT16_MAX : quantizedCenterX);
+	quantizedCenterY = quantizedCenterY > (float)INT16_MAX ? (float)INT16_MAX : (quantizedCenterY < -(float)INT16_MAX ? -(float)INT16_MAX : quantizedCenterY);
+	quantizedDisc.m_centerX = (int16_t)quantizedCenterX;
+	quantizedDisc.m_centerY = (int16_t)quantizedCenterY;
+
+	Vec2 decodedCenter = m_origin + Vec2((float)quantizedDisc.m_centerX, (float)quantizedDisc.m_centerY) * m_quantizationStep;
+	double quantizedRadius = ceil(((double)packedScene.m_boundingDiscRadii[polyIndex] + (double)(exactCenter - decodedCenter).GetLength()) / (double)m_quantizationStep) + 1.0;
+	if (quantizedRadius < (double)NO_DISC_RADIUS)
+	{
+		quantizedDisc.m_radius = (uint16_t)quantizedRadius;
+	}
+}
+
+bool QuantizedConvexScene::DoesRayHitConvexHull(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const
+{
+	int firstPlaneIndex = m_hullFirstPlaneIndexes[hullIndex];
+	int endPlaneIndex = m_hullFirstPlaneIndexes[hullIndex + 1];
+	if (firstPlaneIndex == endPlaneIndex || m_planes[firstPlaneIndex].m_distance == UNQUANTIZED_HULL_DISTANCE)
+	{
+		return true;
+	}
+
+	__m128 const zero = _mm_setzero_ps();
+	__m128 const one = _mm_set1_ps(1.f);
+	__m128 const two = _mm_set1_ps(2.f);
+	__m128 const absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	__m128 const lowest = _mm_set1_ps(-FLT_MAX);
+	__m128 const highest = _mm_set1_ps(FLT_MAX);
+	__m128 const codeToPerimeterPosition = _mm_set1_ps(1.f / 16384.f);
+	__m128 const quantizationStep = _mm_set1_ps(m_quantizationStep);
+	__m128i const lowHalfMask = _mm_set1_epi32(0xFFFF);
+	__m128i const laneIndexes = _mm_setr_epi32(0, 1, 2, 3);
+	__m128 const startX = _mm_set1_ps(startPos.x - m_origin.x);
+	__m128 const startY = _mm_set1_ps(startPos.y - m_origin.y);
+	__m128 const fwdX = _mm_set1_ps(fwdNormal.x);
+	__m128 const fwdY = _mm_set1_ps(fwdNormal.y);
+
+	__m128 lastEntryDistances = zero;
+	__m128 firstExitDistances = _mm_set1_ps(maxDistance);
+	__m128 isOutsideParallelPlane = zero;
+	for (int planeIndex = firstPlaneIndex; planeIndex < endPlaneIndex; planeIndex += SIMD_WIDTH)
+	{
+		// Four 4-byte planes per load: the normal code in each lane's low half, the distance in its high half
+		__m128i packedPlanes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&m_planes[planeIndex]));
+		__m128 isValidLane = _mm_castsi128_ps(_mm_cmplt_epi32(laneIndexes, _mm_set1_epi32(endPlaneIndex - planeIndex)));
+		__m128 perimeterPosition = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(packedPlanes, lowHalfMask)), codeToPerimeterPosition);
+		__m128 distance = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(packedPlanes, 16)), quantizationStep);
+
+		__m128 isUpperHalf = _mm_cmplt_ps(perimeterPosition, two);
+		__m128 halfSign = _mm_or_ps(_mm_and_ps(isUpperHalf, one), _mm_andnot_ps(isUpperHalf, _mm_set1_ps(-1.f)));
+		__m128 normalX = _mm_sub_ps(_mm_mul_ps(halfSign, _mm_sub_ps(one, perimeterPosition)), _mm_sub_ps(one, halfSign));
+		__m128 normalY = _mm_mul_ps(halfSign, _mm_sub_ps(one, _mm_and_ps(normalX, absMask)));
+
+		__m128 startAltitude = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(normalX, startX), _mm_mul_ps(normalY, startY)), distance);
+		__m128 fwdDotNormal = _mm_add_ps(_mm_mul_ps(normalX, fwdX), _mm_mul_ps(normalY, fwdY));
+		__m128 impactDistance = _mm_div_ps(_mm_sub_ps(zero, startAltitude), fwdDotNormal);
+
+		__m128 isEntry = _mm_and_ps(isValidLane, _mm_cmplt_ps(fwdDotNormal, zero));
+		__m128 isExit = _mm_and_ps(isValidLane, _mm_cmpgt_ps(fwdDotNormal, zero));
+		__m128 isParallel = _mm_andnot_ps(_mm_or_ps(isEntry, isExit), isValidLane);
+		isOutsideParallelPlane = _mm_or_ps(isOutsideParallelPlane, _mm_and_ps(isParallel, _mm_cmpgt_ps(startAltitude, zero)));
+		lastEntryDistances = _mm_max_ps(lastEntryDistances, _mm_or_ps(_mm_and_ps(isEntry, impactDistance), _mm_andnot_ps(isEntry, lowest)));
+		firstExitDistances = _mm_min_ps(firstExitDistances, _mm_or_ps(_mm_and_ps(isExit, impactDistance), _mm_andnot_ps(isExit, highest)));
+	}
+
+	if (_mm_movemask_ps(isOutsideParallelPlane) != 0)
+	{
+		return false;
+	}
+
+	__m128 lastEntryDistance = _mm_max_ps(lastEntryDistances, _mm_shuffle_ps(lastEntryDistances, lastEntryDistances, _MM_SHUFFLE(2, 3, 0, 1)));
+	lastEntryDistance = _mm_max_ps(lastEntryDistance, _mm_shuffle_ps(lastEntryDistance, lastEntryDistance, _MM_SHUFFLE(1, 0, 3, 2)));
+	__m128 firstExitDistance = _mm_min_ps(firstExitDistances, _mm_shuffle_ps(firstExitDistances, firstExitDistances, _MM_SHUFFLE(2, 3, 0, 1)));
+	firstExitDistance = _mm_min_ps(firstExitDistance, _mm_shuffle_ps(firstExitDistance, firstExitDistance, _MM_SHUFFLE(1, 0, 3, 2)));
+	return _mm_comile_ss(lastEntryDistance, firstExitDistance) != 0;
+}
+
+bool QuantizedConvexScene::DoesRayHitConvexHullScalar(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const
+{
+	int firstPlaneIndex = m_hullFirstPlaneIndexes[hullIndex];
+	int endPlaneIndex = m_hullFirstPlaneIndexes[hullIndex + 1];
+	if (firstPlaneIndex == endPlaneIndex || m_planes[firstPlaneIndex].m_distance == UNQUANTIZED_HULL_DISTANCE)
+	{
+		return true;
+	}
+
+	// Same interval clipping as the exact any-hit kernel, with the ray moved into the quantization frame
+	Vec2 localStartPos = startPos - m_origin;
+	float lastEntryDistance = 0.f;
+	float firstExitDistance = maxDistance;
+	for (int planeIndex = firstPlaneIndex; planeIndex < endPlaneIndex; planeIndex++)
+	{
+		Vec2 planeNormal = DecodeNormal(m_planes[planeIndex].m_normalCode);
+		float planeDistance = (float)m_planes[planeIndex].m_distance * m_quantizationStep;
+		float startAltitude = planeNormal.x * localStartPos.x + planeNormal.y * localStartPos.y - planeDistance;
+		float fwdDotNormal = planeNormal.x * fwdNormal.x + planeNormal.y * fwdNormal.y;
+		if (fwdDotNormal == 0.f)
+		{
+			if (startAltitude > 0.f)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float impactDistance = -startAltitude / fwdDotNormal;
+		if (fwdDotNormal < 0.f)
+		{
+			lastEntryDistance = fmaxf(lastEntryDistance, impactDistance);
+		}
+		else
+		{
+			firstExitDistance = fminf(firstExitDistance, impactDistance);
+		}
+
+		if (lastEntryDistance > firstExitDistance)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool QuantizedConvexScene::DoesRayHitBoundingDisc(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int polyIndex) const
+{
+	QuantizedDisc2 const& quantizedDisc = m_discs[polyIndex];
+	if (quantizedDisc.m_radius == NO_DISC_RADIUS)
+	{
+		return true;
+	}
+
+	Vec2 localDiscCenter = Vec2((float)quantizedDisc.m_centerX, (float)quantizedDisc.m_centerY) * m_quantizationStep;
+	float entryDistance = 0.f;
+	return GetRayEntryDistanceVsDisc2D(startPos - m_origin, fwdNormal, maxDistance, localDiscCenter, (float)quantizedDisc.m_radius * m_quantizationStep, entryDistance);
+}
+
+uint16_t QuantizedConvexScene::EncodeNormal(Vec2 const& normal)
+{
+	// Walk the unit diamond |x| + |y| = 1 counterclockwise from (1, 0), a quarter of the code range per edge
+	float l1Length = fabsf(normal.x) + fabsf(normal.y);
+	float diamondX = l1Length > 0.f ? normal.x / l1Length : 1.f;
+	float perimeterPosition = normal.y >= 0.f ? 1.f - diamondX : 3.f + diamondX;
+	return (uint16_t)((int)roundf(perimeterPosition * 16384.f) & 0xFFFF);
+}
+
+Vec2 QuantizedConvexScene::DecodeNormal(uint16_t normalCode)
+{
+	// Upper half of the diamond runs x = 1 - p, lower half x = p - 3; written with a sign instead of a branch since codes
+	// within one hull alternate between the halves unpredictably
+	float perimeterPosition = (float)normalCode * (1.f / 16384.f);
+	float halfSign = perimeterPosition < 2.f ? 1.f : -1.f;
+	float diamondX = halfSign * (1.f - perimeterPosition) - (1.f - halfSign);
+	return Vec2(diamondX, halfSign * (1.f - fabsf(diamondX)));
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Engine/Math/AABB2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class PackedConvexScene;
+
+
+// 16-bit stand-ins for the packed scene's hull planes and bounding discs, a third to half the bytes of the float data.
+// Normals use the 2D octahedral (diamond) encoding and distances are fixed point relative to the scene center, both
+// rounded outward, so each quantized hull and disc contains its exact counterpart: a miss here is a guaranteed miss,
+// while a hit still has to be confirmed against the exact float hull.
+class QuantizedConvexScene
+{
+public:
+	struct QuantizedPlane2
+	{
+		uint16_t m_normalCode = 0;
+		int16_t m_distance = 0;
+	};
+
+	struct QuantizedDisc2
+	{
+		int16_t m_centerX = 0;
+		int16_t m_centerY = 0;
+		uint16_t m_radius = NO_DISC_RADIUS;
+	};
+
+public:
+	~QuantizedConvexScene() = default;
+	QuantizedConvexScene() = default;
+
+	void Build(PackedConvexScene const& packedScene, AABB2 const& sceneBounds);
+	// Re-encodes one poly in place; returns false when its plane count changed and a full Build is needed
+	bool UpdatePolyAtIndex(int polyIndex, PackedConvexScene const& packedScene);
+	void Clear();
+	bool IsEmpty() const { return m_hullFirstPlaneIndexes.empty(); }
+	int GetNumHulls() const { return m_hullFirstPlaneIndexes.empty() ? 0 : (int)m_hullFirstPlaneIndexes.size() - 1; }
+	size_t GetNumBytes() const;
+
+	// Conservative any-hit tests; hulls with no planes and discs that did not fit the quantized range never reject
+	bool DoesRayHitConvexHull(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const;
+	bool DoesRayHitConvexHullScalar(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int hullIndex) const;
+	bool DoesRayHitBoundingDisc(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, int polyIndex) const;
+
+	static uint16_t EncodeNormal(Vec2 const& normal);
+	// Decoded normals have unit L1 rather than L2 length, which plane tests of the form normal . point <= distance do not mind
+	static Vec2 DecodeNormal(uint16_t normalCode);
+
+private:
+	void EncodePolyAtIndex(int polyIndex, PackedConvexScene const& packedScene);
+
+public:
+	static constexpr int SIMD_WIDTH = 4;
+	static constexpr uint16_t NO_DISC_RADIUS = 0xFFFF;
+	// Marks a hull whose planes fell outside the quantized range in its first plane's distance; such hulls always pass
+	static constexpr int16_t UNQUANTIZED_HULL_DISTANCE = INT16_MIN;
+
+	// Planes for hull i are [m_hullFirstPlaneIndexes[i], m_hullFirstPlaneIndexes[i + 1]), unpadded; SIMD_WIDTH - 1 spare planes
+	// at the end let the SIMD kernel load a full register past the last hull's planes and mask the extra lanes
+	std::vector<int> m_hullFirstPlaneIndexes;
+	std::vector<QuantizedPlane2> m_planes;
+	std::vector<QuantizedDisc2> m_discs;
+
+	// Distances, disc centers and radii are all multiples of m_quantizationStep from m_origin
+	Vec2 m_origin;
+	float m_quantizationStep = 1.f;
+};
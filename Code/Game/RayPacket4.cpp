@@ -0,0 +1,33 @@
+#include "Game/RayPacket4.hpp"
+
+#include <emmintrin.h>
+
+
+void RayPacket4::SetRay(int laneIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance)
+{
+	m_startXs[laneIndex] = startPos.x;
+	m_startYs[laneIndex] = startPos.y;
+	m_fwdXs[laneIndex] = fwdNormal.x;
+	m_fwdYs[laneIndex] = fwdNormal.y;
+	m_maxDistances[laneIndex] = maxDistance;
+}
+
+int GetRayPacket4LanesHittingDisc2D(RayPacket4 const& packet, Vec2 const& discCenter, float discRadius)
+{
+	__m128 const zero = _mm_setzero_ps();
+	__m128 radiusSquared = _mm_set1_ps(discRadius * discRadius);
+	__m128 startToCenterX = _mm_sub_ps(_mm_set1_ps(discCenter.x), _mm_load_ps(packet.m_startXs));
+	__m128 startToCenterY = _mm_sub_ps(_mm_set1_ps(discCenter.y), _mm_load_ps(packet.m_startYs));
+	__m128 distanceSquared = _mm_add_ps(_mm_mul_ps(startToCenterX, startToCenterX), _mm_mul_ps(startToCenterY, startToCenterY));
+	__m128 projectedDistance = _mm_add_ps(_mm_mul_ps(startToCenterX, _mm_load_ps(packet.m_fwdXs)), _mm_mul_ps(startToCenterY, _mm_load_ps(packet.m_fwdYs)));
+	__m128 perpendicularDistanceSquared = _mm_sub_ps(distanceSquared, _mm_mul_ps(projectedDistance, projectedDistance));
+
+	// Rays starting inside always hit; otherwise the ray must point at the disc and reach its near edge
+	__m128 isStartInside = _mm_cmple_ps(distanceSquared, radiusSquared);
+	__m128 halfChordLength = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(radiusSquared, perpendicularDistanceSquared), zero));
+	__m128 isEntryInRange = _mm_cmple_ps(_mm_sub_ps(projectedDistance, halfChordLength), _mm_load_ps(packet.m_maxDistances));
+	__m128 isTowardDisc = _mm_and_ps(_mm_cmpge_ps(projectedDistance, zero), _mm_cmple_ps(perpendicularDistanceSquared, radiusSquared));
+	__m128 isHit = _mm_or_ps(isStartInside, _mm_and_ps(isTowardDisc, isEntryInRange));
+
+	return _mm_movemask_ps(isHit);
+}
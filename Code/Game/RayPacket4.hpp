@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Engine/Math/Vec2.hpp"
+
+
+struct RayPacket4
+{
+public:
+	void SetRay(int laneIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance);
+
+public:
+	static constexpr int NUM_LANES = 4;
+
+	// One ray per lane, laid out so each field loads straight into an SSE register
+	alignas(16) float m_startXs[NUM_LANES] = {};
+	alignas(16) float m_startYs[NUM_LANES] = {};
+	alignas(16) float m_fwdXs[NUM_LANES] = {};
+	alignas(16) float m_fwdYs[NUM_LANES] = {};
+	alignas(16) float m_maxDistances[NUM_LANES] = {};
+};
+
+// Returns a bit per lane whose ray hits the disc within its max distance
+int GetRayPacket4LanesHittingDisc2D(RayPacket4 const& packet, Vec2 const& discCenter, float discRadius);
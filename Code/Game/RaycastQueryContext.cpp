@@ -0,0 +1,11 @@
+#include "Game/RaycastQueryContext.hpp"
+
+
+void RaycastQueryContext::Reserve(int numWordsPerBitBucketMask, int maxNumTilesPerRay, int maxNumHullCandidates)
+{
+	m_rayTileIndexes.reserve(maxNumTilesPerRay);
+	m_rayBitMask.reserve(numWordsPerBitBucketMask);
+	m_packetBitMask.reserve(numWordsPerBitBucketMask);
+	m_hullCandidates.reserve(maxNumHullCandidates);
+	m_candidatePolyMask.reserve((maxNumHullCandidates + 63) / 64);
+}
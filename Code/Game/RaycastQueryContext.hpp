@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+// A hull that survived the broad and narrow phases, keyed by where the ray enters its minimal bounding disc
+struct HullCandidate
+{
+	float m_entryDistance = 0.f;
+	int m_polyIndex = -1;
+};
+
+
+// Per-thread scratch space for scene raycast queries. Once reserved for the current bit bucket grid,
+// the broad phase and hull tests that write into it never touch the heap.
+class RaycastQueryContext
+{
+public:
+	~RaycastQueryContext() = default;
+	RaycastQueryContext() = default;
+
+	void Reserve(int numWordsPerBitBucketMask, int maxNumTilesPerRay, int maxNumHullCandidates);
+
+public:
+	std::vector<unsigned int> m_rayTileIndexes;
+	std::vector<unsigned long long> m_rayBitMask;
+	int m_firstRayMaskWordIndex = 0;
+	int m_lastRayMaskWordIndex = -1;
+	// Union of the lane masks when tracing ray packets
+	std::vector<unsigned long long> m_packetBitMask;
+	// Min-heap on entry distance for front-to-back closest hit queries
+	std::vector<HullCandidate> m_hullCandidates;
+	// One bit per poly, for structures that gather their candidates into a mask
+	std::vector<uint64_t> m_candidatePolyMask;
+};
@@ -0,0 +1,314 @@
+#include "Game/SymmetricQuadtree.hpp"
+
+#include "Game/GameCommon.hpp"
+#include "Game/TreeUtils.hpp"
+
+#include "Engine/Core/BufferParser.hpp"
+#include "Engine/Core/BufferWriter.hpp"
+#include "Engine/Math/RaycastUtils.hpp"
+
+#include <algorithm>
+
+
+void SymmetricQuadtree::Build(std::vector<ConvexPoly2> const& convexPolys, AABB2 const& sceneBounds)
+{
+	Clear();
+
+	AddNode(sceneBounds, -1);
+	for (int polyIndex = 0; polyIndex < (int)convexPolys.size(); polyIndex++)
+	{
+		InsertPoly(polyIndex, convexPolys[polyIndex]);
+	}
+}
+
+void SymmetricQuadtree::Clear()
+{
+	m_nodes.clear();
+	m_nodeIndexForPoly.clear();
+}
+
+int SymmetricQuadtree::AddNode(AABB2 const& cellBounds, int parentIndex)
+{
+	SymmetricQuadtreeNode node;
+	node.m_cellBounds = cellBounds;
+	Vec2 halfCellDimensions = cellBounds.GetDimensions() * 0.5f;
+	node.m_looseBounds = AABB2(cellBounds.m_mins - halfCellDimensions, cellBounds.m_maxs + halfCellDimensions);
+	node.m_parentIndex = parentIndex;
+	m_nodes.push_back(node);
+	return (int)m_nodes.size() - 1;
+}
+
+AABB2 SymmetricQuadtree::GetCellBoundsForQuadrant(AABB2 const& parentCellBounds, int quadrant) const
+{
+	Vec2 cellCenter = (parentCellBounds.m_mins + parentCellBounds.m_maxs) * 0.5f;
+	Vec2 mins(quadrant % 2 == 0 ? parentCellBounds.m_mins.x : cellCenter.x, quadrant / 2 == 0 ? parentCellBounds.m_mins.y : cellCenter.y);
+	Vec2 maxs(quadrant % 2 == 0 ? cellCenter.x : parentCellBounds.m_maxs.x, quadrant / 2 == 0 ? cellCenter.y : parentCellBounds.m_maxs.y);
+	return AABB2(mins, maxs);
+}
+
+void SymmetricQuadtree::InsertPoly(int polyIndex, ConvexPoly2 const& convexPoly)
+{
+	if (m_nodes.empty())
+	{
+		return;
+	}
+
+	std::vector<Vec2> const vertexes = convexPoly.GetVertexes();
+	AABB2 polyBounds(vertexes[0], vertexes[0]);
+	for (int vertexIndex = 1; vertexIndex < (int)vertexes.size(); vertexIndex++)
+	{
+		polyBounds.m_mins.x = fminf(polyBounds.m_mins.x, vertexes[vertexIndex].x);
+		polyBounds.m_mins.y = fminf(polyBounds.m_mins.y, vertexes[vertexIndex].y);
+		polyBounds.m_maxs.x = fmaxf(polyBounds.m_maxs.x, vertexes[vertexIndex].x);
+		polyBounds.m_maxs.y = fmaxf(polyBounds.m_maxs.y, vertexes[vertexIndex].y);
+	}
+	Vec2 polyCenter = (polyBounds.m_mins + polyBounds.m_maxs) * 0.5f;
+	Vec2 polyDimensions = polyBounds.GetDimensions();
+
+	// A poly whose center is in a cell and which is no larger than the cell always fits that cell's loose bounds,
+	// so descend by center until the next cell would be too small; anything outside the scene stays at the root
+	int nodeIndex = 0;
+	AABB2 const& rootCellBounds = m_nodes[0].m_cellBounds;
+	bool isInsideScene = polyCenter.x >= rootCellBounds.m_mins.x && polyCenter.x <= rootCellBounds.m_maxs.x && polyCenter.y >= rootCellBounds.m_mins.y && polyCenter.y <= rootCellBounds.m_maxs.y;
+	for (int depth = 0; isInsideScene && depth < MAX_DEPTH - 1; depth++)
+	{
+		AABB2 const cellBounds = m_nodes[nodeIndex].m_cellBounds;
+		Vec2 childCellDimensions = cellBounds.GetDimensions() * 0.5f;
+		if (polyDimensions.x > childCellDimensions.x || polyDimensions.y > childCellDimensions.y)
+		{
+			break;
+		}
+
+		Vec2 cellCenter = (cellBounds.m_mins + cellBounds.m_maxs) * 0.5f;
+		int quadrant = (polyCenter.x < cellCenter.x ? 0 : 1) + (polyCenter.y < cellCenter.y ? 0 : 2);
+		if (m_nodes[nodeIndex].m_childIndexes[quadrant] == -1)
+		{
+			int childIndex = AddNode(GetCellBoundsForQuadrant(cellBounds, quadrant), nodeIndex);
+			m_nodes[nodeIndex].m_childIndexes[quadrant] = childIndex;
+		}
+		nodeIndex = m_nodes[nodeIndex].m_childIndexes[quadrant];
+	}
+
+	m_nodes[nodeIndex].m_polyIndexes.push_back(polyIndex);
+	if ((int)m_nodeIndexForPoly.size() <= polyIndex)
+	{
+		m_nodeIndexForPoly.resize(polyIndex + 1, -1);
+	}
+	m_nodeIndexForPoly[polyIndex] = nodeIndex;
+	for (int ancestorIndex = nodeIndex; ancestorIndex != -1; ancestorIndex = m_nodes[ancestorIndex].m_parentIndex)
+	{
+		m_nodes[ancestorIndex].m_numPolysInSubtree++;
+	}
+}
+
+void SymmetricQuadtree::RemovePoly(int polyIndex)
+{
+	if (polyIndex < 0 || polyIndex >= (int)m_nodeIndexForPoly.size() || m_nodeIndexForPoly[polyIndex] == -1)
+	{
+		return;
+	}
+
+	// Emptied nodes are kept, subtree counts let traversal skip them
+	int nodeIndex = m_nodeIndexForPoly[polyIndex];
+	std::vector<int>& nodePolyIndexes = m_nodes[nodeIndex].m_polyIndexes;
+	nodePolyIndexes.erase(std::find(nodePolyIndexes.begin(), nodePolyIndexes.end(), polyIndex));
+	m_nodeIndexForPoly[polyIndex] = -1;
+	for (int ancestorIndex = nodeIndex; ancestorIndex != -1; ancestorIndex = m_nodes[ancestorIndex].m_parentIndex)
+	{
+		m_nodes[ancestorIndex].m_numPolysInSubtree--;
+	}
+}
+
+RaycastResult2D SymmetricQuadtree::RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit) const
+{
+	RaycastResult2D closestResult;
+	closestResult.m_rayStartPosition = startPos;
+	closestResult.m_rayForwardNormal = fwdNormal;
+	closestResult.m_impactDistance = FLT_MAX;
+
+	if (m_nodes.empty())
+	{
+		return closestResult;
+	}
+
+	// The root is never culled since it also holds polys that were dragged outside the scene bounds
+	auto getEntryDistance = [this, &startPos, &fwdNormal, maxDistance](int nodeIndex, float& out_entryDistance)
+	{
+		out_entryDistance = 0.f;
+		if (nodeIndex == 0)
+		{
+			return true;
+		}
+		SymmetricQuadtreeNode const& node = m_nodes[nodeIndex];
+		return node.m_numPolysInSubtree > 0 && GetRayEntryDistanceVsAABB2(startPos, fwdNormal, maxDistance, node.m_looseBounds, out_entryDistance);
+	};
+	auto visitNode = [this, &startPos, &fwdNormal, maxDistance, &raycastVsHull, stopAtFirstHit, &closestResult, &out_numHullTests](int nodeIndex, float& inout_cutoffDistance)
+	{
+		SymmetricQuadtreeNode const& node = m_nodes[nodeIndex];
+		for (int polyIndexIdx = 0; polyIndexIdx < (int)node.m_polyIndexes.size(); polyIndexIdx++)
+		{
+			out_numHullTests++;
+			RaycastResult2D raycastVsConvexHullResult = raycastVsHull(node.m_polyIndexes[polyIndexIdx], startPos, fwdNormal, maxDistance);
+			if (raycastVsConvexHullResult.m_didImpact && (stopAtFirstHit || raycastVsConvexHullResult.m_impactDistance < closestResult.m_impactDistance))
+			{
+				closestResult = raycastVsConvexHullResult;
+				if (stopAtFirstHit)
+				{
+					inout_cutoffDistance = -1.f;
+					return false;
+				}
+			}
+		}
+		inout_cutoffDistance = closestResult.m_impactDistance;
+		return true;
+	};
+	TraverseTreeNearestFirst<MAX_TRAVERSAL_STACK_SIZE>(m_nodes, 0, getEntryDistance, visitNode);
+
+	return closestResult;
+}
+
+void SymmetricQuadtree::AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const
+{
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		if (m_nodes[nodeIndex].m_numPolysInSubtree == 0)
+		{
+			continue;
+		}
+
+		AABB2 const& bounds = m_nodes[nodeIndex].m_cellBounds;
+		AddVertsForLineSegment2D(verts, bounds.m_mins, Vec2(bounds.m_maxs.x, bounds.m_mins.y), lineThickness, color);
+		AddVertsForLineSegment2D(verts, Vec2(bounds.m_maxs.x, bounds.m_mins.y), bounds.m_maxs, lineThickness, color);
+		AddVertsForLineSegment2D(verts, bounds.m_maxs, Vec2(bounds.m_mins.x, bounds.m_maxs.y), lineThickness, color);
+		AddVertsForLineSegment2D(verts, Vec2(bounds.m_mins.x, bounds.m_maxs.y), bounds.m_mins, lineThickness, color);
+	}
+}
+
+uint32_t SymmetricQuadtree::AppendToWriter(BufferWriter& writer) const
+{
+	// Cell bounds follow from the root cell and the quadrant of each child, so only the root cell is written
+	uint32_t payloadSize = 0;
+	AABB2 rootCellBounds = m_nodes.empty() ? AABB2() : m_nodes[0].m_cellBounds;
+	writer.AppendVec2(rootCellBounds.m_mins);
+	payloadSize += sizeof(Vec2);
+	writer.AppendVec2(rootCellBounds.m_maxs);
+	payloadSize += sizeof(Vec2);
+	writer.AppendUint32((uint32_t)m_nodes.size());
+	payloadSize += sizeof(uint32_t);
+	for (int nodeIndex = 0; nodeIndex < (int)m_nodes.size(); nodeIndex++)
+	{
+		SymmetricQuadtreeNode const& node = m_nodes[nodeIndex];
+		for (int quadrant = 0; quadrant < 4; quadrant++)
+		{
+			writer.AppendUint32((uint32_t)node.m_childIndexes[quadrant]);
+			payloadSize += sizeof(uint32_t);
+		}
+		writer.AppendUShort((uint16_t)node.m_polyIndexes.size());
+		payloadSize += sizeof(uint16_t);
+		for (int polyIndexIdx = 0; polyIndexIdx < (int)node.m_polyIndexes.size(); polyIndexIdx++)
+		{
+			writer.AppendUShort((uint16_t)node.m_polyIndexes[polyIndexIdx]);
+			payloadSize += sizeof(uint16_t);
+		}
+	}
+
+	return payloadSize;
+}
+
+bool SymmetricQuadtree::ParseFromParser(BufferParser& parser, int numPolys)
+{
+	Clear();
+
+	AABB2 rootCellBounds;
+	rootCellBounds.m_mins = parser.ParseVec2();
+	rootCellBounds.m_maxs = parser.ParseVec2();
+	uint32_t numNodes = parser.ParseUint32();
+	std::vector<SymmetricQuadtreeNode> parsedNodes(numNodes);
+	for (uint32_t nodeIndex = 0; nodeIndex < numNodes; nodeIndex++)
+	{
+		for (int quadrant = 0; quadrant < 4; quadrant++)
+		{
+			parsedNodes[nodeIndex].m_childIndexes[quadrant] = (int)parser.ParseUint32();
+		}
+		int numNodePolys = parser.ParseUShort();
+		for (int polyIndexIdx = 0; polyIndexIdx < numNodePolys; polyIndexIdx++)
+		{
+			parsedNodes[nodeIndex].m_polyIndexes.push_back(parser.ParseUShort());
+		}
+	}
+	if (numNodes == 0)
+	{
+		return numPolys == 0;
+	}
+
+	// Rebuild cells, parents and subtree counts top-down, rejecting child links that are not a tree and poly lists that do not hold every poly exactly once
+	m_nodes = parsedNodes;
+	m_nodeIndexForPoly.assign(numPolys, -1);
+	std::vector<int> nodeDepths(numNodes, 0);
+	std::vector<bool> isNodeLinked(numNodes, false);
+	m_nodes[0].m_parentIndex = -1;
+	m_nodes[0].m_cellBounds = rootCellBounds;
+	isNodeLinked[0] = true;
+	for (int nodeIndex = 0; nodeIndex < (int)numNodes; nodeIndex++)
+	{
+		SymmetricQuadtreeNode& node = m_nodes[nodeIndex];
+		if (!isNodeLinked[nodeIndex] || nodeDepths[nodeIndex] >= MAX_DEPTH)
+		{
+			Clear();
+			return false;
+		}
+
+		Vec2 halfCellDimensions = node.m_cellBounds.GetDimensions() * 0.5f;
+		node.m_looseBounds = AABB2(node.m_cellBounds.m_mins - halfCellDimensions, node.m_cellBounds.m_maxs + halfCellDimensions);
+
+		for (int quadrant = 0; quadrant < 4; quadrant++)
+		{
+			int childIndex = node.m_childIndexes[quadrant];
+			if (childIndex == -1)
+			{
+				continue;
+			}
+			if (childIndex <= nodeIndex || childIndex >= (int)numNodes || isNodeLinked[childIndex])
+			{
+				Clear();
+				return false;
+			}
+			isNodeLinked[childIndex] = true;
+			nodeDepths[childIndex] = nodeDepths[nodeIndex] + 1;
+			m_nodes[childIndex].m_parentIndex = nodeIndex;
+			m_nodes[childIndex].m_cellBounds = GetCellBoundsForQuadrant(node.m_cellBounds, quadrant);
+		}
+
+		for (int polyIndexIdx = 0; polyIndexIdx < (int)node.m_polyIndexes.size(); polyIndexIdx++)
+		{
+			int polyIndex = node.m_polyIndexes[polyIndexIdx];
+			if (polyIndex >= numPolys || m_nodeIndexForPoly[polyIndex] != -1)
+			{
+				Clear();
+				return false;
+			}
+			m_nodeIndexForPoly[polyIndex] = nodeIndex;
+		}
+	}
+	for (int polyIndex = 0; polyIndex < numPolys; polyIndex++)
+	{
+		if (m_nodeIndexForPoly[polyIndex] == -1)
+		{
+			Clear();
+			return false;
+		}
+	}
+
+	// Children always come after their parent, so a reverse pass accumulates subtree counts
+	for (int nodeIndex = (int)numNodes - 1; nodeIndex >= 0; nodeIndex--)
+	{
+		SymmetricQuadtreeNode& node = m_nodes[nodeIndex];
+		node.m_numPolysInSubtree += (int)node.m_polyIndexes.size();
+		if (node.m_parentIndex != -1)
+		{
+			m_nodes[node.m_parentIndex].m_numPolysInSubtree += node.m_numPolysInSubtree;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Game/HullRaycastFunction.hpp"
+
+#include "Engine/Math/AABB2.hpp"
+#include "Engine/Math/ConvexHull2.hpp"
+#include "Engine/Math/ConvexPoly2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct RaycastResult2D;
+struct Vertex_PCU;
+struct Rgba8;
+class BufferParser;
+class BufferWriter;
+
+
+struct SymmetricQuadtreeNode
+{
+public:
+	// Regular subdivision cell, and the same cell grown by half its size on every side
+	AABB2 m_cellBounds;
+	AABB2 m_looseBounds;
+	int m_parentIndex = -1;
+	// Quadrants in order: left-bottom, right-bottom, left-top, right-top; quadrants not created yet are -1
+	int m_childIndexes[4] = { -1, -1, -1, -1 };
+	int m_numPolysInSubtree = 0;
+	std::vector<int> m_polyIndexes;
+};
+
+class SymmetricQuadtree
+{
+public:
+	~SymmetricQuadtree() = default;
+	SymmetricQuadtree() = default;
+
+	void Build(std::vector<ConvexPoly2> const& convexPolys, AABB2 const& sceneBounds);
+	void Clear();
+	bool IsEmpty() const { return m_nodes.empty(); }
+
+	void InsertPoly(int polyIndex, ConvexPoly2 const& convexPoly);
+	void RemovePoly(int polyIndex);
+
+	RaycastResult2D RaycastVsConvexHulls(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, int& out_numHullTests, bool stopAtFirstHit = false) const;
+
+	void AddVertsForDebugDraw(std::vector<Vertex_PCU>& verts, float lineThickness, Rgba8 const& color) const;
+
+	uint32_t AppendToWriter(BufferWriter& writer) const;
+	bool ParseFromParser(BufferParser& parser, int numPolys);
+
+private:
+	int AddNode(AABB2 const& cellBounds, int parentIndex);
+	AABB2 GetCellBoundsForQuadrant(AABB2 const& parentCellBounds, int quadrant) const;
+
+public:
+	static constexpr int MAX_DEPTH = 8;
+	static constexpr int MAX_TRAVERSAL_STACK_SIZE = 3 * MAX_DEPTH + 2;
+
+	std::vector<SymmetricQuadtreeNode> m_nodes;
+	// Node each poly is stored in, so a moved poly can be re-bucketed on its own
+	std::vector<int> m_nodeIndexForPoly;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cfloat>
+#include <type_traits>
+#include <vector>
+
+
+// Deepest node any tree may have, so traversals can use fixed-size stacks; parsed trees are held to this too
+constexpr int MAX_TREE_TRAVERSAL_DEPTH = 64;
+
+enum class TreeNodeOrder
+{
+	PARENTS_FIRST,
+	CHILDREN_FIRST
+};
+
+
+// Checks a parsed tree before anything traverses it. NodeType needs IsLeaf(), an m_childIndexes array and a
+// [m_firstPolyIndex, m_firstPolyIndex + m_numPolys) range into polyIndexes for leaves. Interior nodes must have at least
+// one child, each stored on the far side of its parent from the root, and no node may sit maxNumLevels or more below the root.
+// Empty (-1) child slots are only accepted for trees whose traversal skips them.
+template <typename NodeType>
+bool AreTreeIndexesValid(std::vector<NodeType> const& nodes, std::vector<int> const& polyIndexes, int numPolys, int maxNumLevels, TreeNodeOrder nodeOrder = TreeNodeOrder::PARENTS_FIRST, bool canChildSlotsBeEmpty = false)
+{
+	constexpr int NUM_CHILD_SLOTS = (int)std::extent<decltype(NodeType::m_childIndexes)>::value;
+	int numNodes = (int)nodes.size();
+	std::vector<int> nodeDepths(numNodes, 0);
+	for (int nodeIdx = 0; nodeIdx < numNodes; nodeIdx++)
+	{
+		// Visit parents before children either way, so each node's depth is known by the time it is checked
+		int nodeIndex = nodeOrder == TreeNodeOrder::PARENTS_FIRST ? nodeIdx : numNodes - 1 - nodeIdx;
+		NodeType const& node = nodes[nodeIndex];
+		if (nodeDepths[nodeIndex] >= maxNumLevels)
+		{
+			return false;
+		}
+		if (node.IsLeaf())
+		{
+			int firstPolyIndex = node.m_firstPolyIndex;
+			int endPolyIndex = node.m_firstPolyIndex + node.m_numPolys;
+			if (firstPolyIndex < 0 || endPolyIndex > (int)polyIndexes.size())
+			{
+				return false;
+			}
+			continue;
+		}
+
+		int numChildren = 0;
+		for (int childSlot = 0; childSlot < NUM_CHILD_SLOTS; childSlot++)
+		{
+			int childIndex = node.m_childIndexes[childSlot];
+			if (childIndex == -1 && canChildSlotsBeEmpty)
+			{
+				continue;
+			}
+			bool isChildPastNode = nodeOrder == TreeNodeOrder::PARENTS_FIRST ? childIndex > nodeIndex : childIndex < nodeIndex;
+			if (!isChildPastNode || childIndex < 0 || childIndex >= numNodes)
+			{
+				return false;
+			}
+			nodeDepths[childIndex] = nodeDepths[nodeIndex] + 1;
+			numChildren++;
+		}
+		if (numChildren == 0)
+		{
+			return false;
+		}
+	}
+
+	for (int polyIndexIdx = 0; polyIndexIdx < (int)polyIndexes.size(); polyIndexIdx++)
+	{
+		if (polyIndexes[polyIndexIdx] < 0 || polyIndexes[polyIndexIdx] >= numPolys)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// Nearest-first depth-first traversal shared by the trees. Trees supply only their volume test and what to do at a node:
+//   bool getEntryDistance(int nodeIndex, float& out_entryDistance) returns whether the ray reaches the node's volume at all
+//   bool visitNode(int nodeIndex, float& inout_cutoffDistance) tests the node's polys, may lower the cutoff to the closest
+//       impact so far (or make it negative to end the traversal), and returns whether to descend into the node's children
+// Children are visited in order of entry distance, and any node entered past the cutoff is skipped. Child slots of -1 are
+// skipped; STACK_SIZE must cover (children per node - 1) siblings waiting at every level plus the node being visited.
+template <int STACK_SIZE, typename NodeType, typename EntryDistanceFunction, typename VisitNodeFunction>
+void TraverseTreeNearestFirst(std::vector<NodeType> const& nodes, int rootIndex, EntryDistanceFunction const& getEntryDistance, VisitNodeFunction const& visitNode)
+{
+	constexpr int NUM_CHILD_SLOTS = (int)std::extent<decltype(NodeType::m_childIndexes)>::value;
+
+	float rootEntryDistance = 0.f;
+	if (nodes.empty() || !getEntryDistance(rootIndex, rootEntryDistance))
+	{
+		return;
+	}
+
+	// Stack of nodes still to visit, siblings are pushed farthest first so the nearest is popped first
+	int nodeStack[STACK_SIZE];
+	float nodeEntryDistanceStack[STACK_SIZE];
+	int stackSize = 0;
+	nodeStack[stackSize] = rootIndex;
+	nodeEntryDistanceStack[stackSize] = rootEntryDistance;
+	stackSize++;
+
+	float cutoffDistance = FLT_MAX;
+	while (stackSize > 0)
+	{
+		stackSize--;
+		if (nodeEntryDistanceStack[stackSize] > cutoffDistance)
+		{
+			continue;
+		}
+
+		int nodeIndex = nodeStack[stackSize];
+		bool shouldVisitChildren = visitNode(nodeIndex, cutoffDistance);
+		if (cutoffDistance < 0.f)
+		{
+			return;
+		}
+		if (!shouldVisitChildren)
+		{
+			continue;
+		}
+
+		// Insertion sort the hit children by descending entry distance; ties keep the lower slot nearer
+		int hitChildIndexes[NUM_CHILD_SLOTS] = {};
+		float hitChildEntryDistances[NUM_CHILD_SLOTS] = {};
+		int numHitChildren = 0;
+		NodeType const& node = nodes[nodeIndex];
+		for (int childSlot = 0; childSlot < NUM_CHILD_SLOTS; childSlot++)
+		{
+			int childIndex = node.m_childIndexes[childSlot];
+			float childEntryDistance = 0.f;
+			if (childIndex == -1 || !getEntryDistance(childIndex, childEntryDistance) || childEntryDistance > cutoffDistance)
+			{
+				continue;
+			}
+
+			int insertIdx = numHitChildren;
+			while (insertIdx > 0 && hitChildEntryDistances[insertIdx - 1] <= childEntryDistance)
+			{
+				hitChildIndexes[insertIdx] = hitChildIndexes[insertIdx - 1];
+				hitChildEntryDistances[insertIdx] = hitChildEntryDistances[insertIdx - 1];
+				insertIdx--;
+			}
+			hitChildIndexes[insertIdx] = childIndex;
+			hitChildEntryDistances[insertIdx] = childEntryDistance;
+			numHitChildren++;
+		}
+
+		for (int hitChildIdx = 0; hitChildIdx < numHitChildren; hitChildIdx++)
+		{
+			nodeStack[stackSize] = hitChildIndexes[hitChildIdx];
+			nodeEntryDistanceStack[stackSize] = hitChildEntryDistances[hitChildIdx];
+			stackSize++;
+		}
+	}
+}
@@ -11,11 +11,16 @@
 #include "Engine/Math/RaycastUtils.hpp"
 #include "Engine/Renderer/DebugRenderSystem.hpp"
 
+#include <algorithm>
+
 
 VisualTestConvexScene::~VisualTestConvexScene()
 {
 	UnsubscribeEventCallbackFunction("SaveConvexScene", Command_SaveScene);
 	UnsubscribeEventCallbackFunction("LoadConvexScene", Command_LoadScene);
+	UnsubscribeEventCallbackFunction("SetColumnRowBitRegionsResolution", Command_SetColumnRowBitRegionsResolution);
+	UnsubscribeEventCallbackFunction("SetBitBucketGridResolution", Command_SetBitBucketGridResolution);
+	UnsubscribeEventCallbackFunction("BenchmarkConvexHullRaycasts", Command_BenchmarkConvexHullRaycasts);
 }
 
 VisualTestConvexScene::VisualTestConvexScene()
@@ -29,6 +34,9 @@ VisualTestConvexScene::VisualTestConvexScene()
 
 	SubscribeEventCallbackFunction("SaveConvexScene", Command_SaveScene, "Save current scene to GHCS file (help for arguments)");
 	SubscribeEventCallbackFunction("LoadConvexScene", Command_LoadScene, "Load scene from GHCS file (help for arguments)");
+	SubscribeEventCallbackFunction("SetColumnRowBitRegionsResolution", Command_SetColumnRowBitRegionsResolution, "Set number of columns used by column/row bit regions (help for arguments)");
+	SubscribeEventCallbackFunction("SetBitBucketGridResolution", Command_SetBitBucketGridResolution, "Set tile grid size used by the bit bucket broad phase (help for arguments)");
+	SubscribeEventCallbackFunction("BenchmarkConvexHullRaycasts", Command_BenchmarkConvexHullRaycasts, "Compare scalar and SIMD ray vs convex hull throughput (help for arguments)");
 
 	Randomize();
 }
@@ -39,21 +47,100 @@ void VisualTestConvexScene::Update(float deltaSeconds)
 
 	HandleInput();
 
+	// Render reads the packed scene, so it has to be current before the frame is drawn
+	if (m_packedScene.IsEmpty() || m_needToRegeneratePackedScene)
+	{
+		GeneratePackedScene();
+	}
+
 	if (m_raycastsPerformedInLastTest != 0)
 	{
-		DebugAddMessage(Stringf("Time taken for %d raycasts: %.2f ms, Average impact distance: %.2f units", m_raycastsPerformedInLastTest, m_totalRaycastTimeMs, m_averageRaycastImpactDistance), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		// Build cost sits next to query cost so a rebuild can be weighed against the raycasts it speeds up
+		std::string treeBuildTimeStr = (m_currentOptimizationMode == OptimizationMode::BVH_AABB2_TREE && m_aabb2TreeBuildTimeMs >= 0.0) ? Stringf(" (+ %.2f ms AABB2 tree build)", m_aabb2TreeBuildTimeMs) : "";
+		if (m_lastTestUsedOcclusionQueries)
+		{
+			DebugAddMessage(Stringf("Time taken for %d occlusion raycasts: %.2f ms%s, Occluded rays: %d", m_raycastsPerformedInLastTest, m_totalRaycastTimeMs, treeBuildTimeStr.c_str(), m_numHitRaysInLastTest), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+		else
+		{
+			DebugAddMessage(Stringf("Time taken for %d raycasts: %.2f ms%s, Average impact distance: %.2f units", m_raycastsPerformedInLastTest, m_totalRaycastTimeMs, treeBuildTimeStr.c_str(), m_averageRaycastImpactDistance), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+		DebugAddMessage(Stringf("Raycasts per ms: closest hit %s, any hit %s", m_closestHitRaycastsPerMs >= 0.0 ? Stringf("%.1f", m_closestHitRaycastsPerMs).c_str() : "-", m_occlusionRaycastsPerMs >= 0.0 ? Stringf("%.1f", m_occlusionRaycastsPerMs).c_str() : "-"), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		if (m_numNarrowAndBroadPhaseHullTestsInLastTest >= 0)
+		{
+			char const* estimateStr = m_raycastsPerformedInLastTest > NUM_MAX_REJECTION_RATE_SAMPLE_RAYS ? "about " : "";
+			DebugAddMessage(Stringf("Ray vs hull tests: %lld, %.2f per ray (%s%lld avoided compared to Narrow and Broad Phase)", m_numHullTestsInLastTest, (double)m_numHullTestsInLastTest / (double)m_raycastsPerformedInLastTest, estimateStr, m_numNarrowAndBroadPhaseHullTestsInLastTest - m_numHullTestsInLastTest), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+		else
+		{
+			DebugAddMessage(Stringf("Ray vs hull tests: %lld, %.2f per ray", m_numHullTestsInLastTest, (double)m_numHullTestsInLastTest / (double)m_raycastsPerformedInLastTest), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+#if defined(TRACK_HEAP_ALLOCATIONS)
+		DebugAddMessage(Stringf("Heap allocations during timed raycasts: %lld", m_numHeapAllocationsInLastTest), 0.f, m_numHeapAllocationsInLastTest == 0 ? Rgba8::WHITE : Rgba8::RED, m_numHeapAllocationsInLastTest == 0 ? Rgba8::WHITE : Rgba8::RED);
+#endif
+		if (m_numPolysUsingLogarithmicRaycast > 0)
+		{
+			DebugAddMessage(Stringf("%d polys with %d+ vertexes use the logarithmic ray vs convex poly test", m_numPolysUsingLogarithmicRaycast, NUM_MIN_VERTEXES_FOR_LOGARITHMIC_RAYCAST), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+		if (m_unsortedRaycastTimeMs >= 0.0)
+		{
+			DebugAddMessage(Stringf("Sorted rays: %.2f ms sort + %.2f ms raycasts; Unsorted rays: %.2f ms raycasts (%.2fx)", m_raySortTimeMs, m_totalRaycastTimeMs, m_unsortedRaycastTimeMs,
+				m_unsortedRaycastTimeMs / (m_raySortTimeMs + m_totalRaycastTimeMs)), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+		if (m_narrowPhaseRejectionRates[(int)NarrowPhaseProxy::LOADED_DISC] >= 0.f)
+		{
+			float loadedDiscRejectionRate = m_narrowPhaseRejectionRates[(int)NarrowPhaseProxy::LOADED_DISC];
+			float minimalDiscRejectionRate = m_narrowPhaseRejectionRates[(int)NarrowPhaseProxy::MINIMAL_DISC];
+			float minimalOBBRejectionRate = m_narrowPhaseRejectionRates[(int)NarrowPhaseProxy::MINIMAL_OBB];
+			DebugAddMessage(Stringf("Narrow phase rejection rate: loaded disc %.1f%%, minimal disc %.1f%% (%+.1f), minimal OBB %.1f%% (%+.1f)", 100.f * loadedDiscRejectionRate,
+				100.f * minimalDiscRejectionRate, 100.f * (minimalDiscRejectionRate - loadedDiscRejectionRate), 100.f * minimalOBBRejectionRate, 100.f * (minimalOBBRejectionRate - loadedDiscRejectionRate)), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+		if (!m_raycastThreadBusyTimesMs.empty())
+		{
+			double minThreadBusyTimeMs = m_raycastThreadBusyTimesMs[0];
+			double maxThreadBusyTimeMs = m_raycastThreadBusyTimesMs[0];
+			double totalThreadBusyTimeMs = 0.0;
+			for (int threadIndex = 0; threadIndex < (int)m_raycastThreadBusyTimesMs.size(); threadIndex++)
+			{
+				minThreadBusyTimeMs = m_raycastThreadBusyTimesMs[threadIndex] < minThreadBusyTimeMs ? m_raycastThreadBusyTimesMs[threadIndex] : minThreadBusyTimeMs;
+				maxThreadBusyTimeMs = m_raycastThreadBusyTimesMs[threadIndex] > maxThreadBusyTimeMs ? m_raycastThreadBusyTimesMs[threadIndex] : maxThreadBusyTimeMs;
+				totalThreadBusyTimeMs += m_raycastThreadBusyTimesMs[threadIndex];
+			}
+			DebugAddMessage(Stringf("Wall time: %.2f ms on %d threads; Per-thread time: min %.2f ms, avg %.2f ms, max %.2f ms; %d chunks stolen", m_totalRaycastTimeMs, (int)m_raycastThreadBusyTimesMs.size(),
+				minThreadBusyTimeMs, totalThreadBusyTimeMs / (double)m_raycastThreadBusyTimesMs.size(), maxThreadBusyTimeMs, m_numRaycastChunksStolenInLastTest), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+		if (m_numNodesVisitedInLastTest >= 0)
+		{
+			DebugAddMessage(Stringf("Average BSP2 nodes visited per ray: %.2f", (float)m_numNodesVisitedInLastTest / (float)m_raycastsPerformedInLastTest), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+		if (m_singleVolumeTreeRaycastTimesMs[0] >= 0.0)
+		{
+			DebugAddMessage(Stringf("Raycasts per ms: %.1f (AABB2 tree: %.1f, OBB2 tree: %.1f, Disc2 tree: %.1f); Composite nodes: %d disc, %d AABB2, %d OBB2", (double)m_raycastsPerformedInLastTest / m_totalRaycastTimeMs,
+				(double)m_raycastsPerformedInLastTest / m_singleVolumeTreeRaycastTimesMs[0], (double)m_raycastsPerformedInLastTest / m_singleVolumeTreeRaycastTimesMs[1], (double)m_raycastsPerformedInLastTest / m_singleVolumeTreeRaycastTimesMs[2],
+				m_compositeTree.GetNumNodesWithBoundsType(CompositeBoundsType::DISC), m_compositeTree.GetNumNodesWithBoundsType(CompositeBoundsType::AABB2), m_compositeTree.GetNumNodesWithBoundsType(CompositeBoundsType::OBB2)), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+		if (m_tiledBitRegionsRaycastTimeMs >= 0.0 && m_currentOptimizationMode == OptimizationMode::COLUMN_ROW_BIT_REGIONS)
+		{
+			DebugAddMessage(Stringf("Raycasts per ms: %.1f with %dx%d column/row bit regions (%.1f with %dx%d tiled bit regions)", (double)m_raycastsPerformedInLastTest / m_totalRaycastTimeMs, m_columnRowBitRegions.m_numColumns, m_columnRowBitRegions.m_numRows,
+				(double)m_raycastsPerformedInLastTest / m_tiledBitRegionsRaycastTimeMs, DEFAULT_BIT_BUCKET_GRID_SIZE_X, DEFAULT_BIT_BUCKET_GRID_SIZE_Y), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
+		if (m_tiledBitRegionsRaycastTimeMs >= 0.0 && m_currentOptimizationMode == OptimizationMode::HIERARCHICAL_BIT_BUCKETS)
+		{
+			DebugAddMessage(Stringf("Raycasts per ms: %.1f with %dx%d hierarchical bit buckets (%.1f with %dx%d tiled bit regions)", (double)m_raycastsPerformedInLastTest / m_totalRaycastTimeMs, HierarchicalBitBuckets::FINE_TILES_PER_SIDE, HierarchicalBitBuckets::FINE_TILES_PER_SIDE,
+				(double)m_raycastsPerformedInLastTest / m_tiledBitRegionsRaycastTimeMs, DEFAULT_BIT_BUCKET_GRID_SIZE_X, DEFAULT_BIT_BUCKET_GRID_SIZE_Y), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+		}
 	}
 	DebugAddMessage(Stringf("T = Fire raycasts"), 0.f, Rgba8::CYAN, Rgba8::CYAN);
-	DebugAddMessage(Stringf("Num Polys [Q/E] = %d; Num Raycasts [Z/C] = %d; Optimization [F9] = %s;", m_currentNumPolys, m_currentNumRaycasts, GetOptimizationModeStr(m_currentOptimizationMode).c_str()), 0.f, Rgba8::WHITE, Rgba8::WHITE);
-	DebugAddMessage(Stringf("F1 = Toggle bounding disc debug draw (per polygon); F2 = Toggle shape translucency; F4 = Toggle bit buckets debug draw"), 0.f, Rgba8::CYAN, Rgba8::CYAN);
+	DebugAddMessage(Stringf("Num Polys [Q/E] = %d; Num Raycasts [Z/C] = %d; Optimization [F9] = %s; Hull Kernel [H] = %s; Rays [G] = %s; Threads [M] = %d; Narrow Phase [N] = %s; Hull Order [O] = %s; Query [V] = %s; Ray Sort [R] = %s; Quantized Culling [U] = %s;", m_currentNumPolys, m_currentNumRaycasts, GetOptimizationModeStr(m_currentOptimizationMode).c_str(), GetRaycastKernelStr(m_currentRaycastKernel).c_str(), m_generateRayFans ? "Fans" : "Random", m_useMultithreadedRaycasts ? m_raycastThreadPool.GetNumThreads() : 1, GetNarrowPhaseProxyStr(m_currentNarrowPhaseProxy).c_str(), m_useFrontToBackHullOrder ? "Front to back" : "Scene order", m_useOcclusionQueries ? "Any hit" : "Closest hit", GetRaySortModeStr(m_currentRaySortMode).c_str(), m_useQuantizedCulling ? "On" : "Off"), 0.f, Rgba8::WHITE, Rgba8::WHITE);
+	DebugAddMessage(Stringf("F1 = Toggle bounding disc debug draw (per polygon); F2 = Toggle shape translucency; F3 = Toggle acceleration structure debug draw; F4 = Toggle bit buckets debug draw"), 0.f, Rgba8::CYAN, Rgba8::CYAN);
 	DebugAddMessage(Stringf("F8 = Reset; LMB/RMB = Move raycst start/end; LMB = Drag poly; A/D = Rotate; W/S = Scale"), 0.f, Rgba8::CYAN, Rgba8::CYAN);
 	DebugAddMessage("Mode [F6/F7 = Prev/Next]: Convex Scene (2D)", 0.f, Rgba8::YELLOW, Rgba8::YELLOW);
 
-	if (m_boundingDiscs.empty() && m_currentOptimizationMode == OptimizationMode::NARROW_PHASE_BOUNDING_DISC_ONLY)
+	if (m_boundingDiscs.empty() && m_currentNarrowPhaseProxy == NarrowPhaseProxy::LOADED_DISC && m_currentOptimizationMode == OptimizationMode::NARROW_PHASE_BOUNDING_DISC_ONLY)
 	{
 		DebugAddMessage("Narrow phase optimization unavailable since no bounding discs were loaded. No optimization will be performed!", 0.f, Rgba8::RED, Rgba8::RED);
 	}
-	if (m_boundingDiscs.empty() && m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE)
+	if (m_boundingDiscs.empty() && m_currentNarrowPhaseProxy == NarrowPhaseProxy::LOADED_DISC && m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE)
 	{
 		DebugAddMessage("Narrow phase optimization unavailable since no bounding discs were loaded. Only broad phase optimization will be performed!", 0.f, Rgba8::RED, Rgba8::RED);
 	}
@@ -72,26 +159,41 @@ void VisualTestConvexScene::Render() const
 
 	std::vector<Vertex_PCU> vertexes;
 
-	for (int polyIndex = 0; polyIndex < m_convexPolys.size(); polyIndex++)
+	for (int polyIndex = 0; polyIndex < m_packedScene.GetNumPolys(); polyIndex++)
 	{
-		AddOutlineVertsForConvexPoly2(vertexes, m_convexPolys[polyIndex], POLY_OUTLINE_THICKNESS  * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, outlineColor);
+		m_packedScene.AddVertsForPolyOutline(vertexes, polyIndex, POLY_OUTLINE_THICKNESS  * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, outlineColor);
 	}
 
-	for (int polyIndex = 0; polyIndex < m_convexPolys.size(); polyIndex++)
+	for (int polyIndex = 0; polyIndex < m_packedScene.GetNumPolys(); polyIndex++)
 	{
-		AddVertsForConvexPoly2(vertexes, m_convexPolys[polyIndex], fillColor);
+		m_packedScene.AddVertsForPolyFill(vertexes, polyIndex, fillColor);
 	}
 
-	for (int polyIndex = 0; polyIndex < m_convexPolys.size(); polyIndex++)
+	for (int polyIndex = 0; polyIndex < m_packedScene.GetNumPolys(); polyIndex++)
 	{
-		if (m_boundingDiscs.size() <= polyIndex)
+		if (!m_packedScene.HasBoundingDisc(polyIndex))
 		{
-			break;
+			continue;
 		}
 
-		if (m_boundingDiscs[polyIndex].m_visible)
+		if (m_packedScene.m_isBoundingDiscVisible[polyIndex])
 		{
-			AddVertsForRing2D(vertexes, m_boundingDiscs[polyIndex].m_center, m_boundingDiscs[polyIndex].m_radius, BOUNDING_DISC_THICKNESS * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::MAGENTA);
+			AddVertsForRing2D(vertexes, m_packedScene.GetBoundingDiscCenter(polyIndex), m_packedScene.m_boundingDiscRadii[polyIndex], BOUNDING_DISC_THICKNESS * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::MAGENTA);
+			if (m_currentNarrowPhaseProxy == NarrowPhaseProxy::MINIMAL_DISC && (int)m_minimalBoundingDiscs.size() > polyIndex)
+			{
+				AddVertsForRing2D(vertexes, m_minimalBoundingDiscs[polyIndex].m_center, m_minimalBoundingDiscs[polyIndex].m_radius, BOUNDING_DISC_THICKNESS * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::CYAN);
+			}
+			if (m_currentNarrowPhaseProxy == NarrowPhaseProxy::MINIMAL_OBB && (int)m_minimalBoundingOBBs.size() > polyIndex)
+			{
+				OBB2 const& orientedBox = m_minimalBoundingOBBs[polyIndex];
+				Vec2 iExtent = orientedBox.m_iBasisNormal * orientedBox.m_halfDimensions.x;
+				Vec2 jExtent = orientedBox.m_iBasisNormal.GetRotated90Degrees() * orientedBox.m_halfDimensions.y;
+				Vec2 corners[4] = { orientedBox.m_center - iExtent - jExtent, orientedBox.m_center + iExtent - jExtent, orientedBox.m_center + iExtent + jExtent, orientedBox.m_center - iExtent + jExtent };
+				for (int cornerIndex = 0; cornerIndex < 4; cornerIndex++)
+				{
+					AddVertsForLineSegment2D(vertexes, corners[cornerIndex], corners[(cornerIndex + 1) % 4], BOUNDING_DISC_THICKNESS * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::CYAN);
+				}
+			}
 		}
 	}
 
@@ -109,20 +211,69 @@ void VisualTestConvexScene::Render() const
 
 	if (m_drawBitBucketGrid)
 	{
-		for (int x = 0; x <= BIT_BUCKET_GRID_SIZE_X; x++)
+		for (int x = 0; x <= m_bitBucketGridSizeX; x++)
+		{
+			AddVertsForLineSegment2D(vertexes, Vec2((float)x * WORLD_SIZE_X / m_bitBucketGridSizeX, 0.f), Vec2((float)x * WORLD_SIZE_X / m_bitBucketGridSizeX, WORLD_SIZE_Y), 0.1f, Rgba8::YELLOW);
+		}
+		for (int y = 0; y <= m_bitBucketGridSizeY; y++)
+		{
+			AddVertsForLineSegment2D(vertexes, Vec2(0.f, (float)y * WORLD_SIZE_Y / m_bitBucketGridSizeY), Vec2(WORLD_SIZE_X, (float)y * WORLD_SIZE_Y / m_bitBucketGridSizeY), 0.1f, Rgba8::YELLOW);
+		}
+	}
+
+	if (m_drawAccelerationStructure)
+	{
+		if (m_currentOptimizationMode == OptimizationMode::BVH_AABB2_TREE)
+		{
+			m_aabb2Tree.AddVertsForDebugDraw(vertexes, 0.1f * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::ORANGE);
+		}
+		if (m_currentOptimizationMode == OptimizationMode::BVH_OBB2_TREE)
+		{
+			m_obb2Tree.AddVertsForDebugDraw(vertexes, 0.1f * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::ORANGE);
+		}
+		if (m_currentOptimizationMode == OptimizationMode::BVH_DISC2_TREE)
+		{
+			m_disc2Tree.AddVertsForDebugDraw(vertexes, 0.1f * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::ORANGE);
+		}
+		if (m_currentOptimizationMode == OptimizationMode::BVH_CONVEX_HULL_TREE)
+		{
+			m_convexHull2Tree.AddVertsForDebugDraw(vertexes, 0.1f * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::ORANGE);
+		}
+		if (m_currentOptimizationMode == OptimizationMode::BVH_COMPOSITE_TREE)
+		{
+			m_compositeTree.AddVertsForDebugDraw(vertexes, 0.1f * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::ORANGE);
+		}
+		if (m_currentOptimizationMode == OptimizationMode::ASYMMETRIC_QUADTREE)
+		{
+			m_asymmetricQuadtree.AddVertsForDebugDraw(vertexes, 0.1f * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::ORANGE);
+		}
+		if (m_currentOptimizationMode == OptimizationMode::SYMMETRIC_QUADTREE)
+		{
+			m_symmetricQuadtree.AddVertsForDebugDraw(vertexes, 0.1f * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::ORANGE);
+		}
+		if (m_currentOptimizationMode == OptimizationMode::COLUMN_ROW_BIT_REGIONS)
+		{
+			m_columnRowBitRegions.AddVertsForDebugDraw(vertexes, 0.1f * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::ORANGE);
+		}
+		if (m_currentOptimizationMode == OptimizationMode::BSP2_TREE)
 		{
-			AddVertsForLineSegment2D(vertexes, Vec2((float)x * WORLD_SIZE_X / BIT_BUCKET_GRID_SIZE_X, 0.f), Vec2((float)x * WORLD_SIZE_X / BIT_BUCKET_GRID_SIZE_X, WORLD_SIZE_Y), 0.1f, Rgba8::YELLOW);
+			m_bsp2Tree.AddVertsForDebugDraw(vertexes, 0.1f * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::ORANGE);
 		}
-		for (int y = 0; y <= BIT_BUCKET_GRID_SIZE_Y; y++)
+		if (m_currentOptimizationMode == OptimizationMode::HIERARCHICAL_BIT_BUCKETS)
 		{
-			AddVertsForLineSegment2D(vertexes, Vec2(0.f, (float)y * WORLD_SIZE_Y / BIT_BUCKET_GRID_SIZE_Y), Vec2(WORLD_SIZE_X, (float)y * WORLD_SIZE_Y / BIT_BUCKET_GRID_SIZE_Y), 0.1f, Rgba8::YELLOW);
+			m_hierarchicalBitBuckets.AddVertsForDebugDraw(vertexes, 0.1f * m_sceneBounds.GetDimensions().y / WORLD_SIZE_Y, Rgba8::ORANGE);
 		}
 	}
 
 	if (m_hoveredConvexPolyIndex != -1)
 	{
-		AddOutlineVertsForConvexPoly2(vertexes, m_convexPolys[m_hoveredConvexPolyIndex], POLY_OUTLINE_THICKNESS, outlineColor);
-		AddVertsForConvexPoly2(vertexes, m_convexPolys[m_hoveredConvexPolyIndex], Rgba8::DODGER_BLUE);
+		m_packedScene.AddVertsForPolyOutline(vertexes, m_hoveredConvexPolyIndex, POLY_OUTLINE_THICKNESS, outlineColor);
+		m_packedScene.AddVertsForPolyFill(vertexes, m_hoveredConvexPolyIndex, Rgba8::DODGER_BLUE);
+	}
+
+	for (int overlappingPolyIdx = 0; overlappingPolyIdx < (int)m_polyIndexesOverlappingSelectedPoly.size(); overlappingPolyIdx++)
+	{
+		m_packedScene.AddVertsForPolyOutline(vertexes, m_polyIndexesOverlappingSelectedPoly[overlappingPolyIdx], POLY_OUTLINE_THICKNESS, Rgba8::ORANGE);
 	}
 
 	// Add visible raycast verts
@@ -132,9 +283,11 @@ void VisualTestConvexScene::Render() const
 	closestRaycastResult.m_rayStartPosition = m_visibleRaycastStart;
 	closestRaycastResult.m_rayForwardNormal = rayFwd;
 	closestRaycastResult.m_impactDistance = rayMaxDistance;
-	for (int polyIndex = 0; polyIndex < (int)m_convexPolys.size(); polyIndex++)
+	for (int polyIndex = 0; polyIndex < m_packedScene.GetNumPolys(); polyIndex++)
 	{
-		RaycastResult2D raycastVsHullResult = RaycastVsConvexHull2_WithDebugDrawWhenForSimpleHull(m_visibleRaycastStart, rayFwd, rayMaxDistance, m_convexHulls[polyIndex], vertexes);
+		// Only a lone hull gets its entry/exit points drawn, which needs the unpacked planes
+		RaycastResult2D raycastVsHullResult = m_currentNumPolys == 1 ? RaycastVsConvexHull2_WithDebugDrawWhenForSimpleHull(m_visibleRaycastStart, rayFwd, rayMaxDistance, m_convexHulls[polyIndex], vertexes)
+			: RaycastVsConvexHullWithCurrentKernel(polyIndex, m_visibleRaycastStart, rayFwd, rayMaxDistance);
 		if (raycastVsHullResult.m_didImpact && raycastVsHullResult.m_impactDistance < closestRaycastResult.m_impactDistance)
 		{
 			closestRaycastResult = raycastVsHullResult;
@@ -178,6 +331,7 @@ void VisualTestConvexScene::Randomize()
 {
 	m_selectedConvexPolyIndex = -1;
 	m_hoveredConvexPolyIndex = -1;
+	m_polyIndexesOverlappingSelectedPoly.clear();
 
 	m_convexHulls.clear();
 	m_convexPolys.clear();
@@ -209,6 +363,9 @@ void VisualTestConvexScene::Randomize()
 	}
 
 	GenerateHullsForAllPolys();
+	MarkSceneAsModified();
+	m_needToRegenerateConvexPoly2Tree = true;
+	m_needToRegenerateSymmetricQuadtree = true;
 }
 
 void VisualTestConvexScene::HandleInput()
@@ -225,15 +382,11 @@ void VisualTestConvexScene::HandleInput()
 
 	if (m_selectedConvexPolyIndex == -1 && !m_isMovingRaycast)
 	{
-		m_hoveredConvexPolyIndex = -1;
-		for (int polyIndex = 0; polyIndex < m_convexPolys.size(); polyIndex++)
+		if (m_convexPoly2Tree.IsEmpty() || m_needToRegenerateConvexPoly2Tree)
 		{
-			if (IsPointInsideConvexPoly2(cursorWorldPosition, m_convexPolys[polyIndex]))
-			{
-				m_hoveredConvexPolyIndex = polyIndex;
-				break;
-			}
+			GenerateConvexPoly2Tree();
 		}
+		m_hoveredConvexPolyIndex = m_convexPoly2Tree.GetPolyIndexContainingPoint(cursorWorldPosition, m_convexPolys);
 	}
 
 	if (m_selectedConvexPolyIndex != -1)
@@ -246,6 +399,15 @@ void VisualTestConvexScene::HandleInput()
 		{
 			m_convexPolys[m_selectedConvexPolyIndex].SetPositionForVertexAtIndex(cursorWorldPosition + m_vertexOffsetsFromCursorPosition[vertexIndex], vertexIndex);
 		}
+		RefitConvexPoly2TreeForPolyAtIndex(m_selectedConvexPolyIndex);
+		RebucketPolyAtIndexInSymmetricQuadtree(m_selectedConvexPolyIndex);
+		RegenerateHullForForPolyAtIndex(m_selectedConvexPolyIndex);
+		// Marked every frame, since a 'T' test mid-drag patches and clears the modified list
+		MarkPolyAsModified(m_selectedConvexPolyIndex);
+
+		m_polyIndexesOverlappingSelectedPoly.clear();
+		m_convexPoly2Tree.GetPolyIndexesOverlappingConvexPoly2(m_convexPolys[m_selectedConvexPolyIndex], m_convexPolys, m_polyIndexesOverlappingSelectedPoly);
+		m_polyIndexesOverlappingSelectedPoly.erase(std::remove(m_polyIndexesOverlappingSelectedPoly.begin(), m_polyIndexesOverlappingSelectedPoly.end(), m_selectedConvexPolyIndex), m_polyIndexesOverlappingSelectedPoly.end());
 	}
 
 	if (g_input->WasKeyJustPressed(KEYCODE_LMB))
@@ -264,8 +426,7 @@ void VisualTestConvexScene::HandleInput()
 				m_vertexOffsetsFromCursorPosition.push_back(selectedPolyVertexes[vertexIndex] - cursorWorldPosition);
 			}
 
-			m_needToRegenerateBitMasks = true;
-			m_unknownFileChunksLoaded.clear();
+			MarkPolyAsModified(m_selectedConvexPolyIndex);
 		}
 		else
 		{
@@ -279,6 +440,7 @@ void VisualTestConvexScene::HandleInput()
 		m_selectedConvexPolyIndex = -1;
 		m_selectedPolyOffsetFromCursorPosition = Vec2::ZERO;
 		m_vertexOffsetsFromCursorPosition.clear();
+		m_polyIndexesOverlappingSelectedPoly.clear();
 	}
 	if (g_input->IsKeyDown(KEYCODE_LMB) && m_isMovingRaycast)
 	{
@@ -322,12 +484,20 @@ void VisualTestConvexScene::HandleInput()
 		if (m_boundingDiscs.size() > m_hoveredConvexPolyIndex)
 		{
 			m_boundingDiscs[m_hoveredConvexPolyIndex].m_visible = !m_boundingDiscs[m_hoveredConvexPolyIndex].m_visible;
+			if (m_packedScene.GetNumPolys() > m_hoveredConvexPolyIndex)
+			{
+				m_packedScene.m_isBoundingDiscVisible[m_hoveredConvexPolyIndex] = m_boundingDiscs[m_hoveredConvexPolyIndex].m_visible ? 1 : 0;
+			}
 		}
 	}
 	if (g_input->WasKeyJustPressed(KEYCODE_F2))
 	{
 		m_drawWithTranslucentFill = !m_drawWithTranslucentFill;
 	}
+	if (g_input->WasKeyJustPressed(KEYCODE_F3))
+	{
+		m_drawAccelerationStructure = !m_drawAccelerationStructure;
+	}
 	if (g_input->WasKeyJustPressed(KEYCODE_F4))
 	{
 		m_drawBitBucketGrid = !m_drawBitBucketGrid;
@@ -336,12 +506,43 @@ void VisualTestConvexScene::HandleInput()
 	{
 		m_currentOptimizationMode = OptimizationMode(((int)m_currentOptimizationMode + 1) % (int)OptimizationMode::NUM);
 	}
+	if (g_input->WasKeyJustPressed('H'))
+	{
+		m_currentRaycastKernel = RaycastKernel(((int)m_currentRaycastKernel + 1) % (int)RaycastKernel::NUM);
+	}
+	if (g_input->WasKeyJustPressed('G'))
+	{
+		m_generateRayFans = !m_generateRayFans;
+	}
+	if (g_input->WasKeyJustPressed('M'))
+	{
+		m_useMultithreadedRaycasts = !m_useMultithreadedRaycasts;
+	}
+	if (g_input->WasKeyJustPressed('R'))
+	{
+		m_currentRaySortMode = RaySortMode(((int)m_currentRaySortMode + 1) % (int)RaySortMode::NUM);
+	}
+	if (g_input->WasKeyJustPressed('V'))
+	{
+		m_useOcclusionQueries = !m_useOcclusionQueries;
+	}
+	if (g_input->WasKeyJustPressed('U'))
+	{
+		m_useQuantizedCulling = !m_useQuantizedCulling;
+	}
+	if (g_input->WasKeyJustPressed('O'))
+	{
+		m_useFrontToBackHullOrder = !m_useFrontToBackHullOrder;
+	}
+	if (g_input->WasKeyJustPressed('N'))
+	{
+		m_currentNarrowPhaseProxy = NarrowPhaseProxy(((int)m_currentNarrowPhaseProxy + 1) % (int)NarrowPhaseProxy::NUM);
+	}
 	if (g_input->WasKeyJustPressed('E'))
 	{
 		if (m_currentNumPolys < NUM_MAX_POLYS)
 		{
-			m_needToRegenerateBitMasks = true;
-			m_unknownFileChunksLoaded.clear();
+			MarkSceneAsModified();
 			if (m_currentNumPolys == 0)
 			{
 				m_currentNumPolys = 1;
@@ -357,8 +558,7 @@ void VisualTestConvexScene::HandleInput()
 	{
 		if (m_currentNumPolys > 0)
 		{
-			m_needToRegenerateBitMasks = true;
-			m_unknownFileChunksLoaded.clear();
+			MarkSceneAsModified();
 			m_currentNumPolys /= 2;
 			Randomize();
 		}
@@ -380,15 +580,125 @@ void VisualTestConvexScene::HandleInput()
 
 	if (g_input->WasKeyJustPressed('T'))
 	{
+		UpdateModifiedPolys();
 		if ((m_bitBucketMasks.empty() || m_needToRegenerateBitMasks) && (m_currentOptimizationMode == OptimizationMode::BROAD_PHASE_BIT_BUCKET_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE))
 		{
 			GenerateBitMasksForAllPolys();
 		}
+		if ((m_aabb2Tree.IsEmpty() || m_needToRegenerateAABB2Tree) && m_currentOptimizationMode == OptimizationMode::BVH_AABB2_TREE)
+		{
+			GenerateAABB2Tree();
+		}
+		if ((m_obb2Tree.IsEmpty() || m_needToRegenerateOBB2Tree) && m_currentOptimizationMode == OptimizationMode::BVH_OBB2_TREE)
+		{
+			GenerateOBB2Tree();
+		}
+		if ((m_disc2Tree.IsEmpty() || m_needToRegenerateDisc2Tree) && m_currentOptimizationMode == OptimizationMode::BVH_DISC2_TREE)
+		{
+			GenerateDisc2Tree();
+		}
+		if ((m_convexHull2Tree.IsEmpty() || m_needToRegenerateConvexHull2Tree) && m_currentOptimizationMode == OptimizationMode::BVH_CONVEX_HULL_TREE)
+		{
+			GenerateConvexHull2Tree();
+		}
+		if ((m_compositeTree.IsEmpty() || m_needToRegenerateCompositeTree) && m_currentOptimizationMode == OptimizationMode::BVH_COMPOSITE_TREE)
+		{
+			GenerateCompositeTree();
+		}
+		if ((m_asymmetricQuadtree.IsEmpty() || m_needToRegenerateAsymmetricQuadtree) && m_currentOptimizationMode == OptimizationMode::ASYMMETRIC_QUADTREE)
+		{
+			GenerateAsymmetricQuadtree();
+		}
+		if ((m_symmetricQuadtree.IsEmpty() || m_needToRegenerateSymmetricQuadtree) && m_currentOptimizationMode == OptimizationMode::SYMMETRIC_QUADTREE)
+		{
+			GenerateSymmetricQuadtree();
+		}
+		if ((m_columnRowBitRegions.IsEmpty() || m_needToRegenerateColumnRowBitRegions) && m_currentOptimizationMode == OptimizationMode::COLUMN_ROW_BIT_REGIONS)
+		{
+			GenerateColumnRowBitRegions();
+		}
+		if ((m_bsp2Tree.IsEmpty() || m_needToRegenerateBSP2Tree) && m_currentOptimizationMode == OptimizationMode::BSP2_TREE)
+		{
+			GenerateBSP2Tree();
+		}
+		if ((m_hierarchicalBitBuckets.IsEmpty() || m_needToRegenerateHierarchicalBitBuckets) && m_currentOptimizationMode == OptimizationMode::HIERARCHICAL_BIT_BUCKETS)
+		{
+			GenerateHierarchicalBitBuckets();
+		}
+		if (m_packedScene.IsEmpty() || m_needToRegeneratePackedScene)
+		{
+			GeneratePackedScene();
+		}
+		if (m_minimalBoundingDiscs.empty() || m_needToRegenerateMinimalBoundingVolumes)
+		{
+			GenerateMinimalBoundingVolumesForAllPolys();
+		}
 		GenerateRandomRaycasts();
 		PerformAllTestRaycasts();
 	}
 }
 
+void VisualTestConvexScene::MarkSceneAsModified()
+{
+	m_needToRegenerateBitMasks = true;
+	m_needToRegenerateAABB2Tree = true;
+	m_needToRegenerateOBB2Tree = true;
+	m_needToRegenerateDisc2Tree = true;
+	m_needToRegenerateConvexHull2Tree = true;
+	m_needToRegenerateCompositeTree = true;
+	m_needToRegenerateAsymmetricQuadtree = true;
+	m_needToRegenerateColumnRowBitRegions = true;
+	m_needToRegenerateBSP2Tree = true;
+	m_needToRegenerateHierarchicalBitBuckets = true;
+	m_needToRegeneratePackedScene = true;
+	m_needToRegenerateMinimalBoundingVolumes = true;
+	m_unknownFileChunksLoaded.clear();
+	m_modifiedPolyIndexes.clear();
+}
+
+void VisualTestConvexScene::MarkPolyAsModified(int polyIndex)
+{
+	// Trees are rebuilt whole; per-poly data is patched in UpdateModifiedPolys
+	m_needToRegenerateAABB2Tree = true;
+	m_needToRegenerateOBB2Tree = true;
+	m_needToRegenerateDisc2Tree = true;
+	m_needToRegenerateConvexHull2Tree = true;
+	m_needToRegenerateCompositeTree = true;
+	m_needToRegenerateAsymmetricQuadtree = true;
+	m_needToRegenerateColumnRowBitRegions = true;
+	m_needToRegenerateBSP2Tree = true;
+	m_needToRegenerateHierarchicalBitBuckets = true;
+	m_unknownFileChunksLoaded.clear();
+
+	if (std::find(m_modifiedPolyIndexes.begin(), m_modifiedPolyIndexes.end(), polyIndex) == m_modifiedPolyIndexes.end())
+	{
+		m_modifiedPolyIndexes.push_back(polyIndex);
+	}
+}
+
+void VisualTestConvexScene::UpdateModifiedPolys()
+{
+	// Anything already flagged for a full rebuild will pick these polys up anyway
+	bool canUpdateBitMasks = !m_bitBucketMasks.empty() && !m_needToRegenerateBitMasks;
+	bool canUpdateMinimalBoundingVolumes = !m_minimalBoundingDiscs.empty() && !m_needToRegenerateMinimalBoundingVolumes;
+
+	for (int modifiedIndex = 0; modifiedIndex < (int)m_modifiedPolyIndexes.size(); modifiedIndex++)
+	{
+		int polyIndex = m_modifiedPolyIndexes[modifiedIndex];
+		RegenerateHullForForPolyAtIndex(polyIndex);
+		if (canUpdateBitMasks)
+		{
+			GenerateBitMaskForPolyAtIndex(polyIndex);
+		}
+		if (canUpdateMinimalBoundingVolumes)
+		{
+			GenerateMinimalBoundingVolumesForPolyAtIndex(polyIndex);
+		}
+	}
+
+	m_modifiedPolyIndexes.clear();
+}
+
 void VisualTestConvexScene::RotatePolyAtIndexAroundPointByDegrees(int polyIndex, Vec2 const& point, float degrees)
 {
 	std::vector<Vec2> vertexes = m_convexPolys[polyIndex].GetVertexes();
@@ -406,8 +716,10 @@ void VisualTestConvexScene::RotatePolyAtIndexAroundPointByDegrees(int polyIndex,
 		m_boundingDiscs[polyIndex].m_center = point + displacementPointToBoundingDiscCenter.GetRotatedDegrees(degrees);
 	}
 
-	m_needToRegenerateBitMasks = true;
-	m_unknownFileChunksLoaded.clear();
+	RefitConvexPoly2TreeForPolyAtIndex(polyIndex);
+	RebucketPolyAtIndexInSymmetricQuadtree(polyIndex);
+	RegenerateHullForForPolyAtIndex(polyIndex);
+	MarkPolyAsModified(polyIndex);
 }
 
 void VisualTestConvexScene::ScalePolyAtIndexAroundPointByFactor(int polyIndex, Vec2 const& point, float scalingFactor)
@@ -428,8 +740,10 @@ void VisualTestConvexScene::ScalePolyAtIndexAroundPointByFactor(int polyIndex, V
 		m_boundingDiscs[polyIndex].m_radius *= scalingFactor;
 	}
 
-	m_needToRegenerateBitMasks = true;
-	m_unknownFileChunksLoaded.clear();
+	RefitConvexPoly2TreeForPolyAtIndex(polyIndex);
+	RebucketPolyAtIndexInSymmetricQuadtree(polyIndex);
+	RegenerateHullForForPolyAtIndex(polyIndex);
+	MarkPolyAsModified(polyIndex);
 }
 
 void VisualTestConvexScene::GenerateHullsForAllPolys()
@@ -438,6 +752,7 @@ void VisualTestConvexScene::GenerateHullsForAllPolys()
 	{
 		m_convexHulls.push_back(ConvexHull2(m_convexPolys[polyIndex]));
 	}
+	m_needToRegeneratePackedScene = true;
 }
 
 void VisualTestConvexScene::RegenerateHullForForPolyAtIndex(int polyIndex)
@@ -448,36 +763,64 @@ void VisualTestConvexScene::RegenerateHullForForPolyAtIndex(int polyIndex)
 	}
 
 	m_convexHulls[polyIndex] = ConvexHull2(m_convexPolys[polyIndex]);
+	if (m_packedScene.IsEmpty() || m_needToRegeneratePackedScene || !m_packedScene.UpdatePolyAtIndex(polyIndex, m_convexPolys[polyIndex], m_convexHulls[polyIndex]))
+	{
+		m_needToRegeneratePackedScene = true;
+		return;
+	}
+
+	if ((int)m_boundingDiscs.size() > polyIndex)
+	{
+		m_packedScene.SetBoundingDiscAtIndex(polyIndex, m_boundingDiscs[polyIndex].m_center, m_boundingDiscs[polyIndex].m_radius, m_boundingDiscs[polyIndex].m_visible);
+	}
+	if (!m_quantizedScene.UpdatePolyAtIndex(polyIndex, m_packedScene))
+	{
+		m_needToRegeneratePackedScene = true;
+	}
 }
 
 void VisualTestConvexScene::GenerateBitMasksForAllPolys()
 {
-	m_bitBucketMasks.clear();
+	m_numWordsPerBitBucketMask = (m_bitBucketGridSizeX * m_bitBucketGridSizeY + 63) / 64;
+	m_bitBucketMasks.assign(m_convexPolys.size() * m_numWordsPerBitBucketMask, 0ull);
 
 	for (int polyIndex = 0; polyIndex < (int)m_convexPolys.size(); polyIndex++)
 	{
-		m_bitBucketMasks.push_back(0ull);
-		ConvexPoly2 const& convexPoly = m_convexPolys[polyIndex];
-		std::vector<Vec2> convexPolyVerts = convexPoly.GetVertexes();
+		GenerateBitMaskForPolyAtIndex(polyIndex);
+	}
 
-		for (int vertexIndex = 0; vertexIndex < (int)convexPolyVerts.size(); vertexIndex++)
+	m_needToRegenerateBitMasks = false;
+}
+
+void VisualTestConvexScene::GenerateBitMaskForPolyAtIndex(int polyIndex)
+{
+	unsigned long long* polyBitMask = &m_bitBucketMasks[polyIndex * m_numWordsPerBitBucketMask];
+	std::fill(polyBitMask, polyBitMask + m_numWordsPerBitBucketMask, 0ull);
+
+	ConvexPoly2 const& convexPoly = m_convexPolys[polyIndex];
+	std::vector<Vec2> convexPolyVerts = convexPoly.GetVertexes();
+
+	for (int vertexIndex = 0; vertexIndex < (int)convexPolyVerts.size(); vertexIndex++)
+	{
+		Vec2 const& vertexPosition = convexPolyVerts[vertexIndex];
+		IntVec2 vertexTileCoords = GetTileCoordsForWorldPosition(vertexPosition);
+		if (vertexTileCoords.x >= 0 && vertexTileCoords.y >= 0 && vertexTileCoords.x < m_bitBucketGridSizeX && vertexTileCoords.y < m_bitBucketGridSizeY)
 		{
-			Vec2 const& vertexPosition = convexPolyVerts[vertexIndex];
-			int tileIndexForVertexPosition = GetTileIndexForWorldPosition(vertexPosition);
-			m_bitBucketMasks[polyIndex] |= 1ull << tileIndexForVertexPosition;
+			int tileIndexForVertexPosition = GetTileIndexForTileCoords(vertexTileCoords);
+			polyBitMask[tileIndexForVertexPosition / 64] |= 1ull << (tileIndexForVertexPosition % 64);
+		}
 
-			Vec2 nextVertexPosition = convexPolyVerts[0];
-			if (vertexIndex < (int)convexPolyVerts.size() - 1)
-			{
-				nextVertexPosition = convexPolyVerts[vertexIndex + 1];
-			}
+		Vec2 nextVertexPosition = convexPolyVerts[0];
+		if (vertexIndex < (int)convexPolyVerts.size() - 1)
+		{
+			nextVertexPosition = convexPolyVerts[vertexIndex + 1];
+		}
 
-			std::vector<unsigned int> edgeTiles;
-			GetAllTileIndexesForRaycastVsGrid(vertexPosition, (nextVertexPosition - vertexPosition).GetNormalized(), (nextVertexPosition - vertexPosition).GetLength(), edgeTiles);
-			for (int edgeTileIndex = 0; edgeTileIndex < (int)edgeTiles.size(); edgeTileIndex++)
-			{
-				m_bitBucketMasks[polyIndex] |= 1ull << edgeTiles[edgeTileIndex];
-			}
+		std::vector<unsigned int> edgeTiles;
+		GetAllTileIndexesForRaycastVsGrid(vertexPosition, (nextVertexPosition - vertexPosition).GetNormalized(), (nextVertexPosition - vertexPosition).GetLength(), edgeTiles);
+		for (int edgeTileIndex = 0; edgeTileIndex < (int)edgeTiles.size(); edgeTileIndex++)
+		{
+			polyBitMask[edgeTiles[edgeTileIndex] / 64] |= 1ull << (edgeTiles[edgeTileIndex] % 64);
 		}
 	}
 }
@@ -513,6 +856,145 @@ void VisualTestConvexScene::GenerateBoundingDiscsForAllPolys()
 	}
 }
 
+void VisualTestConvexScene::GenerateMinimalBoundingVolumesForAllPolys()
+{
+	m_minimalBoundingDiscs.clear();
+	m_minimalBoundingOBBs.clear();
+
+	for (int polyIndex = 0; polyIndex < (int)m_convexPolys.size(); polyIndex++)
+	{
+		std::vector<Vec2> vertexes = m_convexPolys[polyIndex].GetVertexes();
+		BoundingDisc disc;
+		GetMinimalEnclosingDisc2D(vertexes, disc.m_center, disc.m_radius);
+		m_minimalBoundingDiscs.push_back(disc);
+		m_minimalBoundingOBBs.push_back(GetMinimalAreaOBB2ForConvexPolygon(vertexes));
+	}
+
+	m_needToRegenerateMinimalBoundingVolumes = false;
+}
+
+void VisualTestConvexScene::GenerateMinimalBoundingVolumesForPolyAtIndex(int polyIndex)
+{
+	std::vector<Vec2> vertexes = m_convexPolys[polyIndex].GetVertexes();
+	GetMinimalEnclosingDisc2D(vertexes, m_minimalBoundingDiscs[polyIndex].m_center, m_minimalBoundingDiscs[polyIndex].m_radius);
+	m_minimalBoundingOBBs[polyIndex] = GetMinimalAreaOBB2ForConvexPolygon(vertexes);
+}
+
+void VisualTestConvexScene::GenerateAABB2Tree()
+{
+	double buildStartTimeSeconds = GetCurrentTimeSeconds();
+	m_aabb2Tree.Build(m_convexPolys, m_useMultithreadedRaycasts ? &m_raycastThreadPool : nullptr);
+	m_aabb2TreeBuildTimeMs = (GetCurrentTimeSeconds() - buildStartTimeSeconds) * 1000.0;
+	m_needToRegenerateAABB2Tree = false;
+}
+
+void VisualTestConvexScene::GenerateOBB2Tree()
+{
+	m_obb2Tree.Build(m_convexPolys);
+	m_needToRegenerateOBB2Tree = false;
+}
+
+void VisualTestConvexScene::GenerateDisc2Tree()
+{
+	if (m_boundingDiscs.empty())
+	{
+		GenerateBoundingDiscsForAllPolys();
+	}
+	m_disc2Tree.Build(m_boundingDiscs);
+	m_needToRegenerateDisc2Tree = false;
+}
+
+void VisualTestConvexScene::GenerateConvexHull2Tree()
+{
+	m_convexHull2Tree.Build(m_convexPolys);
+	m_needToRegenerateConvexHull2Tree = false;
+}
+
+void VisualTestConvexScene::GenerateConvexPoly2Tree()
+{
+	m_convexPoly2Tree.Build(m_convexPolys);
+	m_needToRegenerateConvexPoly2Tree = false;
+}
+
+void VisualTestConvexScene::RefitConvexPoly2TreeForPolyAtIndex(int polyIndex)
+{
+	// Moving a poly keeps the tree topology valid, only a changed poly set needs a rebuild
+	if (m_convexPoly2Tree.IsEmpty() || m_needToRegenerateConvexPoly2Tree)
+	{
+		return;
+	}
+
+	m_convexPoly2Tree.RefitPolyAtIndex(polyIndex, m_convexPolys);
+}
+
+void VisualTestConvexScene::RebucketPolyAtIndexInSymmetricQuadtree(int polyIndex)
+{
+	// Only the moved poly changes node, the rest of the tree stays valid
+	if (m_symmetricQuadtree.IsEmpty() || m_needToRegenerateSymmetricQuadtree)
+	{
+		return;
+	}
+
+	m_symmetricQuadtree.RemovePoly(polyIndex);
+	m_symmetricQuadtree.InsertPoly(polyIndex, m_convexPolys[polyIndex]);
+}
+
+void VisualTestConvexScene::GenerateCompositeTree()
+{
+	m_compositeTree.Build(m_convexPolys);
+	m_needToRegenerateCompositeTree = false;
+}
+
+void VisualTestConvexScene::GenerateAsymmetricQuadtree()
+{
+	m_asymmetricQuadtree.Build(m_convexPolys);
+	m_needToRegenerateAsymmetricQuadtree = false;
+}
+
+void VisualTestConvexScene::GenerateSymmetricQuadtree()
+{
+	m_symmetricQuadtree.Build(m_convexPolys, m_sceneBounds);
+	m_needToRegenerateSymmetricQuadtree = false;
+}
+
+void VisualTestConvexScene::GenerateColumnRowBitRegions()
+{
+	m_columnRowBitRegions.Build(m_convexPolys, m_sceneBounds, m_numColumnRowBitRegionColumns);
+	m_needToRegenerateColumnRowBitRegions = false;
+}
+
+void VisualTestConvexScene::GenerateBSP2Tree()
+{
+	m_bsp2Tree.Build(m_convexPolys, m_convexHulls);
+	m_needToRegenerateBSP2Tree = false;
+}
+
+void VisualTestConvexScene::GenerateHierarchicalBitBuckets()
+{
+	m_hierarchicalBitBuckets.Build(m_convexPolys, m_sceneBounds);
+	m_needToRegenerateHierarchicalBitBuckets = false;
+}
+
+void VisualTestConvexScene::GeneratePackedScene()
+{
+	m_packedScene.Build(m_convexPolys, m_convexHulls);
+	for (int polyIndex = 0; polyIndex < (int)m_boundingDiscs.size() && polyIndex < m_packedScene.GetNumPolys(); polyIndex++)
+	{
+		m_packedScene.SetBoundingDiscAtIndex(polyIndex, m_boundingDiscs[polyIndex].m_center, m_boundingDiscs[polyIndex].m_radius, m_boundingDiscs[polyIndex].m_visible);
+	}
+	m_quantizedScene.Build(m_packedScene, m_sceneBounds);
+
+	m_numPolysUsingLogarithmicRaycast = 0;
+	for (int polyIndex = 0; polyIndex < m_packedScene.GetNumPolys(); polyIndex++)
+	{
+		if (m_packedScene.GetNumVertexes(polyIndex) >= NUM_MIN_VERTEXES_FOR_LOGARITHMIC_RAYCAST)
+		{
+			m_numPolysUsingLogarithmicRaycast++;
+		}
+	}
+	m_needToRegeneratePackedScene = false;
+}
+
 RaycastResult2D VisualTestConvexScene::RaycastVsConvexHull2_WithDebugDrawWhenForSimpleHull(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, ConvexHull2 const& convexHull, std::vector<Vertex_PCU>& verts) const
 {
 	bool drawColorCodedEntryExitPoints = false;
@@ -658,7 +1140,7 @@ RaycastResult2D VisualTestConvexScene::RaycastVsConvexHull2_WithDebugDrawWhenFor
 void VisualTestConvexScene::GetAllTileIndexesForRaycastVsGrid(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, std::vector<unsigned int>& out_tileIndexes) const
 {
 	IntVec2 currentTile = GetTileCoordsForWorldPosition(startPos);
-	Vec2 rayStepSize = Vec2(fwdNormal.x != 0 ? (WORLD_SIZE_X / BIT_BUCKET_GRID_SIZE_X) / fabsf(fwdNormal.x) : 99999.f, fwdNormal.y != 0 ? (WORLD_SIZE_Y / BIT_BUCKET_GRID_SIZE_Y) / fabsf(fwdNormal.y) : 99999.f);
+	Vec2 rayStepSize = Vec2(fwdNormal.x != 0 ? (WORLD_SIZE_X / m_bitBucketGridSizeX) / fabsf(fwdNormal.x) : 99999.f, fwdNormal.y != 0 ? (WORLD_SIZE_Y / m_bitBucketGridSizeY) / fabsf(fwdNormal.y) : 99999.f);
 	Vec2 cumulativeRayLengthIn1D;
 	IntVec2 directionXY;
 	float totalRayLength = 0.f;
@@ -666,28 +1148,28 @@ void VisualTestConvexScene::GetAllTileIndexesForRaycastVsGrid(Vec2 const& startP
 	if (fwdNormal.x < 0.f)
 	{
 		directionXY.x = -1;
-		cumulativeRayLengthIn1D.x = (startPos.x * (BIT_BUCKET_GRID_SIZE_X / WORLD_SIZE_X) - static_cast<float>(currentTile.x)) * rayStepSize.x;
+		cumulativeRayLengthIn1D.x = (startPos.x * (m_bitBucketGridSizeX / WORLD_SIZE_X) - static_cast<float>(currentTile.x)) * rayStepSize.x;
 	}
 	else
 	{
 		directionXY.x = 1;
-		cumulativeRayLengthIn1D.x = (static_cast<float>(currentTile.x) + 1.f - startPos.x * (BIT_BUCKET_GRID_SIZE_X / WORLD_SIZE_X)) * rayStepSize.x;
+		cumulativeRayLengthIn1D.x = (static_cast<float>(currentTile.x) + 1.f - startPos.x * (m_bitBucketGridSizeX / WORLD_SIZE_X)) * rayStepSize.x;
 	}
 
 	if (fwdNormal.y < 0)
 	{
 		directionXY.y = -1;
-		cumulativeRayLengthIn1D.y = (startPos.y * (BIT_BUCKET_GRID_SIZE_Y / WORLD_SIZE_Y) - static_cast<float>(currentTile.y)) * rayStepSize.y;
+		cumulativeRayLengthIn1D.y = (startPos.y * (m_bitBucketGridSizeY / WORLD_SIZE_Y) - static_cast<float>(currentTile.y)) * rayStepSize.y;
 	}
 	else
 	{
 		directionXY.y = 1;
-		cumulativeRayLengthIn1D.y = (static_cast<float>(currentTile.y) + 1.f - startPos.y * (BIT_BUCKET_GRID_SIZE_Y / WORLD_SIZE_Y)) * rayStepSize.y;
+		cumulativeRayLengthIn1D.y = (static_cast<float>(currentTile.y) + 1.f - startPos.y * (m_bitBucketGridSizeY / WORLD_SIZE_Y)) * rayStepSize.y;
 	}
 
 	while (totalRayLength < maxDistance)
 	{
-		if (currentTile.x < 0 || currentTile.y < 0 || currentTile.x > BIT_BUCKET_GRID_SIZE_X - 1 || currentTile.y > BIT_BUCKET_GRID_SIZE_Y)
+		if (currentTile.x < 0 || currentTile.y < 0 || currentTile.x > m_bitBucketGridSizeX - 1 || currentTile.y > m_bitBucketGridSizeY - 1)
 		{
 			return;
 		}
@@ -709,61 +1191,468 @@ void VisualTestConvexScene::GetAllTileIndexesForRaycastVsGrid(Vec2 const& startP
 	}
 }
 
-void VisualTestConvexScene::GenerateRandomRaycasts()
+void VisualTestConvexScene::GetBitBucketMaskForRaycast(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, RaycastQueryContext& context) const
 {
-	m_rayStartPositions.clear();
-	m_rayFwdNormals.clear();
-	m_rayMaxDistances.clear();
+	context.m_rayBitMask.assign(m_numWordsPerBitBucketMask, 0ull);
+	context.m_firstRayMaskWordIndex = m_numWordsPerBitBucketMask;
+	context.m_lastRayMaskWordIndex = -1;
 
-	for (int rayIndex = 0; rayIndex < m_currentNumRaycasts; rayIndex++)
+	context.m_rayTileIndexes.clear();
+	GetAllTileIndexesForRaycastVsGrid(startPos, fwdNormal, maxDistance, context.m_rayTileIndexes);
+	for (int tileIndexIdx = 0; tileIndexIdx < (int)context.m_rayTileIndexes.size(); tileIndexIdx++)
 	{
-		m_rayStartPositions.push_back(g_RNG->RollRandomVec2InBox(AABB2(Vec2::ZERO, Vec2(WORLD_SIZE_X, WORLD_SIZE_Y))));
-		m_rayFwdNormals.push_back(Vec2::MakeFromPolarDegrees(g_RNG->RollRandomFloatInRange(0.f, 360.f)));
-		m_rayMaxDistances.push_back(g_RNG->RollRandomFloatInRange(RAY_MIN_LENGTH, RAY_MAX_LENGTH));
+		int wordIndex = context.m_rayTileIndexes[tileIndexIdx] / 64;
+		context.m_rayBitMask[wordIndex] |= 1ull << (context.m_rayTileIndexes[tileIndexIdx] % 64);
+		context.m_firstRayMaskWordIndex = wordIndex < context.m_firstRayMaskWordIndex ? wordIndex : context.m_firstRayMaskWordIndex;
+		context.m_lastRayMaskWordIndex = wordIndex > context.m_lastRayMaskWordIndex ? wordIndex : context.m_lastRayMaskWordIndex;
 	}
 }
 
-void VisualTestConvexScene::PerformAllTestRaycasts()
+bool VisualTestConvexScene::DoesPolyBitBucketMaskOverlapRayMask(int polyIndex, std::vector<unsigned long long> const& rayBitMask, int firstWordIndex, int lastWordIndex) const
 {
-	m_raycastsPerformedInLastTest = m_currentNumRaycasts;
-	int numHitRays = 0;
-	float totalImpactDistance = 0.f;
-	double raycastStartTimeSeconds = GetCurrentTimeSeconds();
-	for (int rayIndex = 0; rayIndex < m_currentNumRaycasts; rayIndex++)
+	// Only the words the ray touched can overlap; accumulate without branching so the loop vectorizes
+	unsigned long long const* polyBitMask = &m_bitBucketMasks[polyIndex * m_numWordsPerBitBucketMask];
+	unsigned long long overlappingBits = 0ull;
+	for (int wordIndex = firstWordIndex; wordIndex <= lastWordIndex; wordIndex++)
 	{
-		unsigned long long rayBitField = 0ull;
-		float closestImpactDistance = FLT_MAX;
+		overlappingBits |= polyBitMask[wordIndex] & rayBitMask[wordIndex];
+	}
+	return overlappingBits != 0ull;
+}
 
-		if (m_currentOptimizationMode == OptimizationMode::BROAD_PHASE_BIT_BUCKET_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE)
-		{
-			std::vector<unsigned int> rayTileIndexes;
-			GetAllTileIndexesForRaycastVsGrid(m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex], rayTileIndexes);
-			for (int tileIndexIdx = 0; tileIndexIdx < (int)rayTileIndexes.size(); tileIndexIdx++)
+bool VisualTestConvexScene::DoesRayHitNarrowPhaseProxy(NarrowPhaseProxy narrowPhaseProxy, int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance) const
+{
+	// Polys without a proxy are never rejected
+	float entryDistance = 0.f;
+	switch (narrowPhaseProxy)
+	{
+		case NarrowPhaseProxy::LOADED_DISC:		return m_useQuantizedCulling ? m_quantizedScene.DoesRayHitBoundingDisc(startPos, fwdNormal, maxDistance, polyIndex) : m_packedScene.DoesRayHitBoundingDisc(polyIndex, startPos, fwdNormal, maxDistance);
+		case NarrowPhaseProxy::MINIMAL_DISC:	return (int)m_minimalBoundingDiscs.size() <= polyIndex || RaycastVsDisc2D(startPos, fwdNormal, maxDistance, m_minimalBoundingDiscs[polyIndex].m_center, m_minimalBoundingDiscs[polyIndex].m_radius).m_didImpact;
+		case NarrowPhaseProxy::MINIMAL_OBB:		return (int)m_minimalBoundingOBBs.size() <= polyIndex || GetRayEntryDistanceVsOBB2(startPos, fwdNormal, maxDistance, m_minimalBoundingOBBs[polyIndex], entryDistance);
+	}
+
+	return true;
+}
+
+int VisualTestConvexScene::GetRayPacket4LanesHittingNarrowPhaseProxy(NarrowPhaseProxy narrowPhaseProxy, int polyIndex, RayPacket4 const& packet) const
+{
+	int allLanesMask = (1 << RayPacket4::NUM_LANES) - 1;
+	if (narrowPhaseProxy == NarrowPhaseProxy::LOADED_DISC && !m_useQuantizedCulling)
+	{
+		return m_packedScene.GetRayPacket4LanesHittingBoundingDisc(polyIndex, packet);
+	}
+	if (narrowPhaseProxy == NarrowPhaseProxy::MINIMAL_DISC)
+	{
+		return (int)m_minimalBoundingDiscs.size() <= polyIndex ? allLanesMask : GetRayPacket4LanesHittingDisc2D(packet, m_minimalBoundingDiscs[polyIndex].m_center, m_minimalBoundingDiscs[polyIndex].m_radius);
+	}
+
+	// No packet box or quantized disc test yet, so those are tested a lane at a time
+	int hitLaneMask = 0;
+	for (int laneIndex = 0; laneIndex < RayPacket4::NUM_LANES; laneIndex++)
+	{
+		Vec2 startPos(packet.m_startXs[laneIndex], packet.m_startYs[laneIndex]);
+		Vec2 fwdNormal(packet.m_fwdXs[laneIndex], packet.m_fwdYs[laneIndex]);
+		if (DoesRayHitNarrowPhaseProxy(narrowPhaseProxy, polyIndex, startPos, fwdNormal, packet.m_maxDistances[laneIndex]))
+		{
+			hitLaneMask |= 1 << laneIndex;
+		}
+	}
+	return hitLaneMask;
+}
+
+bool VisualTestConvexScene::DoesRayHitQuantizedHullWithCurrentKernel(int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance) const
+{
+	if (m_currentRaycastKernel != RaycastKernel::SCALAR)
+	{
+		return m_quantizedScene.DoesRayHitConvexHull(startPos, fwdNormal, maxDistance, polyIndex);
+	}
+
+	return m_quantizedScene.DoesRayHitConvexHullScalar(startPos, fwdNormal, maxDistance, polyIndex);
+}
+
+int VisualTestConvexScene::GetRayPacket4LanesHittingQuantizedHull(int polyIndex, RayPacket4 const& packet, int laneMask) const
+{
+	// No packet kernel over quantized planes yet, so each lane still in the mask is tested on its own
+	int hitLaneMask = 0;
+	for (int laneIndex = 0; laneIndex < RayPacket4::NUM_LANES; laneIndex++)
+	{
+		if ((laneMask & (1 << laneIndex)) == 0)
+		{
+			continue;
+		}
+		Vec2 startPos(packet.m_startXs[laneIndex], packet.m_startYs[laneIndex]);
+		Vec2 fwdNormal(packet.m_fwdXs[laneIndex], packet.m_fwdYs[laneIndex]);
+		if (DoesRayHitQuantizedHullWithCurrentKernel(polyIndex, startPos, fwdNormal, packet.m_maxDistances[laneIndex]))
+		{
+			hitLaneMask |= 1 << laneIndex;
+		}
+	}
+	return hitLaneMask;
+}
+
+RaycastResult2D VisualTestConvexScene::RaycastVsConvexHullWithCurrentKernel(int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance) const
+{
+	if (m_useQuantizedCulling && !DoesRayHitQuantizedHullWithCurrentKernel(polyIndex, startPos, fwdNormal, maxDistance))
+	{
+		RaycastResult2D result;
+		result.m_rayStartPosition = startPos;
+		result.m_rayForwardNormal = fwdNormal;
+		result.m_rayMaxLength = maxDistance;
+		return result;
+	}
+	if (m_packedScene.GetNumVertexes(polyIndex) >= NUM_MIN_VERTEXES_FOR_LOGARITHMIC_RAYCAST)
+	{
+		return m_packedScene.m_polys.RaycastVsConvexPoly(startPos, fwdNormal, maxDistance, polyIndex);
+	}
+	if (m_currentRaycastKernel != RaycastKernel::SCALAR)
+	{
+		return m_packedScene.m_hulls.RaycastVsConvexHull(startPos, fwdNormal, maxDistance, polyIndex);
+	}
+
+	return m_packedScene.m_hulls.RaycastVsConvexHullScalar(startPos, fwdNormal, maxDistance, polyIndex);
+}
+
+bool VisualTestConvexScene::DoesRayHitConvexHullWithCurrentKernel(int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance) const
+{
+	if (m_useQuantizedCulling && !DoesRayHitQuantizedHullWithCurrentKernel(polyIndex, startPos, fwdNormal, maxDistance))
+	{
+		return false;
+	}
+	if (m_packedScene.GetNumVertexes(polyIndex) >= NUM_MIN_VERTEXES_FOR_LOGARITHMIC_RAYCAST)
+	{
+		return m_packedScene.m_polys.RaycastVsConvexPoly(startPos, fwdNormal, maxDistance, polyIndex).m_didImpact;
+	}
+	if (m_currentRaycastKernel != RaycastKernel::SCALAR)
+	{
+		return m_packedScene.m_hulls.DoesRayHitConvexHull(startPos, fwdNormal, maxDistance, polyIndex);
+	}
+
+	return m_packedScene.m_hulls.DoesRayHitConvexHullScalar(startPos, fwdNormal, maxDistance, polyIndex);
+}
+
+void VisualTestConvexScene::SetBitBucketGridSize(int gridSizeX, int gridSizeY)
+{
+	m_bitBucketGridSizeX = gridSizeX;
+	m_bitBucketGridSizeY = gridSizeY;
+	m_numWordsPerBitBucketMask = (gridSizeX * gridSizeY + 63) / 64;
+	m_bitBucketMasks.clear();
+	m_needToRegenerateBitMasks = true;
+}
+
+void VisualTestConvexScene::GenerateRandomRaycasts()
+{
+	m_rayStartPositions.clear();
+	m_rayFwdNormals.clear();
+	m_rayMaxDistances.clear();
+
+	if (m_generateRayFans)
+	{
+		// Nearly parallel rays from one origin, so consecutive rays stay coherent
+		for (int firstFanRayIndex = 0; firstFanRayIndex < m_currentNumRaycasts; firstFanRayIndex += RAY_FAN_SIZE)
+		{
+			Vec2 fanStartPosition = g_RNG->RollRandomVec2InBox(AABB2(Vec2::ZERO, Vec2(WORLD_SIZE_X, WORLD_SIZE_Y)));
+			float fanCenterDegrees = g_RNG->RollRandomFloatInRange(0.f, 360.f);
+			float fanMaxDistance = g_RNG->RollRandomFloatInRange(RAY_MIN_LENGTH, RAY_MAX_LENGTH);
+			for (int rayIndex = firstFanRayIndex; rayIndex < firstFanRayIndex + RAY_FAN_SIZE && rayIndex < m_currentNumRaycasts; rayIndex++)
+			{
+				float fanFraction = (float)(rayIndex - firstFanRayIndex) / (float)(RAY_FAN_SIZE - 1);
+				m_rayStartPositions.push_back(fanStartPosition);
+				m_rayFwdNormals.push_back(Vec2::MakeFromPolarDegrees(fanCenterDegrees + RAY_FAN_SPREAD_DEGREES * (fanFraction - 0.5f)));
+				m_rayMaxDistances.push_back(fanMaxDistance);
+			}
+		}
+		return;
+	}
+
+	for (int rayIndex = 0; rayIndex < m_currentNumRaycasts; rayIndex++)
+	{
+		m_rayStartPositions.push_back(g_RNG->RollRandomVec2InBox(AABB2(Vec2::ZERO, Vec2(WORLD_SIZE_X, WORLD_SIZE_Y))));
+		m_rayFwdNormals.push_back(Vec2::MakeFromPolarDegrees(g_RNG->RollRandomFloatInRange(0.f, 360.f)));
+		m_rayMaxDistances.push_back(g_RNG->RollRandomFloatInRange(RAY_MIN_LENGTH, RAY_MAX_LENGTH));
+	}
+}
+
+void VisualTestConvexScene::SortTestRaycastsForCoherence()
+{
+	// Rays starting near each other (and, optionally, heading the same way) touch the same bit buckets and hulls
+	AABB2 rayStartBounds(Vec2::ZERO, Vec2(WORLD_SIZE_X, WORLD_SIZE_Y));
+	std::vector<std::pair<uint64_t, int>> sortKeysAndRayIndexes;
+	sortKeysAndRayIndexes.reserve(m_rayStartPositions.size());
+	for (int rayIndex = 0; rayIndex < (int)m_rayStartPositions.size(); rayIndex++)
+	{
+		uint64_t sortKey = GetMortonCodeForPosition(m_rayStartPositions[rayIndex], rayStartBounds);
+		if (m_currentRaySortMode == RaySortMode::MORTON_AND_DIRECTION)
+		{
+			// Octant of the direction, grouped within coarse Morton cells and ahead of the fine Morton bits
+			Vec2 const& fwdNormal = m_rayFwdNormals[rayIndex];
+			uint64_t directionBucket = (fwdNormal.x < 0.f ? 4u : 0u) | (fwdNormal.y < 0.f ? 2u : 0u) | (fabsf(fwdNormal.x) < fabsf(fwdNormal.y) ? 1u : 0u);
+			sortKey = ((sortKey >> RAY_SORT_FINE_MORTON_BITS) << 35) | (directionBucket << 32) | sortKey;
+		}
+		sortKeysAndRayIndexes.push_back(std::make_pair(sortKey, rayIndex));
+	}
+	std::sort(sortKeysAndRayIndexes.begin(), sortKeysAndRayIndexes.end());
+
+	m_raySortPermutation.resize(sortKeysAndRayIndexes.size());
+	m_rayUnsortPermutation.resize(sortKeysAndRayIndexes.size());
+	for (int sortedRayIndex = 0; sortedRayIndex < (int)sortKeysAndRayIndexes.size(); sortedRayIndex++)
+	{
+		m_raySortPermutation[sortedRayIndex] = sortKeysAndRayIndexes[sortedRayIndex].second;
+		m_rayUnsortPermutation[sortKeysAndRayIndexes[sortedRayIndex].second] = sortedRayIndex;
+	}
+	ReorderTestRaycasts(m_raySortPermutation);
+}
+
+void VisualTestConvexScene::ReorderTestRaycasts(std::vector<int> const& sourceRayIndexes)
+{
+	std::vector<Vec2> rayStartPositions(sourceRayIndexes.size());
+	std::vector<Vec2> rayFwdNormals(sourceRayIndexes.size());
+	std::vector<float> rayMaxDistances(sourceRayIndexes.size());
+	for (int rayIndex = 0; rayIndex < (int)sourceRayIndexes.size(); rayIndex++)
+	{
+		rayStartPositions[rayIndex] = m_rayStartPositions[sourceRayIndexes[rayIndex]];
+		rayFwdNormals[rayIndex] = m_rayFwdNormals[sourceRayIndexes[rayIndex]];
+		rayMaxDistances[rayIndex] = m_rayMaxDistances[sourceRayIndexes[rayIndex]];
+	}
+	m_rayStartPositions.swap(rayStartPositions);
+	m_rayFwdNormals.swap(rayFwdNormals);
+	m_rayMaxDistances.swap(rayMaxDistances);
+}
+
+void VisualTestConvexScene::PerformAllTestRaycasts()
+{
+	m_raycastsPerformedInLastTest = m_currentNumRaycasts;
+	m_raycastThreadBusyTimesMs.clear();
+	m_numRaycastChunksStolenInLastTest = 0;
+
+	PrepareRaycastQueryContexts();
+
+	// Timed once per generated batch, before the sort, while the rays are still in generation order
+	m_unsortedRaycastTimeMs = -1.0;
+	if (m_currentRaySortMode != RaySortMode::NONE)
+	{
+		MeasureUnsortedRaycastTime();
+	}
+
+	// The sort is timed separately so the HUD can weigh it against what it saves
+	m_raySortPermutation.clear();
+	m_rayUnsortPermutation.clear();
+	m_raySortTimeMs = -1.0;
+	if (m_currentRaySortMode != RaySortMode::NONE)
+	{
+		double sortStartTimeSeconds = GetCurrentTimeSeconds();
+		SortTestRaycastsForCoherence();
+		m_raySortTimeMs = (GetCurrentTimeSeconds() - sortStartTimeSeconds) * 1000.0;
+	}
+
+	RaycastTestTotals totals;
+	m_totalRaycastTimeMs = RunTimedTestRaycasts(totals);
+	m_numHeapAllocationsInLastTest = totals.m_numHeapAllocations;
+#if defined(TRACK_HEAP_ALLOCATIONS)
+	ASSERT_RECOVERABLE(m_numHeapAllocationsInLastTest == 0, Stringf("Timed raycast batch made %lld heap allocations", m_numHeapAllocationsInLastTest));
+#endif
+	m_averageRaycastImpactDistance = (float)(totals.m_totalImpactDistance / (double)totals.m_numHitRays);
+	m_numHitRaysInLastTest = totals.m_numHitRays;
+	m_lastTestUsedOcclusionQueries = m_useOcclusionQueries;
+	if (m_useOcclusionQueries)
+	{
+		m_occlusionRaycastsPerMs = (double)m_currentNumRaycasts / m_totalRaycastTimeMs;
+	}
+	else
+	{
+		m_closestHitRaycastsPerMs = (double)m_currentNumRaycasts / m_totalRaycastTimeMs;
+	}
+	m_numHullTestsInLastTest = totals.m_numHullTests;
+	m_numNodesVisitedInLastTest = m_currentOptimizationMode == OptimizationMode::BSP2_TREE ? (int)totals.m_numNodesVisited : -1;
+	if (m_useMultithreadedRaycasts)
+	{
+		for (int threadIndex = 0; threadIndex < m_raycastThreadPool.GetNumThreads(); threadIndex++)
+		{
+			m_raycastThreadBusyTimesMs.push_back(m_raycastThreadPool.GetThreadBusyTimeMs(threadIndex));
+		}
+		m_numRaycastChunksStolenInLastTest = m_raycastThreadPool.GetNumChunksStolenInLastRun();
+	}
+
+	// Untimed, so the comparison does not skew the timing of the selected mode
+	m_numNarrowAndBroadPhaseHullTestsInLastTest = -1;
+	if (IsAccelerationStructureMode(m_currentOptimizationMode))
+	{
+		m_numNarrowAndBroadPhaseHullTestsInLastTest = CountHullTestsForNarrowAndBroadPhase();
+	}
+
+	for (int treeIndex = 0; treeIndex < 3; treeIndex++)
+	{
+		m_singleVolumeTreeRaycastTimesMs[treeIndex] = -1.0;
+	}
+	if (m_currentOptimizationMode == OptimizationMode::BVH_COMPOSITE_TREE)
+	{
+		MeasureSingleVolumeTreeRaycastTimes();
+	}
+
+	m_tiledBitRegionsRaycastTimeMs = -1.0;
+	if (m_currentOptimizationMode == OptimizationMode::COLUMN_ROW_BIT_REGIONS || m_currentOptimizationMode == OptimizationMode::HIERARCHICAL_BIT_BUCKETS)
+	{
+		MeasureTiledBitRegionsRaycastTime();
+	}
+
+	for (int proxyIndex = 0; proxyIndex < (int)NarrowPhaseProxy::NUM; proxyIndex++)
+	{
+		m_narrowPhaseRejectionRates[proxyIndex] = -1.f;
+	}
+	if (m_currentOptimizationMode == OptimizationMode::NARROW_PHASE_BOUNDING_DISC_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE)
+	{
+		MeasureNarrowPhaseRejectionRates();
+	}
+}
+
+void VisualTestConvexScene::PrepareRaycastQueryContexts()
+{
+	// A grid walk enters at most one new column or row per step
+	int maxNumTilesPerRay = m_bitBucketGridSizeX + m_bitBucketGridSizeY;
+	m_raycastQueryContexts.resize(m_raycastThreadPool.GetNumThreads());
+	for (int contextIndex = 0; contextIndex < (int)m_raycastQueryContexts.size(); contextIndex++)
+	{
+		m_raycastQueryContexts[contextIndex].Reserve(m_numWordsPerBitBucketMask, maxNumTilesPerRay, m_currentNumPolys);
+	}
+
+	m_raycastThreadTotals.assign(m_raycastThreadPool.GetNumThreads(), RaycastTestTotals());
+}
+
+double VisualTestConvexScene::RunTimedTestRaycasts(RaycastTestTotals& out_totals)
+{
+	for (int threadIndex = 0; threadIndex < (int)m_raycastThreadTotals.size(); threadIndex++)
+	{
+		m_raycastThreadTotals[threadIndex] = RaycastTestTotals();
+	}
+
+	double raycastStartTimeSeconds = GetCurrentTimeSeconds();
+	if (m_useMultithreadedRaycasts)
+	{
+		// Each thread sums into its own totals; merging them afterwards gives the same counts as a serial run
+		m_raycastThreadPool.ParallelFor(m_currentNumRaycasts, RAYCAST_CHUNK_SIZE, [this](int threadIndex, int firstRayIndex, int endRayIndex)
+		{
+			long long numHeapAllocationsBeforeChunk = GetNumHeapAllocationsOnThisThread();
+			PerformTestRaycastsForRange(firstRayIndex, endRayIndex, m_raycastQueryContexts[threadIndex], m_raycastThreadTotals[threadIndex]);
+			m_raycastThreadTotals[threadIndex].m_numHeapAllocations += GetNumHeapAllocationsOnThisThread() - numHeapAllocationsBeforeChunk;
+		});
+		for (int threadIndex = 0; threadIndex < (int)m_raycastThreadTotals.size(); threadIndex++)
+		{
+			out_totals.Merge(m_raycastThreadTotals[threadIndex]);
+		}
+	}
+	else
+	{
+		long long numHeapAllocationsBeforeTest = GetNumHeapAllocationsOnThisThread();
+		PerformTestRaycastsForRange(0, m_currentNumRaycasts, m_raycastQueryContexts[0], out_totals);
+		out_totals.m_numHeapAllocations += GetNumHeapAllocationsOnThisThread() - numHeapAllocationsBeforeTest;
+	}
+	double raycastEndTimeSeconds = GetCurrentTimeSeconds();
+
+	return (raycastEndTimeSeconds - raycastStartTimeSeconds) * 1000.0;
+}
+
+void VisualTestConvexScene::PerformTestRaycastsForRange(int firstRayIndex, int endRayIndex, RaycastQueryContext& context, RaycastTestTotals& inout_totals) const
+{
+	if (m_useOcclusionQueries)
+	{
+		PerformTestOcclusionRaycastsForRange(firstRayIndex, endRayIndex, context, inout_totals);
+		return;
+	}
+
+	// Packets share one candidate list across four rays, so front-to-back ordering always traces single rays
+	if (m_currentRaycastKernel == RaycastKernel::SIMD_RAY_PACKETS && !m_useFrontToBackHullOrder && !IsAccelerationStructureMode(m_currentOptimizationMode))
+	{
+		PerformTestRaycastsInPacketsForRange(firstRayIndex, endRayIndex, context, inout_totals);
+		return;
+	}
+
+	// Ordering uses the minimal discs since they are always generated and are never looser than the loaded ones
+	std::vector<BoundingDisc> const& orderingDiscs = m_minimalBoundingDiscs.empty() ? m_boundingDiscs : m_minimalBoundingDiscs;
+	auto isFartherCandidate = [](HullCandidate const& candidateA, HullCandidate const& candidateB) { return candidateA.m_entryDistance > candidateB.m_entryDistance; };
+	HullRaycastFunction raycastVsHull = [this](int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance)
+	{
+		return RaycastVsConvexHullWithCurrentKernel(polyIndex, startPos, fwdNormal, maxDistance);
+	};
+
+	for (int rayIndex = firstRayIndex; rayIndex < endRayIndex; rayIndex++)
+	{
+		float closestImpactDistance = FLT_MAX;
+
+		if (IsAccelerationStructureMode(m_currentOptimizationMode))
+		{
+			int numHullTests = 0;
+			int numNodesVisited = 0;
+			RaycastResult2D raycastVsAccelerationStructureResult = RaycastVsAccelerationStructure(m_currentOptimizationMode, m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex], raycastVsHull, context, numHullTests, numNodesVisited);
+			inout_totals.m_numHullTests += numHullTests;
+			inout_totals.m_numNodesVisited += numNodesVisited;
+			if (raycastVsAccelerationStructureResult.m_didImpact)
 			{
-				rayBitField |= 1ull << rayTileIndexes[tileIndexIdx];
+				inout_totals.m_totalImpactDistance += raycastVsAccelerationStructureResult.m_impactDistance;
+				inout_totals.m_numHitRays++;
 			}
+			continue;
+		}
+
+		if (m_currentOptimizationMode == OptimizationMode::BROAD_PHASE_BIT_BUCKET_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE)
+		{
+			GetBitBucketMaskForRaycast(m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex], context);
 		}
 
+		context.m_hullCandidates.clear();
 		for (int polyIndex = 0; polyIndex < m_currentNumPolys; polyIndex++)
 		{
 			if (m_currentOptimizationMode == OptimizationMode::BROAD_PHASE_BIT_BUCKET_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE)
 			{
-				if ((m_bitBucketMasks[polyIndex] & rayBitField) == 0)
+				if (!DoesPolyBitBucketMaskOverlapRayMask(polyIndex, context.m_rayBitMask, context.m_firstRayMaskWordIndex, context.m_lastRayMaskWordIndex))
 				{
 					continue;
 				}
 			}
 
-			if (m_boundingDiscs.size() > polyIndex && (m_currentOptimizationMode == OptimizationMode::NARROW_PHASE_BOUNDING_DISC_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE))
+			if (m_currentOptimizationMode == OptimizationMode::NARROW_PHASE_BOUNDING_DISC_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE)
 			{
-				RaycastResult2D raycastVsDiscResult = RaycastVsDisc2D(m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex], m_boundingDiscs[polyIndex].m_center, m_boundingDiscs[polyIndex].m_radius);
-				if (!raycastVsDiscResult.m_didImpact)
+				if (!DoesRayHitNarrowPhaseProxy(m_currentNarrowPhaseProxy, polyIndex, m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex]))
 				{
 					continue;
 				}
 			}
 
-			RaycastResult2D raycastVsConvexHullResult = RaycastVsConvexHull2(m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex], m_convexHulls[polyIndex]);
+			if (m_useFrontToBackHullOrder)
+			{
+				HullCandidate candidate;
+				candidate.m_polyIndex = polyIndex;
+				if ((int)orderingDiscs.size() > polyIndex)
+				{
+					RaycastResult2D raycastVsDiscResult = RaycastVsDisc2D(m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex], orderingDiscs[polyIndex].m_center, orderingDiscs[polyIndex].m_radius);
+					if (!raycastVsDiscResult.m_didImpact)
+					{
+						continue;
+					}
+					candidate.m_entryDistance = raycastVsDiscResult.m_impactDistance;
+				}
+				context.m_hullCandidates.push_back(candidate);
+				continue;
+			}
+
+			inout_totals.m_numHullTests++;
+			RaycastResult2D raycastVsConvexHullResult = RaycastVsConvexHullWithCurrentKernel(polyIndex, m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex]);
+			if (raycastVsConvexHullResult.m_didImpact && raycastVsConvexHullResult.m_impactDistance < closestImpactDistance)
+			{
+				closestImpactDistance = raycastVsConvexHullResult.m_impactDistance;
+			}
+		}
+
+		// No hull can be hit before the ray enters its bounding disc, so once the nearest remaining disc is
+		// farther than the best confirmed hit, nothing left can improve on it
+		std::vector<HullCandidate>& candidates = context.m_hullCandidates;
+		std::make_heap(candidates.begin(), candidates.end(), isFartherCandidate);
+		while (!candidates.empty() && candidates.front().m_entryDistance < closestImpactDistance)
+		{
+			int polyIndex = candidates.front().m_polyIndex;
+			std::pop_heap(candidates.begin(), candidates.end(), isFartherCandidate);
+			candidates.pop_back();
+
+			inout_totals.m_numHullTests++;
+			RaycastResult2D raycastVsConvexHullResult = RaycastVsConvexHullWithCurrentKernel(polyIndex, m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex]);
 			if (raycastVsConvexHullResult.m_didImpact && raycastVsConvexHullResult.m_impactDistance < closestImpactDistance)
 			{
 				closestImpactDistance = raycastVsConvexHullResult.m_impactDistance;
@@ -772,42 +1661,419 @@ void VisualTestConvexScene::PerformAllTestRaycasts()
 
 		if (closestImpactDistance != FLT_MAX)
 		{
-			totalImpactDistance += closestImpactDistance;
-			numHitRays++;
+			inout_totals.m_totalImpactDistance += closestImpactDistance;
+			inout_totals.m_numHitRays++;
 		}
 	}
-	double raycastEndTimeSeconds = GetCurrentTimeSeconds();
-	m_totalRaycastTimeMs = (raycastEndTimeSeconds - raycastStartTimeSeconds) * 1000.f;
-	m_averageRaycastImpactDistance = totalImpactDistance / (float)numHitRays;
+}
+
+void VisualTestConvexScene::PerformTestRaycastsInPacketsForRange(int firstRayIndex, int endRayIndex, RaycastQueryContext& context, RaycastTestTotals& inout_totals) const
+{
+	bool useBitBuckets = m_currentOptimizationMode == OptimizationMode::BROAD_PHASE_BIT_BUCKET_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE;
+	bool useNarrowPhase = m_currentOptimizationMode == OptimizationMode::NARROW_PHASE_BOUNDING_DISC_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE;
+
+	for (int firstPacketRayIndex = firstRayIndex; firstPacketRayIndex < endRayIndex; firstPacketRayIndex += RayPacket4::NUM_LANES)
+	{
+		// Lanes past the last ray repeat it and stay masked off
+		RayPacket4 packet;
+		int numRaysInPacket = endRayIndex - firstPacketRayIndex < RayPacket4::NUM_LANES ? endRayIndex - firstPacketRayIndex : RayPacket4::NUM_LANES;
+		int activeLaneMask = (1 << numRaysInPacket) - 1;
+		for (int laneIndex = 0; laneIndex < RayPacket4::NUM_LANES; laneIndex++)
+		{
+			int rayIndex = firstPacketRayIndex + (laneIndex < numRaysInPacket ? laneIndex : numRaysInPacket - 1);
+			packet.SetRay(laneIndex, m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex]);
+		}
+
+		// The packet's broad phase mask is the union of its rays' masks
+		int firstPacketMaskWordIndex = m_numWordsPerBitBucketMask;
+		int lastPacketMaskWordIndex = -1;
+		if (useBitBuckets)
+		{
+			context.m_packetBitMask.assign(m_numWordsPerBitBucketMask, 0ull);
+			for (int laneIndex = 0; laneIndex < numRaysInPacket; laneIndex++)
+			{
+				int rayIndex = firstPacketRayIndex + laneIndex;
+				GetBitBucketMaskForRaycast(m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex], context);
+				for (int wordIndex = context.m_firstRayMaskWordIndex; wordIndex <= context.m_lastRayMaskWordIndex; wordIndex++)
+				{
+					context.m_packetBitMask[wordIndex] |= context.m_rayBitMask[wordIndex];
+				}
+				firstPacketMaskWordIndex = context.m_firstRayMaskWordIndex < firstPacketMaskWordIndex ? context.m_firstRayMaskWordIndex : firstPacketMaskWordIndex;
+				lastPacketMaskWordIndex = context.m_lastRayMaskWordIndex > lastPacketMaskWordIndex ? context.m_lastRayMaskWordIndex : lastPacketMaskWordIndex;
+			}
+		}
+
+		alignas(16) float closestImpactDistances[RayPacket4::NUM_LANES] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+		for (int polyIndex = 0; polyIndex < m_currentNumPolys; polyIndex++)
+		{
+			if (useBitBuckets && !DoesPolyBitBucketMaskOverlapRayMask(polyIndex, context.m_packetBitMask, firstPacketMaskWordIndex, lastPacketMaskWordIndex))
+			{
+				continue;
+			}
+
+			int polyLaneMask = activeLaneMask;
+			if (useNarrowPhase)
+			{
+				polyLaneMask &= GetRayPacket4LanesHittingNarrowPhaseProxy(m_currentNarrowPhaseProxy, polyIndex, packet);
+				if (polyLaneMask == 0)
+				{
+					continue;
+				}
+			}
+
+			// Counted before quantized culling, like the single ray hull tests
+			for (int laneIndex = 0; laneIndex < RayPacket4::NUM_LANES; laneIndex++)
+			{
+				inout_totals.m_numHullTests += (polyLaneMask >> laneIndex) & 1;
+			}
+			if (m_useQuantizedCulling)
+			{
+				polyLaneMask = GetRayPacket4LanesHittingQuantizedHull(polyIndex, packet, polyLaneMask);
+				if (polyLaneMask == 0)
+				{
+					continue;
+				}
+			}
+
+			// High vertex count polys take the logarithmic test a lane at a time, as single rays do
+			if (m_packedScene.GetNumVertexes(polyIndex) >= NUM_MIN_VERTEXES_FOR_LOGARITHMIC_RAYCAST)
+			{
+				for (int laneIndex = 0; laneIndex < RayPacket4::NUM_LANES; laneIndex++)
+				{
+					if ((polyLaneMask & (1 << laneIndex)) == 0)
+					{
+						continue;
+					}
+					Vec2 startPos(packet.m_startXs[laneIndex], packet.m_startYs[laneIndex]);
+					Vec2 fwdNormal(packet.m_fwdXs[laneIndex], packet.m_fwdYs[laneIndex]);
+					RaycastResult2D raycastVsConvexPolyResult = m_packedScene.m_polys.RaycastVsConvexPoly(startPos, fwdNormal, packet.m_maxDistances[laneIndex], polyIndex);
+					if (raycastVsConvexPolyResult.m_didImpact && raycastVsConvexPolyResult.m_impactDistance < closestImpactDistances[laneIndex])
+					{
+						closestImpactDistances[laneIndex] = raycastVsConvexPolyResult.m_impactDistance;
+					}
+				}
+				continue;
+			}
+			m_packedScene.m_hulls.RaycastPacketVsConvexHull(packet, polyLaneMask, polyIndex, closestImpactDistances);
+		}
+
+		for (int laneIndex = 0; laneIndex < numRaysInPacket; laneIndex++)
+		{
+			if (closestImpactDistances[laneIndex] != FLT_MAX)
+			{
+				inout_totals.m_totalImpactDistance += closestImpactDistances[laneIndex];
+				inout_totals.m_numHitRays++;
+			}
+		}
+	}
+}
+
+void VisualTestConvexScene::PerformTestOcclusionRaycastsForRange(int firstRayIndex, int endRayIndex, RaycastQueryContext& context, RaycastTestTotals& inout_totals) const
+{
+	bool useBitBuckets = m_currentOptimizationMode == OptimizationMode::BROAD_PHASE_BIT_BUCKET_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE;
+	bool useNarrowPhase = m_currentOptimizationMode == OptimizationMode::NARROW_PHASE_BOUNDING_DISC_ONLY || m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE;
+
+	// Acceleration structures stop at the first hull this reports a hit on; the impact distance is never read
+	HullRaycastFunction doesRayHitHull = [this](int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance)
+	{
+		RaycastResult2D result;
+		result.m_rayStartPosition = startPos;
+		result.m_rayForwardNormal = fwdNormal;
+		result.m_rayMaxLength = maxDistance;
+		result.m_didImpact = DoesRayHitConvexHullWithCurrentKernel(polyIndex, startPos, fwdNormal, maxDistance);
+		return result;
+	};
+
+	for (int rayIndex = firstRayIndex; rayIndex < endRayIndex; rayIndex++)
+	{
+		Vec2 const& startPos = m_rayStartPositions[rayIndex];
+		Vec2 const& fwdNormal = m_rayFwdNormals[rayIndex];
+		float maxDistance = m_rayMaxDistances[rayIndex];
+
+		if (IsAccelerationStructureMode(m_currentOptimizationMode))
+		{
+			int numHullTests = 0;
+			int numNodesVisited = 0;
+			RaycastResult2D raycastVsAccelerationStructureResult = RaycastVsAccelerationStructure(m_currentOptimizationMode, startPos, fwdNormal, maxDistance, doesRayHitHull, context, numHullTests, numNodesVisited, true);
+			inout_totals.m_numHullTests += numHullTests;
+			inout_totals.m_numNodesVisited += numNodesVisited;
+			if (raycastVsAccelerationStructureResult.m_didImpact)
+			{
+				inout_totals.m_numHitRays++;
+			}
+			continue;
+		}
+
+		if (useBitBuckets)
+		{
+			GetBitBucketMaskForRaycast(startPos, fwdNormal, maxDistance, context);
+		}
+
+		for (int polyIndex = 0; polyIndex < m_currentNumPolys; polyIndex++)
+		{
+			if (useBitBuckets && !DoesPolyBitBucketMaskOverlapRayMask(polyIndex, context.m_rayBitMask, context.m_firstRayMaskWordIndex, context.m_lastRayMaskWordIndex))
+			{
+				continue;
+			}
+			if (useNarrowPhase && !DoesRayHitNarrowPhaseProxy(m_currentNarrowPhaseProxy, polyIndex, startPos, fwdNormal, maxDistance))
+			{
+				continue;
+			}
+
+			inout_totals.m_numHullTests++;
+			if (DoesRayHitConvexHullWithCurrentKernel(polyIndex, startPos, fwdNormal, maxDistance))
+			{
+				inout_totals.m_numHitRays++;
+				break;
+			}
+		}
+	}
+}
+
+void VisualTestConvexScene::MeasureUnsortedRaycastTime()
+{
+	// Runs before the sort, so the rays are already in generation order and nothing has to be reordered
+	RaycastTestTotals unsortedTotals;
+	m_unsortedRaycastTimeMs = RunTimedTestRaycasts(unsortedTotals);
+}
+
+void VisualTestConvexScene::MeasureSingleVolumeTreeRaycastTimes()
+{
+	if (m_aabb2Tree.IsEmpty() || m_needToRegenerateAABB2Tree)
+	{
+		GenerateAABB2Tree();
+	}
+	if (m_obb2Tree.IsEmpty() || m_needToRegenerateOBB2Tree)
+	{
+		GenerateOBB2Tree();
+	}
+	if (m_disc2Tree.IsEmpty() || m_needToRegenerateDisc2Tree)
+	{
+		GenerateDisc2Tree();
+	}
+
+	// Timed through the same path as the composite tree, so the thread and kernel settings match
+	OptimizationMode const singleVolumeTreeModes[3] = { OptimizationMode::BVH_AABB2_TREE, OptimizationMode::BVH_OBB2_TREE, OptimizationMode::BVH_DISC2_TREE };
+	OptimizationMode testedOptimizationMode = m_currentOptimizationMode;
+	for (int treeIndex = 0; treeIndex < 3; treeIndex++)
+	{
+		m_currentOptimizationMode = singleVolumeTreeModes[treeIndex];
+		RaycastTestTotals singleVolumeTreeTotals;
+		m_singleVolumeTreeRaycastTimesMs[treeIndex] = RunTimedTestRaycasts(singleVolumeTreeTotals);
+	}
+	m_currentOptimizationMode = testedOptimizationMode;
+}
+
+void VisualTestConvexScene::MeasureTiledBitRegionsRaycastTime()
+{
+	// The baseline is always the default 8x8 grid, timed through the same path and settings as the tested structure
+	int testedGridSizeX = m_bitBucketGridSizeX;
+	int testedGridSizeY = m_bitBucketGridSizeY;
+	bool isTestedGridDefault = testedGridSizeX == DEFAULT_BIT_BUCKET_GRID_SIZE_X && testedGridSizeY == DEFAULT_BIT_BUCKET_GRID_SIZE_Y;
+	if (!isTestedGridDefault)
+	{
+		SetBitBucketGridSize(DEFAULT_BIT_BUCKET_GRID_SIZE_X, DEFAULT_BIT_BUCKET_GRID_SIZE_Y);
+	}
+	if (m_bitBucketMasks.empty() || m_needToRegenerateBitMasks)
+	{
+		GenerateBitMasksForAllPolys();
+	}
+	PrepareRaycastQueryContexts();
+
+	OptimizationMode testedOptimizationMode = m_currentOptimizationMode;
+	m_currentOptimizationMode = OptimizationMode::BROAD_PHASE_BIT_BUCKET_ONLY;
+	RaycastTestTotals tiledBitRegionsTotals;
+	m_tiledBitRegionsRaycastTimeMs = RunTimedTestRaycasts(tiledBitRegionsTotals);
+	m_currentOptimizationMode = testedOptimizationMode;
+
+	if (!isTestedGridDefault)
+	{
+		SetBitBucketGridSize(testedGridSizeX, testedGridSizeY);
+	}
+}
+
+void VisualTestConvexScene::MeasureNarrowPhaseRejectionRates()
+{
+	if (m_minimalBoundingDiscs.empty() || m_needToRegenerateMinimalBoundingVolumes)
+	{
+		GenerateMinimalBoundingVolumesForAllPolys();
+	}
+
+	// Every proxy sees the same candidates: all polys, or those that pass the broad phase when it is on. A sample of the rays is plenty for a rate.
+	bool useBitBuckets = m_currentOptimizationMode == OptimizationMode::NARROW_AND_BROAD_PHASE;
+	RaycastQueryContext& context = m_raycastQueryContexts[0];
+	long long numCandidates = 0;
+	long long numRejections[(int)NarrowPhaseProxy::NUM] = {};
+	int numSampleRays = m_currentNumRaycasts < NUM_MAX_REJECTION_RATE_SAMPLE_RAYS ? m_currentNumRaycasts : NUM_MAX_REJECTION_RATE_SAMPLE_RAYS;
+	for (int rayIndex = 0; rayIndex < numSampleRays; rayIndex++)
+	{
+		if (useBitBuckets)
+		{
+			GetBitBucketMaskForRaycast(m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex], context);
+		}
+
+		for (int polyIndex = 0; polyIndex < m_currentNumPolys; polyIndex++)
+		{
+			if (useBitBuckets && !DoesPolyBitBucketMaskOverlapRayMask(polyIndex, context.m_rayBitMask, context.m_firstRayMaskWordIndex, context.m_lastRayMaskWordIndex))
+			{
+				continue;
+			}
+
+			numCandidates++;
+			for (int proxyIndex = 0; proxyIndex < (int)NarrowPhaseProxy::NUM; proxyIndex++)
+			{
+				if (!DoesRayHitNarrowPhaseProxy(NarrowPhaseProxy(proxyIndex), polyIndex, m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex]))
+				{
+					numRejections[proxyIndex]++;
+				}
+			}
+		}
+	}
+
+	for (int proxyIndex = 0; proxyIndex < (int)NarrowPhaseProxy::NUM; proxyIndex++)
+	{
+		m_narrowPhaseRejectionRates[proxyIndex] = numCandidates > 0 ? (float)((double)numRejections[proxyIndex] / (double)numCandidates) : 0.f;
+	}
+}
+
+RaycastResult2D VisualTestConvexScene::RaycastVsAccelerationStructure(OptimizationMode optimizationMode, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, RaycastQueryContext& context, int& out_numHullTests, int& out_numNodesVisited, bool stopAtFirstHit) const
+{
+	switch (optimizationMode)
+	{
+		case OptimizationMode::BVH_AABB2_TREE:		return m_aabb2Tree.RaycastVsConvexHulls(startPos, fwdNormal, maxDistance, raycastVsHull, out_numHullTests, stopAtFirstHit);
+		case OptimizationMode::BVH_OBB2_TREE:		return m_obb2Tree.RaycastVsConvexHulls(startPos, fwdNormal, maxDistance, raycastVsHull, out_numHullTests, stopAtFirstHit);
+		case OptimizationMode::BVH_DISC2_TREE:		return m_disc2Tree.RaycastVsConvexHulls(startPos, fwdNormal, maxDistance, raycastVsHull, out_numHullTests, stopAtFirstHit);
+		case OptimizationMode::BVH_CONVEX_HULL_TREE:	return m_convexHull2Tree.RaycastVsConvexHulls(startPos, fwdNormal, maxDistance, raycastVsHull, out_numHullTests, stopAtFirstHit);
+		case OptimizationMode::BVH_COMPOSITE_TREE:	return m_compositeTree.RaycastVsConvexHulls(startPos, fwdNormal, maxDistance, raycastVsHull, out_numHullTests, stopAtFirstHit);
+		case OptimizationMode::ASYMMETRIC_QUADTREE:	return m_asymmetricQuadtree.RaycastVsConvexHulls(startPos, fwdNormal, maxDistance, raycastVsHull, out_numHullTests, stopAtFirstHit);
+		case OptimizationMode::SYMMETRIC_QUADTREE:	return m_symmetricQuadtree.RaycastVsConvexHulls(startPos, fwdNormal, maxDistance, raycastVsHull, out_numHullTests, stopAtFirstHit);
+		case OptimizationMode::COLUMN_ROW_BIT_REGIONS:	return m_columnRowBitRegions.RaycastVsConvexHulls(startPos, fwdNormal, maxDistance, raycastVsHull, context.m_candidatePolyMask, out_numHullTests, stopAtFirstHit);
+		case OptimizationMode::BSP2_TREE:			return m_bsp2Tree.RaycastVsConvexHulls(startPos, fwdNormal, maxDistance, raycastVsHull, out_numHullTests, out_numNodesVisited, stopAtFirstHit);
+		case OptimizationMode::HIERARCHICAL_BIT_BUCKETS:	return m_hierarchicalBitBuckets.RaycastVsConvexHulls(startPos, fwdNormal, maxDistance, raycastVsHull, out_numHullTests, stopAtFirstHit);
+	}
+
+	return RaycastResult2D();
+}
+
+long long VisualTestConvexScene::CountHullTestsForNarrowAndBroadPhase()
+{
+	if (m_bitBucketMasks.empty() || m_needToRegenerateBitMasks)
+	{
+		GenerateBitMasksForAllPolys();
+	}
+
+	if (m_minimalBoundingDiscs.empty() || m_needToRegenerateMinimalBoundingVolumes)
+	{
+		GenerateMinimalBoundingVolumesForAllPolys();
+	}
+
+	// Counted over an evenly spaced sample of the batch and scaled up, since a full rays x polys pass would cost more than the timed batch
+	long long numHullTests = 0;
+	RaycastQueryContext& context = m_raycastQueryContexts[0];
+	int numSampleRays = m_currentNumRaycasts < NUM_MAX_REJECTION_RATE_SAMPLE_RAYS ? m_currentNumRaycasts : NUM_MAX_REJECTION_RATE_SAMPLE_RAYS;
+	for (int sampleIndex = 0; sampleIndex < numSampleRays; sampleIndex++)
+	{
+		int rayIndex = (int)((long long)sampleIndex * m_currentNumRaycasts / numSampleRays);
+		GetBitBucketMaskForRaycast(m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex], context);
+
+		for (int polyIndex = 0; polyIndex < m_currentNumPolys; polyIndex++)
+		{
+			if (!DoesPolyBitBucketMaskOverlapRayMask(polyIndex, context.m_rayBitMask, context.m_firstRayMaskWordIndex, context.m_lastRayMaskWordIndex))
+			{
+				continue;
+			}
+			if (!DoesRayHitNarrowPhaseProxy(m_currentNarrowPhaseProxy, polyIndex, m_rayStartPositions[rayIndex], m_rayFwdNormals[rayIndex], m_rayMaxDistances[rayIndex]))
+			{
+				continue;
+			}
+			numHullTests++;
+		}
+	}
+
+	if (numSampleRays == 0)
+	{
+		return 0;
+	}
+	return numHullTests * m_currentNumRaycasts / numSampleRays;
 }
 
 int VisualTestConvexScene::GetTileIndexForWorldPosition(Vec2 const& worldPosition) const
 {
-	IntVec2 tileCoords(int(worldPosition.x * (float)BIT_BUCKET_GRID_SIZE_X / WORLD_SIZE_X), int(worldPosition.y * (float)BIT_BUCKET_GRID_SIZE_Y / WORLD_SIZE_Y));
-	int tileIndex = tileCoords.x + tileCoords.y * BIT_BUCKET_GRID_SIZE_X;
+	IntVec2 tileCoords(int(worldPosition.x * (float)m_bitBucketGridSizeX / WORLD_SIZE_X), int(worldPosition.y * (float)m_bitBucketGridSizeY / WORLD_SIZE_Y));
+	int tileIndex = tileCoords.x + tileCoords.y * m_bitBucketGridSizeX;
 	return tileIndex;
 }
 
 IntVec2 const VisualTestConvexScene::GetTileCoordsForWorldPosition(Vec2 const& worldPosition) const
 {
-	return IntVec2(int(worldPosition.x * (float)BIT_BUCKET_GRID_SIZE_X / WORLD_SIZE_X), int(worldPosition.y * (float)BIT_BUCKET_GRID_SIZE_Y / WORLD_SIZE_Y));
+	return IntVec2(int(worldPosition.x * (float)m_bitBucketGridSizeX / WORLD_SIZE_X), int(worldPosition.y * (float)m_bitBucketGridSizeY / WORLD_SIZE_Y));
 
 }
 
 Vec2 const VisualTestConvexScene::GetWorldPositionForTileIndex(int tileIndex) const
 {
 	IntVec2 tileCoords = GetTileCoordsFromIndex(tileIndex);
-	return Vec2((float)tileCoords.x * WORLD_SIZE_X / (float)BIT_BUCKET_GRID_SIZE_X, (float)tileCoords.y * WORLD_SIZE_Y / (float)BIT_BUCKET_GRID_SIZE_Y);
+	return Vec2((float)tileCoords.x * WORLD_SIZE_X / (float)m_bitBucketGridSizeX, (float)tileCoords.y * WORLD_SIZE_Y / (float)m_bitBucketGridSizeY);
 }
 
 int VisualTestConvexScene::GetTileIndexForTileCoords(IntVec2 const& tileCoords) const
 {
-	return tileCoords.x + tileCoords.y * BIT_BUCKET_GRID_SIZE_X;
+	return tileCoords.x + tileCoords.y * m_bitBucketGridSizeX;
 }
 
 IntVec2 const VisualTestConvexScene::GetTileCoordsFromIndex(int tileIndex) const
 {
-	return IntVec2(tileIndex % BIT_BUCKET_GRID_SIZE_X, tileIndex / BIT_BUCKET_GRID_SIZE_X);
+	return IntVec2(tileIndex % m_bitBucketGridSizeX, tileIndex / m_bitBucketGridSizeX);
+}
+
+bool IsAccelerationStructureMode(OptimizationMode optimizationMode)
+{
+	return (int)optimizationMode > (int)OptimizationMode::NARROW_AND_BROAD_PHASE && optimizationMode != OptimizationMode::NUM;
+}
+
+void RaycastTestTotals::Merge(RaycastTestTotals const& totals)
+{
+	m_numHitRays += totals.m_numHitRays;
+	m_numHullTests += totals.m_numHullTests;
+	m_numNodesVisited += totals.m_numNodesVisited;
+	m_totalImpactDistance += totals.m_totalImpactDistance;
+	m_numHeapAllocations += totals.m_numHeapAllocations;
+}
+
+std::string GetRaycastKernelStr(RaycastKernel raycastKernel)
+{
+	switch (raycastKernel)
+	{
+		case RaycastKernel::SCALAR:				return "Scalar";				break;
+		case RaycastKernel::SIMD_PLANES:		return "SIMD (4 planes)";		break;
+		case RaycastKernel::SIMD_RAY_PACKETS:	return "SIMD (4 ray packets)";	break;
+	}
+
+	return "";
+}
+
+std::string GetRaySortModeStr(RaySortMode raySortMode)
+{
+	switch (raySortMode)
+	{
+		case RaySortMode::NONE:						return "None";					break;
+		case RaySortMode::MORTON:					return "Morton";				break;
+		case RaySortMode::MORTON_AND_DIRECTION:		return "Morton + Direction";	break;
+	}
+
+	return "";
+}
+
+std::string GetNarrowPhaseProxyStr(NarrowPhaseProxy narrowPhaseProxy)
+{
+	switch (narrowPhaseProxy)
+	{
+		case NarrowPhaseProxy::LOADED_DISC:		return "Loaded Disc";	break;
+		case NarrowPhaseProxy::MINIMAL_DISC:	return "Minimal Disc";	break;
+		case NarrowPhaseProxy::MINIMAL_OBB:		return "Minimal OBB";	break;
+	}
+
+	return "";
 }
 
 std::string GetOptimizationModeStr(OptimizationMode optimizationMode)
@@ -818,6 +2084,16 @@ std::string GetOptimizationModeStr(OptimizationMode optimizationMode)
 		case OptimizationMode::NARROW_PHASE_BOUNDING_DISC_ONLY:		return "Narrow Phase Only (Bounding Disc)";		break;
 		case OptimizationMode::BROAD_PHASE_BIT_BUCKET_ONLY:			return "Broad Phase Only (Bit Buckets)";		break;
 		case OptimizationMode::NARROW_AND_BROAD_PHASE:				return "Narrow and Broad Phase";				break;
+		case OptimizationMode::BVH_AABB2_TREE:						return "Broad Phase (AABB2 Tree)";				break;
+		case OptimizationMode::BVH_OBB2_TREE:						return "Broad Phase (OBB2 Tree)";				break;
+		case OptimizationMode::BVH_DISC2_TREE:						return "Broad Phase (Disc2 Tree)";				break;
+		case OptimizationMode::BVH_CONVEX_HULL_TREE:				return "Broad Phase (Convex Hull Tree)";		break;
+		case OptimizationMode::BVH_COMPOSITE_TREE:					return "Broad Phase (Composite Tree)";			break;
+		case OptimizationMode::ASYMMETRIC_QUADTREE:					return "Broad Phase (Asymmetric Quadtree)";		break;
+		case OptimizationMode::SYMMETRIC_QUADTREE:					return "Broad Phase (Symmetric Loose Quadtree)";	break;
+		case OptimizationMode::COLUMN_ROW_BIT_REGIONS:				return "Broad Phase (Column/Row Bit Regions)";	break;
+		case OptimizationMode::BSP2_TREE:							return "Broad Phase (BSP2 Tree)";				break;
+		case OptimizationMode::HIERARCHICAL_BIT_BUCKETS:			return "Broad Phase (Hierarchical Bit Buckets)";	break;
 	}
 
 	return "";
@@ -854,6 +2130,17 @@ bool Command_SaveScene(EventArgs& args)
 		g_console->AddLine("\tsaveBoundingDiscs: Whether to save the optional bounding discs chunk");
 		g_console->AddLine("\tsaveConvexHulls: Whether to save the optional convex hulls chunk");
 		g_console->AddLine("\tsaveBitBuckets: Whether to save the optional bit buckets chunk");
+		g_console->AddLine("\tsaveAABB2Tree: Whether to save the optional AABB2 tree chunk");
+		g_console->AddLine("\tsaveOBB2Tree: Whether to save the optional OBB2 tree chunk");
+		g_console->AddLine("\tsaveDisc2Tree: Whether to save the optional Disc2 tree chunk");
+		g_console->AddLine("\tsaveConvexHull2Tree: Whether to save the optional convex hull tree chunk");
+		g_console->AddLine("\tsaveConvexPoly2Tree: Whether to save the optional convex poly tree chunk");
+		g_console->AddLine("\tsaveCompositeTree: Whether to save the optional Composite tree chunk");
+		g_console->AddLine("\tsaveAsymmetricQuadtree: Whether to save the optional Asymmetric quadtree chunk");
+		g_console->AddLine("\tsaveSymmetricQuadtree: Whether to save the optional Symmetric quadtree chunk");
+		g_console->AddLine("\tsaveColumnRowBitRegions: Whether to save the optional column/row bit regions chunk");
+		g_console->AddLine("\tsaveBSP2Tree: Whether to save the optional BSP2 tree chunk");
+		g_console->AddLine("\tsaveHierarchicalBitBuckets: Whether to save the optional hierarchical bit buckets chunk");
 		g_console->AddLine("\tendianMode: The endian mode to save the file in, must be either LITTLE or BIG");
 
 		return false;
@@ -869,6 +2156,17 @@ bool Command_SaveScene(EventArgs& args)
 	bool saveBoundingDiscs = args.GetValue("saveBoundingDiscs", false);
 	bool saveConvexHulls = args.GetValue("saveConvexHulls", false);
 	bool saveBitBuckets = args.GetValue("saveBitBuckets", false);
+	bool saveAABB2Tree = args.GetValue("saveAABB2Tree", false);
+	bool saveOBB2Tree = args.GetValue("saveOBB2Tree", false);
+	bool saveDisc2Tree = args.GetValue("saveDisc2Tree", false);
+	bool saveConvexHull2Tree = args.GetValue("saveConvexHull2Tree", false);
+	bool saveConvexPoly2Tree = args.GetValue("saveConvexPoly2Tree", false);
+	bool saveCompositeTree = args.GetValue("saveCompositeTree", false);
+	bool saveAsymmetricQuadtree = args.GetValue("saveAsymmetricQuadtree", false);
+	bool saveSymmetricQuadtree = args.GetValue("saveSymmetricQuadtree", false);
+	bool saveColumnRowBitRegions = args.GetValue("saveColumnRowBitRegions", false);
+	bool saveBSP2Tree = args.GetValue("saveBSP2Tree", false);
+	bool saveHierarchicalBitBuckets = args.GetValue("saveHierarchicalBitBuckets", false);
 
 	std::vector<unsigned char> fileBuffer;
 	BufferWriter writer(fileBuffer);
@@ -896,6 +2194,11 @@ bool Command_SaveScene(EventArgs& args)
 
 	Game* game = g_app->m_game;
 	VisualTestConvexScene* convexScene = dynamic_cast<VisualTestConvexScene*>(game);
+	if (convexScene->m_packedScene.IsEmpty() || convexScene->m_needToRegeneratePackedScene)
+	{
+		convexScene->GeneratePackedScene();
+	}
+	PackedConvexScene const& packedScene = convexScene->m_packedScene;
 
 	// Header
 	Append4ccCodeToWriter(CONVEX_SCENE_4CC_CODE, writer);
@@ -918,6 +2221,28 @@ bool Command_SaveScene(EventArgs& args)
 	uint32_t boundingDiscsChunkDataSize = 0;
 	uint32_t tiledBitRegionsChunkStartLocation = 0;
 	uint32_t tiledBitRegionsChunkDataSize = 0;
+	uint32_t aabb2TreeChunkStartLocation = 0;
+	uint32_t aabb2TreeChunkDataSize = 0;
+	uint32_t obb2TreeChunkStartLocation = 0;
+	uint32_t obb2TreeChunkDataSize = 0;
+	uint32_t disc2TreeChunkStartLocation = 0;
+	uint32_t disc2TreeChunkDataSize = 0;
+	uint32_t convexHull2TreeChunkStartLocation = 0;
+	uint32_t convexHull2TreeChunkDataSize = 0;
+	uint32_t convexPoly2TreeChunkStartLocation = 0;
+	uint32_t convexPoly2TreeChunkDataSize = 0;
+	uint32_t compositeTreeChunkStartLocation = 0;
+	uint32_t compositeTreeChunkDataSize = 0;
+	uint32_t asymmetricQuadtreeChunkStartLocation = 0;
+	uint32_t asymmetricQuadtreeChunkDataSize = 0;
+	uint32_t symmetricQuadtreeChunkStartLocation = 0;
+	uint32_t symmetricQuadtreeChunkDataSize = 0;
+	uint32_t columnRowBitRegionsChunkStartLocation = 0;
+	uint32_t columnRowBitRegionsChunkDataSize = 0;
+	uint32_t bsp2TreeChunkStartLocation = 0;
+	uint32_t bsp2TreeChunkDataSize = 0;
+	uint32_t hierarchicalBitBucketsChunkStartLocation = 0;
+	uint32_t hierarchicalBitBucketsChunkDataSize = 0;
 
 	// Scene Info Chunk
 	constexpr int SCENE_INFO_CHUNK_PAYLOAD_SIZE = 18;
@@ -948,13 +2273,12 @@ bool Command_SaveScene(EventArgs& args)
 		payloadSize += sizeof(unsigned short);
 		for (int polyIndex = 0; polyIndex < (int)convexScene->m_currentNumPolys; polyIndex++)
 		{
-			std::vector<Vec2> const vertexes = convexScene->m_convexPolys[polyIndex].GetVertexes();
-			int numVertexes = convexScene->m_convexPolys[polyIndex].GetVertexCount();
+			int numVertexes = packedScene.GetNumVertexes(polyIndex);
 			writer.AppendByte((uint8_t)numVertexes);
 			payloadSize += sizeof(uint8_t);
 			for (int vertexIndex = 0; vertexIndex < numVertexes; vertexIndex++)
 			{
-				writer.AppendVec2(vertexes[vertexIndex]);
+				writer.AppendVec2(packedScene.GetVertex(polyIndex, vertexIndex));
 				payloadSize += sizeof(Vec2);
 			}
 		}
@@ -978,15 +2302,15 @@ bool Command_SaveScene(EventArgs& args)
 		payloadSize += sizeof(unsigned short);
 		for (int hullIndex = 0; hullIndex < (int)convexScene->m_currentNumPolys; hullIndex++)
 		{
-			std::vector<Plane2> const planes = convexScene->m_convexHulls[hullIndex].GetPlanes();
-			int numPlanes = convexScene->m_convexHulls[hullIndex].GetPlanesCount();
+			int firstPlaneIndex = packedScene.m_hulls.m_hullFirstPlaneIndexes[hullIndex];
+			int numPlanes = packedScene.GetNumPlanes(hullIndex);
 			writer.AppendByte((uint8_t)numPlanes);
 			payloadSize += sizeof(uint8_t);
-			for (int planeIndex = 0; planeIndex < numPlanes; planeIndex++)
+			for (int planeIndex = firstPlaneIndex; planeIndex < firstPlaneIndex + numPlanes; planeIndex++)
 			{
-				writer.AppendVec2(planes[planeIndex].m_normal);
+				writer.AppendVec2(Vec2(packedScene.m_hulls.m_planeNormalXs[planeIndex], packedScene.m_hulls.m_planeNormalYs[planeIndex]));
 				payloadSize += sizeof(Vec2);
-				writer.AppendFloat(planes[planeIndex].m_distanceFromOriginAlongNormal);
+				writer.AppendFloat(packedScene.m_hulls.m_planeDistances[planeIndex]);
 				payloadSize += sizeof(float);
 			}
 		}
@@ -1017,9 +2341,9 @@ bool Command_SaveScene(EventArgs& args)
 			payloadSize += sizeof(unsigned short);
 			for (int discIndex = 0; discIndex < (int)convexScene->m_currentNumPolys; discIndex++)
 			{
-				writer.AppendVec2(convexScene->m_boundingDiscs[discIndex].m_center);
+				writer.AppendVec2(packedScene.GetBoundingDiscCenter(discIndex));
 				payloadSize += sizeof(Vec2);
-				writer.AppendFloat(convexScene->m_boundingDiscs[discIndex].m_radius);
+				writer.AppendFloat(packedScene.m_boundingDiscRadii[discIndex]);
 				payloadSize += sizeof(float);
 			}
 			writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
@@ -1045,11 +2369,15 @@ bool Command_SaveScene(EventArgs& args)
 		payloadSize += sizeof(Vec2);
 		writer.AppendVec2(convexScene->m_sceneBounds.m_maxs);
 		payloadSize += sizeof(Vec2);
+		writer.AppendUShort((uint16_t)convexScene->m_bitBucketGridSizeX);
+		payloadSize += sizeof(unsigned short);
+		writer.AppendUShort((uint16_t)convexScene->m_bitBucketGridSizeY);
+		payloadSize += sizeof(unsigned short);
 		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
 		payloadSize += sizeof(unsigned short);
-		for (int polyIndex = 0; polyIndex < (int)convexScene->m_currentNumPolys; polyIndex++)
+		for (int wordIndex = 0; wordIndex < (int)convexScene->m_currentNumPolys * convexScene->m_numWordsPerBitBucketMask; wordIndex++)
 		{
-			writer.AppendUint64(convexScene->m_bitBucketMasks[polyIndex]);
+			writer.AppendUint64(convexScene->m_bitBucketMasks[wordIndex]);
 			payloadSize += sizeof(uint64_t);
 		}
 		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
@@ -1058,6 +2386,270 @@ bool Command_SaveScene(EventArgs& args)
 		numChunksSaved++;
 	}
 
+	// AABB2 Tree Chunk
+	if (saveAABB2Tree)
+	{
+		if (convexScene->m_aabb2Tree.IsEmpty() || convexScene->m_needToRegenerateAABB2Tree)
+		{
+			convexScene->GenerateAABB2Tree();
+		}
+
+		aabb2TreeChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::BVH_AABB2_TREE);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_aabb2Tree.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		aabb2TreeChunkDataSize = writer.GetAppendedSize() - aabb2TreeChunkStartLocation;
+		numChunksSaved++;
+	}
+
+	// OBB2 Tree Chunk
+	if (saveOBB2Tree)
+	{
+		if (convexScene->m_obb2Tree.IsEmpty() || convexScene->m_needToRegenerateOBB2Tree)
+		{
+			convexScene->GenerateOBB2Tree();
+		}
+
+		obb2TreeChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::BVH_OBB2_TREE);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_obb2Tree.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		obb2TreeChunkDataSize = writer.GetAppendedSize() - obb2TreeChunkStartLocation;
+		numChunksSaved++;
+	}
+
+	// Disc2 tree Chunk
+	if (saveDisc2Tree)
+	{
+		if (convexScene->m_disc2Tree.IsEmpty() || convexScene->m_needToRegenerateDisc2Tree)
+		{
+			convexScene->GenerateDisc2Tree();
+		}
+
+		disc2TreeChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::BVH_DISC2_TREE);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_disc2Tree.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		disc2TreeChunkDataSize = writer.GetAppendedSize() - disc2TreeChunkStartLocation;
+		numChunksSaved++;
+	}
+
+	// Convex hull tree Chunk
+	if (saveConvexHull2Tree)
+	{
+		if (convexScene->m_convexHull2Tree.IsEmpty() || convexScene->m_needToRegenerateConvexHull2Tree)
+		{
+			convexScene->GenerateConvexHull2Tree();
+		}
+
+		convexHull2TreeChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::BVH_CONVEX_HULL_TREE);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_convexHull2Tree.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		convexHull2TreeChunkDataSize = writer.GetAppendedSize() - convexHull2TreeChunkStartLocation;
+		numChunksSaved++;
+	}
+
+	// Convex poly tree Chunk
+	if (saveConvexPoly2Tree)
+	{
+		if (convexScene->m_convexPoly2Tree.IsEmpty() || convexScene->m_needToRegenerateConvexPoly2Tree)
+		{
+			convexScene->GenerateConvexPoly2Tree();
+		}
+
+		convexPoly2TreeChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::BVH_CONVEX_POLY_TREE);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_convexPoly2Tree.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		convexPoly2TreeChunkDataSize = writer.GetAppendedSize() - convexPoly2TreeChunkStartLocation;
+		numChunksSaved++;
+	}
+
+	// Composite tree Chunk
+	if (saveCompositeTree)
+	{
+		if (convexScene->m_compositeTree.IsEmpty() || convexScene->m_needToRegenerateCompositeTree)
+		{
+			convexScene->GenerateCompositeTree();
+		}
+
+		compositeTreeChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::BVH_COMPOSITE_TREE);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_compositeTree.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		compositeTreeChunkDataSize = writer.GetAppendedSize() - compositeTreeChunkStartLocation;
+		numChunksSaved++;
+	}
+
+	// Asymmetric quadtree Chunk
+	if (saveAsymmetricQuadtree)
+	{
+		if (convexScene->m_asymmetricQuadtree.IsEmpty() || convexScene->m_needToRegenerateAsymmetricQuadtree)
+		{
+			convexScene->GenerateAsymmetricQuadtree();
+		}
+
+		asymmetricQuadtreeChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::ASYMMETRIC_QUADTREE);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_asymmetricQuadtree.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		asymmetricQuadtreeChunkDataSize = writer.GetAppendedSize() - asymmetricQuadtreeChunkStartLocation;
+		numChunksSaved++;
+	}
+
+	// Symmetric quadtree Chunk
+	if (saveSymmetricQuadtree)
+	{
+		if (convexScene->m_symmetricQuadtree.IsEmpty() || convexScene->m_needToRegenerateSymmetricQuadtree)
+		{
+			convexScene->GenerateSymmetricQuadtree();
+		}
+
+		symmetricQuadtreeChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::SYMMETRIC_QUADTREE);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_symmetricQuadtree.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		symmetricQuadtreeChunkDataSize = writer.GetAppendedSize() - symmetricQuadtreeChunkStartLocation;
+		numChunksSaved++;
+	}
+
+	// Column/row bit regions Chunk
+	if (saveColumnRowBitRegions)
+	{
+		if (convexScene->m_columnRowBitRegions.IsEmpty() || convexScene->m_needToRegenerateColumnRowBitRegions)
+		{
+			convexScene->GenerateColumnRowBitRegions();
+		}
+
+		columnRowBitRegionsChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::COLUMN_ROW_BIT_REGIONS);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_columnRowBitRegions.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		columnRowBitRegionsChunkDataSize = writer.GetAppendedSize() - columnRowBitRegionsChunkStartLocation;
+		numChunksSaved++;
+	}
+
+	// BSP2 tree Chunk
+	if (saveBSP2Tree)
+	{
+		if (convexScene->m_bsp2Tree.IsEmpty() || convexScene->m_needToRegenerateBSP2Tree)
+		{
+			convexScene->GenerateBSP2Tree();
+		}
+
+		bsp2TreeChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::BSP2_TREE);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_bsp2Tree.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		bsp2TreeChunkDataSize = writer.GetAppendedSize() - bsp2TreeChunkStartLocation;
+		numChunksSaved++;
+	}
+
+	// Hierarchical bit buckets Chunk
+	if (saveHierarchicalBitBuckets)
+	{
+		if (convexScene->m_hierarchicalBitBuckets.IsEmpty() || convexScene->m_needToRegenerateHierarchicalBitBuckets)
+		{
+			convexScene->GenerateHierarchicalBitBuckets();
+		}
+
+		hierarchicalBitBucketsChunkStartLocation = writer.GetAppendedSize();
+		Append4ccCodeToWriter(CONVEX_CHUNK_4CC_CODE, writer);
+		writer.AppendByte((uint8_t)ChunkType::HIERARCHICAL_BIT_BUCKETS);
+		writer.AppendByte(endianModeCode);
+		int payloadLocation = writer.GetAppendedSize();
+		writer.AppendUint32(0x00); // payload size will go here
+		uint32_t payloadSize = 0;
+		writer.AppendUShort((uint16_t)convexScene->m_currentNumPolys);
+		payloadSize += sizeof(unsigned short);
+		payloadSize += convexScene->m_hierarchicalBitBuckets.AppendToWriter(writer);
+		writer.OverwriteUint32AtPosition(payloadSize, payloadLocation);
+		Append4ccCodeToWriter(CONVEX_CHUNK_END_4CC_CODE, writer);
+		hierarchicalBitBucketsChunkDataSize = writer.GetAppendedSize() - hierarchicalBitBucketsChunkStartLocation;
+		numChunksSaved++;
+	}
+
 	// #ToDo Save any unknown chunks as they were loaded if the scene wasn't modified
 	for (int unknownChunkIndex = 0; unknownChunkIndex < (int)convexScene->m_unknownFileChunksLoaded.size(); unknownChunkIndex++)
 	{
@@ -1092,28 +2684,116 @@ bool Command_SaveScene(EventArgs& args)
 		writer.AppendUint32(convexPolysChunkStartLocation);
 		writer.AppendUint32(convexPolysChunkDataSize);
 
-		// Convex Hulls Chunk
-		if (saveConvexHulls)
+		// Convex Hulls Chunk
+		if (saveConvexHulls)
+		{
+			writer.AppendByte((uint8_t)ChunkType::CONVEX_HULLS);
+			writer.AppendUint32(convexHullsChunkStartLocation);
+			writer.AppendUint32(convexHullsChunkDataSize);
+		}
+
+		// Bounding Discs Chunk
+		if (saveBoundingDiscs)
+		{
+			writer.AppendByte((uint8_t)ChunkType::BOUNDING_DISCS);
+			writer.AppendUint32(boundingDiscsChunkStartLocation);
+			writer.AppendUint32(boundingDiscsChunkDataSize);
+		}
+
+		// Tiled Bit Regions Chunk
+		if (saveBitBuckets)
+		{
+			writer.AppendByte((uint8_t)ChunkType::TILED_BIT_REGIONS);
+			writer.AppendUint32(tiledBitRegionsChunkStartLocation);
+			writer.AppendUint32(tiledBitRegionsChunkDataSize);
+		}
+
+		// AABB2 Tree Chunk
+		if (saveAABB2Tree)
+		{
+			writer.AppendByte((uint8_t)ChunkType::BVH_AABB2_TREE);
+			writer.AppendUint32(aabb2TreeChunkStartLocation);
+			writer.AppendUint32(aabb2TreeChunkDataSize);
+		}
+
+		// OBB2 Tree Chunk
+		if (saveOBB2Tree)
+		{
+			writer.AppendByte((uint8_t)ChunkType::BVH_OBB2_TREE);
+			writer.AppendUint32(obb2TreeChunkStartLocation);
+			writer.AppendUint32(obb2TreeChunkDataSize);
+		}
+
+		// Disc2 tree Chunk
+		if (saveDisc2Tree)
+		{
+			writer.AppendByte((uint8_t)ChunkType::BVH_DISC2_TREE);
+			writer.AppendUint32(disc2TreeChunkStartLocation);
+			writer.AppendUint32(disc2TreeChunkDataSize);
+		}
+
+		// Convex hull tree Chunk
+		if (saveConvexHull2Tree)
+		{
+			writer.AppendByte((uint8_t)ChunkType::BVH_CONVEX_HULL_TREE);
+			writer.AppendUint32(convexHull2TreeChunkStartLocation);
+			writer.AppendUint32(convexHull2TreeChunkDataSize);
+		}
+
+		// Convex poly tree Chunk
+		if (saveConvexPoly2Tree)
+		{
+			writer.AppendByte((uint8_t)ChunkType::BVH_CONVEX_POLY_TREE);
+			writer.AppendUint32(convexPoly2TreeChunkStartLocation);
+			writer.AppendUint32(convexPoly2TreeChunkDataSize);
+		}
+
+		// Composite tree Chunk
+		if (saveCompositeTree)
+		{
+			writer.AppendByte((uint8_t)ChunkType::BVH_COMPOSITE_TREE);
+			writer.AppendUint32(compositeTreeChunkStartLocation);
+			writer.AppendUint32(compositeTreeChunkDataSize);
+		}
+
+		// Asymmetric quadtree Chunk
+		if (saveAsymmetricQuadtree)
+		{
+			writer.AppendByte((uint8_t)ChunkType::ASYMMETRIC_QUADTREE);
+			writer.AppendUint32(asymmetricQuadtreeChunkStartLocation);
+			writer.AppendUint32(asymmetricQuadtreeChunkDataSize);
+		}
+
+		// Symmetric quadtree Chunk
+		if (saveSymmetricQuadtree)
+		{
+			writer.AppendByte((uint8_t)ChunkType::SYMMETRIC_QUADTREE);
+			writer.AppendUint32(symmetricQuadtreeChunkStartLocation);
+			writer.AppendUint32(symmetricQuadtreeChunkDataSize);
+		}
+
+		// Column/row bit regions Chunk
+		if (saveColumnRowBitRegions)
 		{
-			writer.AppendByte((uint8_t)ChunkType::CONVEX_HULLS);
-			writer.AppendUint32(convexHullsChunkStartLocation);
-			writer.AppendUint32(convexHullsChunkDataSize);
+			writer.AppendByte((uint8_t)ChunkType::COLUMN_ROW_BIT_REGIONS);
+			writer.AppendUint32(columnRowBitRegionsChunkStartLocation);
+			writer.AppendUint32(columnRowBitRegionsChunkDataSize);
 		}
 
-		// Bounding Discs Chunk
-		if (saveBoundingDiscs)
+		// BSP2 tree Chunk
+		if (saveBSP2Tree)
 		{
-			writer.AppendByte((uint8_t)ChunkType::BOUNDING_DISCS);
-			writer.AppendUint32(boundingDiscsChunkStartLocation);
-			writer.AppendUint32(boundingDiscsChunkDataSize);
+			writer.AppendByte((uint8_t)ChunkType::BSP2_TREE);
+			writer.AppendUint32(bsp2TreeChunkStartLocation);
+			writer.AppendUint32(bsp2TreeChunkDataSize);
 		}
 
-		// Tiled Bit Regions Chunk
-		if (saveBitBuckets)
+		// Hierarchical bit buckets Chunk
+		if (saveHierarchicalBitBuckets)
 		{
-			writer.AppendByte((uint8_t)ChunkType::TILED_BIT_REGIONS);
-			writer.AppendUint32(tiledBitRegionsChunkStartLocation);
-			writer.AppendUint32(tiledBitRegionsChunkDataSize);
+			writer.AppendByte((uint8_t)ChunkType::HIERARCHICAL_BIT_BUCKETS);
+			writer.AppendUint32(hierarchicalBitBucketsChunkStartLocation);
+			writer.AppendUint32(hierarchicalBitBucketsChunkDataSize);
 		}
 
 		for (int unknownChunkIndex = 0; unknownChunkIndex < (int)convexScene->m_unknownFileChunksLoaded.size(); unknownChunkIndex++)
@@ -1157,10 +2837,39 @@ bool Command_LoadScene(EventArgs& args)
 	VisualTestConvexScene* convexScene = dynamic_cast<VisualTestConvexScene*>(game);
 
 	convexScene->m_unknownFileChunksLoaded.clear();
+	convexScene->m_modifiedPolyIndexes.clear();
 	convexScene->m_convexPolys.clear();
 	convexScene->m_convexHulls.clear();
 	convexScene->m_boundingDiscs.clear();
 	convexScene->m_bitBucketMasks.clear();
+	convexScene->m_aabb2Tree.Clear();
+	convexScene->m_needToRegenerateAABB2Tree = true;
+	convexScene->m_obb2Tree.Clear();
+	convexScene->m_needToRegenerateOBB2Tree = true;
+	convexScene->m_disc2Tree.Clear();
+	convexScene->m_needToRegenerateDisc2Tree = true;
+	convexScene->m_convexHull2Tree.Clear();
+	convexScene->m_needToRegenerateConvexHull2Tree = true;
+	convexScene->m_convexPoly2Tree.Clear();
+	convexScene->m_needToRegenerateConvexPoly2Tree = true;
+	convexScene->m_compositeTree.Clear();
+	convexScene->m_needToRegenerateCompositeTree = true;
+	convexScene->m_asymmetricQuadtree.Clear();
+	convexScene->m_needToRegenerateAsymmetricQuadtree = true;
+	convexScene->m_symmetricQuadtree.Clear();
+	convexScene->m_needToRegenerateSymmetricQuadtree = true;
+	convexScene->m_columnRowBitRegions.Clear();
+	convexScene->m_needToRegenerateColumnRowBitRegions = true;
+	convexScene->m_bsp2Tree.Clear();
+	convexScene->m_needToRegenerateBSP2Tree = true;
+	convexScene->m_hierarchicalBitBuckets.Clear();
+	convexScene->m_needToRegenerateHierarchicalBitBuckets = true;
+	convexScene->m_packedScene.Clear();
+	convexScene->m_quantizedScene.Clear();
+	convexScene->m_needToRegeneratePackedScene = true;
+	convexScene->m_minimalBoundingDiscs.clear();
+	convexScene->m_minimalBoundingOBBs.clear();
+	convexScene->m_needToRegenerateMinimalBoundingVolumes = true;
 
 	// Header
 	char const* convexScene4ccCode = Parse4ccCodeFromParser(parser);
@@ -1184,8 +2893,9 @@ bool Command_LoadScene(EventArgs& args)
 		return false;
 	}
 
+	// Older minor versions still load; chunks whose layout changed branch on the file's minor version
 	uint8_t fileMinorVersion = parser.ParseByte();
-	if (fileMinorVersion != MINOR_VERSION)
+	if (fileMinorVersion < 1 || fileMinorVersion > MINOR_VERSION)
 	{
 		g_console->AddLine(DevConsole::ERROR, "Invalid minor version. Aborting load!");
 		return false;
@@ -1248,154 +2958,457 @@ bool Command_LoadScene(EventArgs& args)
 			}
 			[[maybe_unused]] uint32_t chunkDataSize = parser.ParseUint32();
 
-			Vec2 worldBoundsMins = parser.ParseVec2();
-			Vec2 worldBoundsMaxs = parser.ParseVec2();
-			float worldBoundsAspect = (worldBoundsMaxs - worldBoundsMins).x / (worldBoundsMaxs - worldBoundsMins).y;
-			convexScene->m_sceneBounds = AABB2(worldBoundsMins, worldBoundsMaxs);
+			Vec2 worldBoundsMins = parser.ParseVec2();
+			Vec2 worldBoundsMaxs = parser.ParseVec2();
+			float worldBoundsAspect = (worldBoundsMaxs - worldBoundsMins).x / (worldBoundsMaxs - worldBoundsMins).y;
+			convexScene->m_sceneBounds = AABB2(worldBoundsMins, worldBoundsMaxs);
+
+			if (worldBoundsAspect < g_window->GetAspect())
+			{
+				// Need pillarbox borders
+				convexScene->m_worldBounds.m_mins.y = worldBoundsMins.y;
+				convexScene->m_worldBounds.m_maxs.y = worldBoundsMaxs.y;
+
+				convexScene->m_worldBounds.m_mins.x = worldBoundsMins.x - convexScene->m_sceneBounds.GetDimensions().x * 0.5f;
+				convexScene->m_worldBounds.m_maxs.x = convexScene->m_worldBounds.m_mins.x + (worldBoundsMaxs.y - worldBoundsMins.y) * g_window->GetAspect();
+			}
+			else if (worldBoundsAspect > g_window->GetAspect())
+			{
+				// Need letterbox borders
+				convexScene->m_worldBounds.m_mins.x = worldBoundsMins.x;
+				convexScene->m_worldBounds.m_maxs.x = worldBoundsMaxs.x;
+
+				convexScene->m_worldBounds.m_mins.y = worldBoundsMins.y - convexScene->m_sceneBounds.GetDimensions().y * 0.5f;
+				convexScene->m_worldBounds.m_maxs.y = convexScene->m_worldBounds.m_mins.y + (worldBoundsMaxs.x - worldBoundsMins.x) / g_window->GetAspect();
+			}
+			else
+			{
+				// Remove all borders, aspects are exactly equal
+				convexScene->m_worldBounds = AABB2(worldBoundsMins, worldBoundsMaxs);
+			}
+
+			convexScene->m_currentNumPolys = parser.ParseUShort();
+			char const* chunkEnd4ccCode = Parse4ccCodeFromParser(parser);
+			if (strcmp(chunkEnd4ccCode, CONVEX_CHUNK_END_4CC_CODE))
+			{
+				g_console->AddLine(DevConsole::ERROR, "Could not find chunk end 4CC code for Scene Info chunk. Aborting load!");
+				return false;
+			}
+		}
+
+
+		{
+			// Convex Polys chunk
+
+			char const* chunkStart4ccCode = Parse4ccCodeFromParser(parser);
+			if (strcmp(chunkStart4ccCode, CONVEX_CHUNK_4CC_CODE))
+			{
+				g_console->AddLine(DevConsole::ERROR, "Could not find chunk 4CC code for ConvexPolys chunk. Aborting load!");
+				return false;
+			}
+			uint8_t chunkType = parser.ParseByte();
+			if (chunkType != (uint8_t)ChunkType::CONVEX_POLYS)
+			{
+				g_console->AddLine("Invalid chunk type immediately after Scene Info chunk. Expected ConvexPolys chunk! Aborting load...");
+				return false;
+			}
+			uint8_t chunkEndianMode = parser.ParseByte();
+			if (chunkEndianMode == (uint8_t)BufferEndian::LITTLE)
+			{
+				parser.SetEndianMode(BufferEndian::LITTLE);
+			}
+			else if (chunkEndianMode == (uint8_t)BufferEndian::BIG)
+			{
+				parser.SetEndianMode(BufferEndian::BIG);
+			}
+			else
+			{
+				g_console->AddLine("Unknown endian mode for ConvexPolys chunk. Only little endian and big endian are supported! Aborting load...");
+				return false;
+			}
+			[[maybe_unused]] uint32_t chunkDataSize = parser.ParseUint32();
+
+			int numPolysInConvexPolysChunk = parser.ParseUShort();
+			if (numPolysInConvexPolysChunk != convexScene->m_currentNumPolys)
+			{
+				g_console->AddLine("Mismatch in number of polys in SceneInfo chunk and ConvexPolys chunk. Number of polys in each should be the same! Aborting load...");
+				return false;
+			}
+
+			for (int polyIndex = 0; polyIndex < numPolysInConvexPolysChunk; polyIndex++)
+			{
+				int numVertexes = parser.ParseByte();
+				std::vector<Vec2> tempPolyVertexes;
+				for (int vertexIndex = 0; vertexIndex < numVertexes; vertexIndex++)
+				{
+					tempPolyVertexes.push_back(parser.ParseVec2());
+				}
+				convexScene->m_convexPolys.push_back(ConvexPoly2(tempPolyVertexes));
+			}
+
+			char const* chunkEnd4ccCode = Parse4ccCodeFromParser(parser);
+			if (strcmp(chunkEnd4ccCode, CONVEX_CHUNK_END_4CC_CODE))
+			{
+				g_console->AddLine(DevConsole::ERROR, "Could not find chunk end 4CC code for ConvexPolys chunk. Aborting load!");
+				return false;
+			}
+		}
+	}
+	else
+	{
+		convexScene->m_currentNumPolys = 0;
+	}
+
+	while (parser.GetSeekPosition() != tocLocation)
+	{
+		if (!LoadChunkFromParser(parser, fileMinorVersion))
+		{
+			return false;
+		}
+	}
+	//---------------------------------------------------------------------------------------
+
+	g_console->AddLine(DevConsole::INFO_MAJOR, Stringf("Successfully loaded file %s", filePath.c_str()));
+	g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded %d convex polys", convexScene->m_currentNumPolys));
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_convexHulls.empty())
+	{
+		convexScene->GenerateHullsForAllPolys();
+		g_console->AddLine(DevConsole::WARNING, Stringf("No convex hulls loaded. Hulls were generated after loading polys."));
+	}
+	else if (!convexScene->m_convexHulls.empty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded convex hulls for all polys."));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_boundingDiscs.empty())
+	{
+		convexScene->GenerateBoundingDiscsForAllPolys();
+		g_console->AddLine(DevConsole::WARNING, Stringf("No bounding discs loaded. Bounding discs were generated after loading polys and may not be the best fits."));
+	}
+	else if (!convexScene->m_boundingDiscs.empty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded bounding discs for all polys."));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_bitBucketMasks.empty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No tiled bit regions loaded. Tiled bit regions will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_bitBucketMasks.empty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded tiled bit region masks for all polys."));
+	}
+
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_aabb2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No AABB2 tree loaded. AABB2 tree will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_aabb2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded AABB2 tree with %d nodes.", (int)convexScene->m_aabb2Tree.m_nodes.size()));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_obb2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No OBB2 tree loaded. OBB2 tree will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_obb2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded OBB2 tree with %d nodes.", (int)convexScene->m_obb2Tree.m_nodes.size()));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_disc2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No Disc2 tree loaded. Disc2 tree will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_disc2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded Disc2 tree with %d nodes.", (int)convexScene->m_disc2Tree.m_nodes.size()));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_convexHull2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No Convex hull tree loaded. Convex hull tree will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_convexHull2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded Convex hull tree with %d nodes.", (int)convexScene->m_convexHull2Tree.m_nodes.size()));
+	}
+	if (!convexScene->m_convexPoly2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded Convex poly tree with %d nodes.", (int)convexScene->m_convexPoly2Tree.m_nodes.size()));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_compositeTree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No Composite tree loaded. Composite tree will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_compositeTree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded Composite tree with %d nodes.", (int)convexScene->m_compositeTree.m_nodes.size()));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_asymmetricQuadtree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No Asymmetric quadtree loaded. Asymmetric quadtree will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_asymmetricQuadtree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded Asymmetric quadtree with %d nodes.", (int)convexScene->m_asymmetricQuadtree.m_nodes.size()));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_symmetricQuadtree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No Symmetric quadtree loaded. Symmetric quadtree will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_symmetricQuadtree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded Symmetric quadtree with %d nodes.", (int)convexScene->m_symmetricQuadtree.m_nodes.size()));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_columnRowBitRegions.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No Column/row bit regions loaded. Column/row bit regions will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_columnRowBitRegions.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded Column/row bit regions with %dx%d cells.", convexScene->m_columnRowBitRegions.m_numColumns, convexScene->m_columnRowBitRegions.m_numRows));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_bsp2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No BSP2 tree loaded. BSP2 tree will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_bsp2Tree.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded BSP2 tree with %d nodes.", (int)convexScene->m_bsp2Tree.m_nodes.size()));
+	}
+	if (convexScene->m_currentNumPolys > 0 && convexScene->m_hierarchicalBitBuckets.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::WARNING, Stringf("No hierarchical bit buckets loaded. Hierarchical bit buckets will be generated when testing raycasts."));
+	}
+	else if (!convexScene->m_hierarchicalBitBuckets.IsEmpty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded hierarchical bit buckets with %d fine masks.", (int)convexScene->m_hierarchicalBitBuckets.m_fineMasks.size()));
+	}
+
+	if (!convexScene->m_unknownFileChunksLoaded.empty())
+	{
+		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded %d unknown chunks. Chunks will be written to save file if the scene is not modified.", (int)convexScene->m_unknownFileChunksLoaded.size()));
+	}
+
+	return false;
+}
+
+bool Command_SetColumnRowBitRegionsResolution(EventArgs& args)
+{
+	bool help = args.GetValue("help", false);
+	if (help)
+	{
+		g_console->AddLine("Command to set the resolution of the column/row bit regions broad phase.");
+		g_console->AddLine("Arguments:");
+		g_console->AddLine(Stringf("\tcolumns (int): Number of grid columns (1 to %d), e.g. 64, 256 or 1024. Rows are chosen to keep cells square", ColumnRowBitRegions::MAX_COLUMNS));
+
+		return false;
+	}
+
+	int numColumns = args.GetValue("columns", -1);
+	if (numColumns < 1 || numColumns > ColumnRowBitRegions::MAX_COLUMNS)
+	{
+		g_console->AddLine(DevConsole::ERROR, Stringf("Number of columns must be between 1 and %d!", ColumnRowBitRegions::MAX_COLUMNS));
+		return false;
+	}
+
+	Game* game = g_app->m_game;
+	VisualTestConvexScene* convexScene = dynamic_cast<VisualTestConvexScene*>(game);
+	if (!convexScene)
+	{
+		g_console->AddLine(DevConsole::ERROR, "Column/row bit regions resolution can only be set in the convex scene!");
+		return false;
+	}
+
+	convexScene->m_numColumnRowBitRegionColumns = numColumns;
+	convexScene->m_needToRegenerateColumnRowBitRegions = true;
+	g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Column/row bit regions will use %d columns.", numColumns));
+	return true;
+}
+
+bool Command_SetBitBucketGridResolution(EventArgs& args)
+{
+	bool help = args.GetValue("help", false);
+	if (help)
+	{
+		g_console->AddLine("Command to set the tile grid size of the bit bucket broad phase.");
+		g_console->AddLine("Arguments:");
+		g_console->AddLine(Stringf("\tx (int): Number of tile columns (1 to %d), e.g. 8, 32 or 128", VisualTestConvexScene::MAX_BIT_BUCKET_GRID_SIZE));
+		g_console->AddLine(Stringf("\ty (int): Number of tile rows (1 to %d), e.g. 8, 32 or 64", VisualTestConvexScene::MAX_BIT_BUCKET_GRID_SIZE));
+
+		return false;
+	}
+
+	int gridSizeX = args.GetValue("x", -1);
+	int gridSizeY = args.GetValue("y", -1);
+	if (gridSizeX < 1 || gridSizeY < 1 || gridSizeX > VisualTestConvexScene::MAX_BIT_BUCKET_GRID_SIZE || gridSizeY > VisualTestConvexScene::MAX_BIT_BUCKET_GRID_SIZE)
+	{
+		g_console->AddLine(DevConsole::ERROR, Stringf("Grid size must be between 1 and %d in each direction!", VisualTestConvexScene::MAX_BIT_BUCKET_GRID_SIZE));
+		return false;
+	}
+
+	Game* game = g_app->m_game;
+	VisualTestConvexScene* convexScene = dynamic_cast<VisualTestConvexScene*>(game);
+	if (!convexScene)
+	{
+		g_console->AddLine(DevConsole::ERROR, "Bit bucket grid resolution can only be set in the convex scene!");
+		return false;
+	}
+
+	convexScene->SetBitBucketGridSize(gridSizeX, gridSizeY);
+	g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Bit buckets will use a %dx%d tile grid.", gridSizeX, gridSizeY));
+	return true;
+}
+
+bool Command_BenchmarkConvexHullRaycasts(EventArgs& args)
+{
+	bool help = args.GetValue("help", false);
+	if (help)
+	{
+		g_console->AddLine("Command to time every ray against every convex hull with the scalar and SIMD ray vs hull kernels, and with float or 16-bit culling in front of the SIMD kernel.");
+		g_console->AddLine("Arguments:");
+		g_console->AddLine("\trays (int): Number of random rays to fire, defaults to 10000");
+
+		return false;
+	}
+
+	int numRays = args.GetValue("rays", 10000);
+	if (numRays < 1)
+	{
+		g_console->AddLine(DevConsole::ERROR, "Number of rays must be at least 1!");
+		return false;
+	}
 
-			if (worldBoundsAspect < g_window->GetAspect())
-			{
-				// Need pillarbox borders
-				convexScene->m_worldBounds.m_mins.y = worldBoundsMins.y;
-				convexScene->m_worldBounds.m_maxs.y = worldBoundsMaxs.y;
+	Game* game = g_app->m_game;
+	VisualTestConvexScene* convexScene = dynamic_cast<VisualTestConvexScene*>(game);
+	if (!convexScene)
+	{
+		g_console->AddLine(DevConsole::ERROR, "Convex hull raycasts can only be benchmarked in the convex scene!");
+		return false;
+	}
+	if (convexScene->m_packedScene.IsEmpty() || convexScene->m_needToRegeneratePackedScene)
+	{
+		convexScene->GeneratePackedScene();
+	}
 
-				convexScene->m_worldBounds.m_mins.x = worldBoundsMins.x - convexScene->m_sceneBounds.GetDimensions().x * 0.5f;
-				convexScene->m_worldBounds.m_maxs.x = convexScene->m_worldBounds.m_mins.x + (worldBoundsMaxs.y - worldBoundsMins.y) * g_window->GetAspect();
-			}
-			else if (worldBoundsAspect > g_window->GetAspect())
-			{
-				// Need letterbox borders
-				convexScene->m_worldBounds.m_mins.x = worldBoundsMins.x;
-				convexScene->m_worldBounds.m_maxs.x = worldBoundsMaxs.x;
+	std::vector<Vec2> rayStartPositions;
+	std::vector<Vec2> rayFwdNormals;
+	std::vector<float> rayMaxDistances;
+	for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+	{
+		rayStartPositions.push_back(g_RNG->RollRandomVec2InBox(convexScene->m_sceneBounds));
+		rayFwdNormals.push_back(Vec2::MakeFromPolarDegrees(g_RNG->RollRandomFloatInRange(0.f, 360.f)));
+		rayMaxDistances.push_back(g_RNG->RollRandomFloatInRange(VisualTestConvexScene::RAY_MIN_LENGTH, VisualTestConvexScene::RAY_MAX_LENGTH));
+	}
 
-				convexScene->m_worldBounds.m_mins.y = worldBoundsMins.y - convexScene->m_sceneBounds.GetDimensions().y * 0.5f;
-				convexScene->m_worldBounds.m_maxs.y = convexScene->m_worldBounds.m_mins.y + (worldBoundsMaxs.x - worldBoundsMins.x) / g_window->GetAspect();
-			}
-			else
+	int numHulls = (int)convexScene->m_convexHulls.size();
+	std::vector<float> scalarClosestImpactDistances(numRays, FLT_MAX);
+	double scalarStartTimeSeconds = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+	{
+		for (int hullIndex = 0; hullIndex < numHulls; hullIndex++)
+		{
+			RaycastResult2D raycastVsConvexHullResult = RaycastVsConvexHull2(rayStartPositions[rayIndex], rayFwdNormals[rayIndex], rayMaxDistances[rayIndex], convexScene->m_convexHulls[hullIndex]);
+			if (raycastVsConvexHullResult.m_didImpact && raycastVsConvexHullResult.m_impactDistance < scalarClosestImpactDistances[rayIndex])
 			{
-				// Remove all borders, aspects are exactly equal
-				convexScene->m_worldBounds = AABB2(worldBoundsMins, worldBoundsMaxs);
+				scalarClosestImpactDistances[rayIndex] = raycastVsConvexHullResult.m_impactDistance;
 			}
+		}
+	}
+	double scalarTimeSeconds = GetCurrentTimeSeconds() - scalarStartTimeSeconds;
 
-			convexScene->m_currentNumPolys = parser.ParseUShort();
-			char const* chunkEnd4ccCode = Parse4ccCodeFromParser(parser);
-			if (strcmp(chunkEnd4ccCode, CONVEX_CHUNK_END_4CC_CODE))
+	std::vector<float> simdClosestImpactDistances(numRays, FLT_MAX);
+	double simdStartTimeSeconds = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+	{
+		for (int hullIndex = 0; hullIndex < numHulls; hullIndex++)
+		{
+			RaycastResult2D raycastVsConvexHullResult = convexScene->m_packedScene.m_hulls.RaycastVsConvexHull(rayStartPositions[rayIndex], rayFwdNormals[rayIndex], rayMaxDistances[rayIndex], hullIndex);
+			if (raycastVsConvexHullResult.m_didImpact && raycastVsConvexHullResult.m_impactDistance < simdClosestImpactDistances[rayIndex])
 			{
-				g_console->AddLine(DevConsole::ERROR, "Could not find chunk end 4CC code for Scene Info chunk. Aborting load!");
-				return false;
+				simdClosestImpactDistances[rayIndex] = raycastVsConvexHullResult.m_impactDistance;
 			}
 		}
+	}
+	double simdTimeSeconds = GetCurrentTimeSeconds() - simdStartTimeSeconds;
 
-
+	// Same culling pipeline over float and quantized data: disc, then any-hit hull, then the exact SIMD raycast
+	PackedConvexScene const& packedScene = convexScene->m_packedScene;
+	QuantizedConvexScene const& quantizedScene = convexScene->m_quantizedScene;
+	std::vector<float> floatCulledClosestImpactDistances(numRays, FLT_MAX);
+	double floatCulledStartTimeSeconds = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+	{
+		for (int hullIndex = 0; hullIndex < numHulls; hullIndex++)
 		{
-			// Convex Polys chunk
-
-			char const* chunkStart4ccCode = Parse4ccCodeFromParser(parser);
-			if (strcmp(chunkStart4ccCode, CONVEX_CHUNK_4CC_CODE))
-			{
-				g_console->AddLine(DevConsole::ERROR, "Could not find chunk 4CC code for ConvexPolys chunk. Aborting load!");
-				return false;
-			}
-			uint8_t chunkType = parser.ParseByte();
-			if (chunkType != (uint8_t)ChunkType::CONVEX_POLYS)
-			{
-				g_console->AddLine("Invalid chunk type immediately after Scene Info chunk. Expected ConvexPolys chunk! Aborting load...");
-				return false;
-			}
-			uint8_t chunkEndianMode = parser.ParseByte();
-			if (chunkEndianMode == (uint8_t)BufferEndian::LITTLE)
-			{
-				parser.SetEndianMode(BufferEndian::LITTLE);
-			}
-			else if (chunkEndianMode == (uint8_t)BufferEndian::BIG)
-			{
-				parser.SetEndianMode(BufferEndian::BIG);
-			}
-			else
+			if (!packedScene.DoesRayHitBoundingDisc(hullIndex, rayStartPositions[rayIndex], rayFwdNormals[rayIndex], rayMaxDistances[rayIndex]) ||
+				!packedScene.m_hulls.DoesRayHitConvexHull(rayStartPositions[rayIndex], rayFwdNormals[rayIndex], rayMaxDistances[rayIndex], hullIndex))
 			{
-				g_console->AddLine("Unknown endian mode for ConvexPolys chunk. Only little endian and big endian are supported! Aborting load...");
-				return false;
+				continue;
 			}
-			[[maybe_unused]] uint32_t chunkDataSize = parser.ParseUint32();
-
-			int numPolysInConvexPolysChunk = parser.ParseUShort();
-			if (numPolysInConvexPolysChunk != convexScene->m_currentNumPolys)
+			RaycastResult2D raycastVsConvexHullResult = packedScene.m_hulls.RaycastVsConvexHull(rayStartPositions[rayIndex], rayFwdNormals[rayIndex], rayMaxDistances[rayIndex], hullIndex);
+			if (raycastVsConvexHullResult.m_didImpact && raycastVsConvexHullResult.m_impactDistance < floatCulledClosestImpactDistances[rayIndex])
 			{
-				g_console->AddLine("Mismatch in number of polys in SceneInfo chunk and ConvexPolys chunk. Number of polys in each should be the same! Aborting load...");
-				return false;
+				floatCulledClosestImpactDistances[rayIndex] = raycastVsConvexHullResult.m_impactDistance;
 			}
+		}
+	}
+	double floatCulledTimeSeconds = GetCurrentTimeSeconds() - floatCulledStartTimeSeconds;
 
-			for (int polyIndex = 0; polyIndex < numPolysInConvexPolysChunk; polyIndex++)
+	std::vector<float> quantizedCulledClosestImpactDistances(numRays, FLT_MAX);
+	long long numQuantizedCullPasses = 0;
+	double quantizedCulledStartTimeSeconds = GetCurrentTimeSeconds();
+	for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
+	{
+		for (int hullIndex = 0; hullIndex < numHulls; hullIndex++)
+		{
+			if (!quantizedScene.DoesRayHitBoundingDisc(rayStartPositions[rayIndex], rayFwdNormals[rayIndex], rayMaxDistances[rayIndex], hullIndex) ||
+				!quantizedScene.DoesRayHitConvexHull(rayStartPositions[rayIndex], rayFwdNormals[rayIndex], rayMaxDistances[rayIndex], hullIndex))
 			{
-				int numVertexes = parser.ParseByte();
-				std::vector<Vec2> tempPolyVertexes;
-				for (int vertexIndex = 0; vertexIndex < numVertexes; vertexIndex++)
-				{
-					tempPolyVertexes.push_back(parser.ParseVec2());
-				}
-				convexScene->m_convexPolys.push_back(ConvexPoly2(tempPolyVertexes));
+				continue;
 			}
-
-			char const* chunkEnd4ccCode = Parse4ccCodeFromParser(parser);
-			if (strcmp(chunkEnd4ccCode, CONVEX_CHUNK_END_4CC_CODE))
+			numQuantizedCullPasses++;
+			RaycastResult2D raycastVsConvexHullResult = packedScene.m_hulls.RaycastVsConvexHull(rayStartPositions[rayIndex], rayFwdNormals[rayIndex], rayMaxDistances[rayIndex], hullIndex);
+			if (raycastVsConvexHullResult.m_didImpact && raycastVsConvexHullResult.m_impactDistance < quantizedCulledClosestImpactDistances[rayIndex])
 			{
-				g_console->AddLine(DevConsole::ERROR, "Could not find chunk end 4CC code for ConvexPolys chunk. Aborting load!");
-				return false;
+				quantizedCulledClosestImpactDistances[rayIndex] = raycastVsConvexHullResult.m_impactDistance;
 			}
 		}
 	}
-	else
-	{
-		convexScene->m_currentNumPolys = 0;
-	}
+	double quantizedCulledTimeSeconds = GetCurrentTimeSeconds() - quantizedCulledStartTimeSeconds;
 
-	while (parser.GetSeekPosition() != tocLocation)
+	// Every kernel should agree on every closest hit up to float rounding; a quantized mismatch means culling was not conservative
+	int numMismatchedRays = 0;
+	int numQuantizedMismatchedRays = 0;
+	for (int rayIndex = 0; rayIndex < numRays; rayIndex++)
 	{
-		if (!LoadChunkFromParser(parser))
+		if (fabsf(scalarClosestImpactDistances[rayIndex] - simdClosestImpactDistances[rayIndex]) > 0.001f)
 		{
-			return false;
+			numMismatchedRays++;
+		}
+		if (fabsf(floatCulledClosestImpactDistances[rayIndex] - quantizedCulledClosestImpactDistances[rayIndex]) > 0.001f)
+		{
+			numQuantizedMismatchedRays++;
 		}
 	}
-	//---------------------------------------------------------------------------------------
+	double floatBytesPerPoly = numHulls > 0 ? (double)packedScene.GetNumHullAndDiscBytes() / (double)numHulls : 0.0;
+	double quantizedBytesPerPoly = numHulls > 0 ? (double)quantizedScene.GetNumBytes() / (double)numHulls : 0.0;
 
-	g_console->AddLine(DevConsole::INFO_MAJOR, Stringf("Successfully loaded file %s", filePath.c_str()));
-	g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded %d convex polys", convexScene->m_currentNumPolys));
-	if (convexScene->m_currentNumPolys > 0 && convexScene->m_convexHulls.empty())
-	{
-		convexScene->GenerateHullsForAllPolys();
-		g_console->AddLine(DevConsole::WARNING, Stringf("No convex hulls loaded. Hulls were generated after loading polys."));
-	}
-	else if (!convexScene->m_convexHulls.empty())
-	{
-		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded convex hulls for all polys."));
-	}
-	if (convexScene->m_currentNumPolys > 0 && convexScene->m_boundingDiscs.empty())
-	{
-		convexScene->GenerateBoundingDiscsForAllPolys();
-		g_console->AddLine(DevConsole::WARNING, Stringf("No bounding discs loaded. Bounding discs were generated after loading polys and may not be the best fits."));
-	}
-	else if (!convexScene->m_boundingDiscs.empty())
-	{
-		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded bounding discs for all polys."));
-	}
-	if (convexScene->m_currentNumPolys > 0 && convexScene->m_bitBucketMasks.empty())
-	{
-		g_console->AddLine(DevConsole::WARNING, Stringf("No tiled bit regions loaded. Tiled bit regions will be generated when testing raycasts."));
-	}
-	else if (!convexScene->m_bitBucketMasks.empty())
+	g_console->AddLine(DevConsole::INFO_MAJOR, Stringf("%d rays vs %d hulls (%d planes incl. padding):", numRays, numHulls, (int)convexScene->m_packedScene.m_hulls.m_planeDistances.size()));
+	g_console->AddLine(DevConsole::INFO_MINOR, Stringf("\tScalar: %.0f rays/sec (%.2f ms)", (double)numRays / scalarTimeSeconds, scalarTimeSeconds * 1000.0));
+	g_console->AddLine(DevConsole::INFO_MINOR, Stringf("\tSIMD:   %.0f rays/sec (%.2f ms), %.2fx", (double)numRays / simdTimeSeconds, simdTimeSeconds * 1000.0, scalarTimeSeconds / simdTimeSeconds));
+	g_console->AddLine(DevConsole::INFO_MINOR, Stringf("\tSIMD + float culling:  %.0f rays/sec (%.2f ms), %.1f hull and disc bytes per poly", (double)numRays / floatCulledTimeSeconds, floatCulledTimeSeconds * 1000.0, floatBytesPerPoly));
+	g_console->AddLine(DevConsole::INFO_MINOR, Stringf("\tSIMD + 16-bit culling: %.0f rays/sec (%.2f ms), %.2fx; %.1f bytes per poly (%.0f%% smaller); %lld exact hull tests",
+		(double)numRays / quantizedCulledTimeSeconds, quantizedCulledTimeSeconds * 1000.0, floatCulledTimeSeconds / quantizedCulledTimeSeconds, quantizedBytesPerPoly, floatBytesPerPoly > 0.0 ? 100.0 * (1.0 - quantizedBytesPerPoly / floatBytesPerPoly) : 0.0, numQuantizedCullPasses));
+	if (numMismatchedRays > 0)
 	{
-		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded tiled bit region masks for all polys."));
+		g_console->AddLine(DevConsole::WARNING, Stringf("\t%d rays had different closest hits with the SIMD kernel!", numMismatchedRays));
 	}
-
-	if (!convexScene->m_unknownFileChunksLoaded.empty())
+	if (numQuantizedMismatchedRays > 0)
 	{
-		g_console->AddLine(DevConsole::INFO_MINOR, Stringf("Loaded %d unknown chunks. Chunks will be written to save file if the scene is not modified.", (int)convexScene->m_unknownFileChunksLoaded.size()));
+		g_console->AddLine(DevConsole::WARNING, Stringf("\t%d rays had different closest hits with 16-bit culling than with float culling!", numQuantizedMismatchedRays));
 	}
-
-	return false;
+	return true;
 }
 
-bool LoadChunkFromParser(BufferParser& parser)
+bool LoadChunkFromParser(BufferParser& parser, uint8_t fileMinorVersion)
 {
 	Game* game = g_app->m_game;
 	VisualTestConvexScene* convexScene = dynamic_cast<VisualTestConvexScene*>(game);
@@ -1470,13 +3483,28 @@ bool LoadChunkFromParser(BufferParser& parser)
 		Vec2 worldBoundsMins = parser.ParseVec2();
 		Vec2 worldBoundsMaxs = parser.ParseVec2();
 
+		// Files older than the grid dimensions hold a single 64-bit mask per poly for the default 8x8 grid
+		int gridSizeX = VisualTestConvexScene::DEFAULT_BIT_BUCKET_GRID_SIZE_X;
+		int gridSizeY = VisualTestConvexScene::DEFAULT_BIT_BUCKET_GRID_SIZE_Y;
+		if (fileMinorVersion >= MIN_MINOR_VERSION_WITH_BIT_REGION_GRID_SIZE)
+		{
+			gridSizeX = parser.ParseUShort();
+			gridSizeY = parser.ParseUShort();
+		}
+		if (gridSizeX < 1 || gridSizeY < 1 || gridSizeX > VisualTestConvexScene::MAX_BIT_BUCKET_GRID_SIZE || gridSizeY > VisualTestConvexScene::MAX_BIT_BUCKET_GRID_SIZE)
+		{
+			g_console->AddLine(DevConsole::ERROR, Stringf("Invalid grid size %dx%d specified in TiledBitRegions chunk. Aborting load!", gridSizeX, gridSizeY));
+			return false;
+		}
+		convexScene->SetBitBucketGridSize(gridSizeX, gridSizeY);
+
 		uint16_t numPolys = parser.ParseUShort();
 		if (numPolys != convexScene->m_currentNumPolys)
 		{
 			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in TiledBitRegions chunk does not match number of polys specified in header. Aborting load!");
 			return false;
 		}
-		for (uint16_t polyIndex = 0; polyIndex < numPolys; polyIndex++)
+		for (int wordIndex = 0; wordIndex < (int)numPolys * convexScene->m_numWordsPerBitBucketMask; wordIndex++)
 		{
 			convexScene->m_bitBucketMasks.push_back(parser.ParseUint64());
 		}
@@ -1491,6 +3519,172 @@ bool LoadChunkFromParser(BufferParser& parser)
 			convexScene->m_needToRegenerateBitMasks = true;
 		}
 	}
+	else if (chunk.m_type == ChunkType::BVH_AABB2_TREE)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in AABB2Tree chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_aabb2Tree.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid node or poly indexes in AABB2Tree chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateAABB2Tree = false;
+		convexScene->m_aabb2TreeBuildTimeMs = -1.0;
+	}
+	else if (chunk.m_type == ChunkType::BVH_OBB2_TREE)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in OBB2Tree chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_obb2Tree.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid node or poly indexes in OBB2Tree chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateOBB2Tree = false;
+	}
+	else if (chunk.m_type == ChunkType::BVH_DISC2_TREE)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in Disc2Tree chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_disc2Tree.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid node or poly indexes in Disc2Tree chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateDisc2Tree = false;
+	}
+	else if (chunk.m_type == ChunkType::BVH_CONVEX_HULL_TREE)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in ConvexHullTree chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_convexHull2Tree.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid node or poly indexes in ConvexHullTree chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateConvexHull2Tree = false;
+	}
+	else if (chunk.m_type == ChunkType::BVH_CONVEX_POLY_TREE)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in ConvexPolyTree chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_convexPoly2Tree.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid node or poly indexes in ConvexPolyTree chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateConvexPoly2Tree = false;
+	}
+	else if (chunk.m_type == ChunkType::BVH_COMPOSITE_TREE)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in CompositeTree chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_compositeTree.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid node or poly indexes in CompositeTree chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateCompositeTree = false;
+	}
+	else if (chunk.m_type == ChunkType::ASYMMETRIC_QUADTREE)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in AsymmetricQuadtree chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_asymmetricQuadtree.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid node or poly indexes in AsymmetricQuadtree chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateAsymmetricQuadtree = false;
+	}
+	else if (chunk.m_type == ChunkType::SYMMETRIC_QUADTREE)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in SymmetricQuadtree chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_symmetricQuadtree.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid node or poly indexes in SymmetricQuadtree chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateSymmetricQuadtree = false;
+	}
+	else if (chunk.m_type == ChunkType::COLUMN_ROW_BIT_REGIONS)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in ColumnRowBitRegions chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_columnRowBitRegions.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid resolution or poly bits in ColumnRowBitRegions chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateColumnRowBitRegions = false;
+	}
+	else if (chunk.m_type == ChunkType::BSP2_TREE)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in BSP2Tree chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_bsp2Tree.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid node or poly indexes in BSP2Tree chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateBSP2Tree = false;
+	}
+	else if (chunk.m_type == ChunkType::HIERARCHICAL_BIT_BUCKETS)
+	{
+		uint16_t numPolys = parser.ParseUShort();
+		if (numPolys != convexScene->m_currentNumPolys)
+		{
+			g_console->AddLine(DevConsole::ERROR, "Number of polys specified in HierarchicalBitBuckets chunk does not match number of polys specified in header. Aborting load!");
+			return false;
+		}
+		if (!convexScene->m_hierarchicalBitBuckets.ParseFromParser(parser, numPolys))
+		{
+			g_console->AddLine(DevConsole::ERROR, "Invalid bounds or masks in HierarchicalBitBuckets chunk. Aborting load!");
+			return false;
+		}
+		convexScene->m_needToRegenerateHierarchicalBitBuckets = false;
+	}
 	else
 	{
 		// All other chunks are unknown
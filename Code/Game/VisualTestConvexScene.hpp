@@ -1,6 +1,23 @@
 #pragma once
 
+#include "Game/AABB2Tree.hpp"
+#include "Game/AsymmetricQuadtree.hpp"
+#include "Game/BSP2Tree.hpp"
+#include "Game/ColumnRowBitRegions.hpp"
+#include "Game/CompositeTree.hpp"
+#include "Game/ConvexHull2Tree.hpp"
+#include "Game/ConvexPoly2Tree.hpp"
+#include "Game/Disc2Tree.hpp"
 #include "Game/Game.hpp"
+#include "Game/HierarchicalBitBuckets.hpp"
+#include "Game/HullRaycastFunction.hpp"
+#include "Game/OBB2Tree.hpp"
+#include "Game/PackedConvexScene.hpp"
+#include "Game/QuantizedConvexScene.hpp"
+#include "Game/RayPacket4.hpp"
+#include "Game/RaycastQueryContext.hpp"
+#include "Game/SymmetricQuadtree.hpp"
+#include "Game/WorkStealingThreadPool.hpp"
 
 #include "Engine/Math/ConvexPoly2.hpp"
 #include "Engine/Math/ConvexHull2.hpp"
@@ -20,12 +37,61 @@ public:
 	bool m_visible = false;
 };
 
+// Padded to a cache line so per-thread totals written side by side do not false-share
+struct alignas(64) RaycastTestTotals
+{
+public:
+	void Merge(RaycastTestTotals const& totals);
+
+public:
+	int m_numHitRays = 0;
+	long long m_numHullTests = 0;
+	long long m_numNodesVisited = 0;
+	double m_totalImpactDistance = 0.0;
+	// Made by the raycasting threads while tracing, so allocations elsewhere in the process are not counted
+	long long m_numHeapAllocations = 0;
+};
+
 enum class OptimizationMode
 {
 	NONE,
 	NARROW_PHASE_BOUNDING_DISC_ONLY,
 	BROAD_PHASE_BIT_BUCKET_ONLY,
 	NARROW_AND_BROAD_PHASE,
+	BVH_AABB2_TREE,
+	BVH_OBB2_TREE,
+	BVH_DISC2_TREE,
+	BVH_CONVEX_HULL_TREE,
+	BVH_COMPOSITE_TREE,
+	ASYMMETRIC_QUADTREE,
+	SYMMETRIC_QUADTREE,
+	COLUMN_ROW_BIT_REGIONS,
+	BSP2_TREE,
+	HIERARCHICAL_BIT_BUCKETS,
+	NUM
+};
+
+enum class NarrowPhaseProxy
+{
+	LOADED_DISC,
+	MINIMAL_DISC,
+	MINIMAL_OBB,
+	NUM
+};
+
+enum class RaycastKernel
+{
+	SCALAR,
+	SIMD_PLANES,
+	SIMD_RAY_PACKETS,
+	NUM
+};
+
+enum class RaySortMode
+{
+	NONE,
+	MORTON,
+	MORTON_AND_DIRECTION,
 	NUM
 };
 
@@ -40,7 +106,11 @@ public:
 	uint32_t m_totalSizeIncludingHeaderAndFooter = 0;
 };
 
+bool IsAccelerationStructureMode(OptimizationMode optimizationMode);
 std::string GetOptimizationModeStr(OptimizationMode optimizationMode);
+std::string GetRaycastKernelStr(RaycastKernel raycastKernel);
+std::string GetNarrowPhaseProxyStr(NarrowPhaseProxy narrowPhaseProxy);
+std::string GetRaySortModeStr(RaySortMode raySortMode);
 
 class VisualTestConvexScene : public Game
 {
@@ -52,19 +122,61 @@ public:
 	virtual void Randomize();
 
 	void HandleInput();
+	void MarkSceneAsModified();
+	void MarkPolyAsModified(int polyIndex);
+	void UpdateModifiedPolys();
 	void RotatePolyAtIndexAroundPointByDegrees(int polyIndex, Vec2 const& point, float degrees);
 	void ScalePolyAtIndexAroundPointByFactor(int polyIndex, Vec2 const& point, float scalingFactor);
 
 	void GenerateHullsForAllPolys();
 	void RegenerateHullForForPolyAtIndex(int polyIndex);
 	void GenerateBitMasksForAllPolys();
+	void GenerateBitMaskForPolyAtIndex(int polyIndex);
 	void GenerateBoundingDiscsForAllPolys();
+	void GenerateMinimalBoundingVolumesForAllPolys();
+	void GenerateMinimalBoundingVolumesForPolyAtIndex(int polyIndex);
+	void GenerateAABB2Tree();
+	void GenerateOBB2Tree();
+	void GenerateDisc2Tree();
+	void GenerateConvexHull2Tree();
+	void GenerateConvexPoly2Tree();
+	void GenerateCompositeTree();
+	void GenerateAsymmetricQuadtree();
+	void GenerateSymmetricQuadtree();
+	void GenerateBSP2Tree();
+	void GenerateColumnRowBitRegions();
+	void GenerateHierarchicalBitBuckets();
+	void GeneratePackedScene();
+	void RefitConvexPoly2TreeForPolyAtIndex(int polyIndex);
+	void RebucketPolyAtIndexInSymmetricQuadtree(int polyIndex);
 
 	RaycastResult2D RaycastVsConvexHull2_WithDebugDrawWhenForSimpleHull(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, ConvexHull2 const& convexHull, std::vector<Vertex_PCU>& verts) const;
 	void GetAllTileIndexesForRaycastVsGrid(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, std::vector<unsigned int>& out_tileIndexes) const;
+	void GetBitBucketMaskForRaycast(Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, RaycastQueryContext& context) const;
+	bool DoesPolyBitBucketMaskOverlapRayMask(int polyIndex, std::vector<unsigned long long> const& rayBitMask, int firstWordIndex, int lastWordIndex) const;
+	bool DoesRayHitNarrowPhaseProxy(NarrowPhaseProxy narrowPhaseProxy, int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance) const;
+	int GetRayPacket4LanesHittingNarrowPhaseProxy(NarrowPhaseProxy narrowPhaseProxy, int polyIndex, RayPacket4 const& packet) const;
+	RaycastResult2D RaycastVsConvexHullWithCurrentKernel(int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance) const;
+	bool DoesRayHitConvexHullWithCurrentKernel(int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance) const;
+	bool DoesRayHitQuantizedHullWithCurrentKernel(int polyIndex, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance) const;
+	int GetRayPacket4LanesHittingQuantizedHull(int polyIndex, RayPacket4 const& packet, int laneMask) const;
+	void SetBitBucketGridSize(int gridSizeX, int gridSizeY);
 
 	void GenerateRandomRaycasts();
+	void SortTestRaycastsForCoherence();
+	void ReorderTestRaycasts(std::vector<int> const& sourceRayIndexes);
 	void PerformAllTestRaycasts();
+	void PrepareRaycastQueryContexts();
+	double RunTimedTestRaycasts(RaycastTestTotals& out_totals);
+	void PerformTestRaycastsForRange(int firstRayIndex, int endRayIndex, RaycastQueryContext& context, RaycastTestTotals& inout_totals) const;
+	void PerformTestRaycastsInPacketsForRange(int firstRayIndex, int endRayIndex, RaycastQueryContext& context, RaycastTestTotals& inout_totals) const;
+	void PerformTestOcclusionRaycastsForRange(int firstRayIndex, int endRayIndex, RaycastQueryContext& context, RaycastTestTotals& inout_totals) const;
+	RaycastResult2D RaycastVsAccelerationStructure(OptimizationMode optimizationMode, Vec2 const& startPos, Vec2 const& fwdNormal, float maxDistance, HullRaycastFunction const& raycastVsHull, RaycastQueryContext& context, int& out_numHullTests, int& out_numNodesVisited, bool stopAtFirstHit = false) const;
+	long long CountHullTestsForNarrowAndBroadPhase();
+	void MeasureSingleVolumeTreeRaycastTimes();
+	void MeasureTiledBitRegionsRaycastTime();
+	void MeasureNarrowPhaseRejectionRates();
+	void MeasureUnsortedRaycastTime();
 
 	int GetTileIndexForWorldPosition(Vec2 const& worldPosition) const;
 	IntVec2 const GetTileCoordsForWorldPosition(Vec2 const& worldPosition) const;
@@ -77,7 +189,9 @@ public:
 	static constexpr int NUM_MAX_POLYS = 1024;
 
 	static constexpr int NUM_INITIAL_RAYCASTS = 1024;
-	static constexpr int NUM_MAX_RAYCASTS = 2048;
+	static constexpr int NUM_MAX_RAYCASTS = 4 * 1024 * 1024;
+	static constexpr int RAYCAST_CHUNK_SIZE = 1024;
+	static constexpr int NUM_MAX_REJECTION_RATE_SAMPLE_RAYS = 16384;
 	
 	static constexpr float BOUNDING_DISC_MIN_RADIUS = 5.f;
 	static constexpr float BOUNDING_DISC_MAX_RADIUS = 20.f;
@@ -87,26 +201,70 @@ public:
 
 	static constexpr float RAY_MIN_LENGTH = 10.f;
 	static constexpr float RAY_MAX_LENGTH = 100.f;
+	static constexpr int RAY_FAN_SIZE = 16;
+	static constexpr float RAY_FAN_SPREAD_DEGREES = 10.f;
+	// Below this many vertexes clipping against every plane beats the binary searches
+	static constexpr int NUM_MIN_VERTEXES_FOR_LOGARITHMIC_RAYCAST = 32;
+	// Morton bits below the cell that direction buckets are grouped within (leaves a 64x64 grid of cells)
+	static constexpr int RAY_SORT_FINE_MORTON_BITS = 20;
 
-	static constexpr int BIT_BUCKET_GRID_SIZE_X = 8;
-	static constexpr int BIT_BUCKET_GRID_SIZE_Y = 8;
+	static constexpr int DEFAULT_BIT_BUCKET_GRID_SIZE_X = 8;
+	static constexpr int DEFAULT_BIT_BUCKET_GRID_SIZE_Y = 8;
+	static constexpr int MAX_BIT_BUCKET_GRID_SIZE = 256;
 
 	Clock* m_gameClock = nullptr;
 
 	std::vector<ConvexPoly2> m_convexPolys;
 	std::vector<ConvexHull2> m_convexHulls;
+	// Flat copy of the polys, hulls and loaded discs that raycasts, rendering and saving read from; polys with many vertexes
+	// are raycast against its vertex chains in logarithmic time
+	PackedConvexScene m_packedScene;
+	// Rebuilt and patched alongside m_packedScene
+	QuantizedConvexScene m_quantizedScene;
+	int m_numPolysUsingLogarithmicRaycast = 0;
 	std::vector<BoundingDisc> m_boundingDiscs;
+	// Exact minimal enclosing disc and minimal area box per poly, generated rather than loaded
+	std::vector<BoundingDisc> m_minimalBoundingDiscs;
+	std::vector<OBB2> m_minimalBoundingOBBs;
+	// Each poly's mask is m_numWordsPerBitBucketMask consecutive words, one bit per tile
 	std::vector<unsigned long long> m_bitBucketMasks;
+	AABB2Tree m_aabb2Tree;
+	OBB2Tree m_obb2Tree;
+	Disc2Tree m_disc2Tree;
+	ConvexHull2Tree m_convexHull2Tree;
+	ConvexPoly2Tree m_convexPoly2Tree;
+	CompositeTree m_compositeTree;
+	AsymmetricQuadtree m_asymmetricQuadtree;
+	SymmetricQuadtree m_symmetricQuadtree;
+	BSP2Tree m_bsp2Tree;
+	ColumnRowBitRegions m_columnRowBitRegions;
+	HierarchicalBitBuckets m_hierarchicalBitBuckets;
 
 	int m_currentNumPolys = NUM_INITIAL_POLYS;
 
 	bool m_drawWithTranslucentFill = false;
 	bool m_drawBitBucketGrid = false;
+	bool m_drawAccelerationStructure = false;
+	RaycastKernel m_currentRaycastKernel = RaycastKernel::SCALAR;
+	NarrowPhaseProxy m_currentNarrowPhaseProxy = NarrowPhaseProxy::LOADED_DISC;
+	bool m_generateRayFans = false;
+	bool m_useMultithreadedRaycasts = false;
+	bool m_useFrontToBackHullOrder = false;
+	// Runs the 'T' batch as any-hit occlusion queries instead of closest hit queries
+	bool m_useOcclusionQueries = false;
+	RaySortMode m_currentRaySortMode = RaySortMode::NONE;
+	// Rejects rays against the 16-bit hulls and loaded discs before touching the float ones
+	bool m_useQuantizedCulling = false;
+	WorkStealingThreadPool m_raycastThreadPool;
+	// One of each per pool thread, sized before the timed batch so tracing rays never allocates
+	std::vector<RaycastQueryContext> m_raycastQueryContexts;
+	std::vector<RaycastTestTotals> m_raycastThreadTotals;
 
 	int m_hoveredConvexPolyIndex = -1;
 	int m_selectedConvexPolyIndex = -1;
 	Vec2 m_selectedPolyOffsetFromCursorPosition = Vec2::ZERO;
 	std::vector<Vec2> m_vertexOffsetsFromCursorPosition;
+	std::vector<int> m_polyIndexesOverlappingSelectedPoly;
 
 	bool m_isMovingRaycast = false;
 	Vec2 m_visibleRaycastStart = Vec2::ZERO;
@@ -115,25 +273,76 @@ public:
 	int m_currentNumRaycasts = NUM_INITIAL_RAYCASTS;
 
 	OptimizationMode m_currentOptimizationMode = OptimizationMode::NONE;
+	int m_numColumnRowBitRegionColumns = 256;
+	int m_bitBucketGridSizeX = DEFAULT_BIT_BUCKET_GRID_SIZE_X;
+	int m_bitBucketGridSizeY = DEFAULT_BIT_BUCKET_GRID_SIZE_Y;
+	int m_numWordsPerBitBucketMask = 1;
 
 	std::vector<Vec2> m_rayStartPositions;
 	std::vector<Vec2> m_rayFwdNormals;
 	std::vector<float> m_rayMaxDistances;
+	// Original index of each test ray after sorting, so per-ray results can be mapped back to generation order; empty when unsorted
+	std::vector<int> m_raySortPermutation;
+	// Sorted index of each ray in generation order, the inverse of m_raySortPermutation; empty when unsorted
+	std::vector<int> m_rayUnsortPermutation;
 
 	double m_totalRaycastTimeMs = -1.f;
 	float m_averageRaycastImpactDistance = -1.f;
 	int m_raycastsPerformedInLastTest = 0;
+	int m_numHitRaysInLastTest = 0;
+	bool m_lastTestUsedOcclusionQueries = false;
+	// Most recent throughput of each query type, so switching between them gives a side by side comparison
+	double m_closestHitRaycastsPerMs = -1.0;
+	double m_occlusionRaycastsPerMs = -1.0;
+	// Cost of the sort pre-pass, and the time for the same rays in generation order, measured when sorting rays
+	double m_raySortTimeMs = -1.0;
+	double m_unsortedRaycastTimeMs = -1.0;
+	// Last AABB2 tree build; negative when the current tree was loaded from file rather than built
+	double m_aabb2TreeBuildTimeMs = -1.0;
+	long long m_numHullTestsInLastTest = 0;
+	long long m_numNarrowAndBroadPhaseHullTestsInLastTest = -1;
+	// Only counted by trees that report node visits (currently the BSP2 tree)
+	int m_numNodesVisitedInLastTest = -1;
+	// AABB2, OBB2 and Disc2 tree times for the same rays, measured when testing the composite tree
+	double m_singleVolumeTreeRaycastTimesMs[3] = { -1.0, -1.0, -1.0 };
+	// Bit bucket grid time for the same rays, measured when testing column/row bit regions or hierarchical bit buckets
+	double m_tiledBitRegionsRaycastTimeMs = -1.0;
+	// Fraction of narrow phase candidates each proxy rejects, indexed by NarrowPhaseProxy, measured in the narrow phase modes
+	float m_narrowPhaseRejectionRates[(int)NarrowPhaseProxy::NUM] = { -1.f, -1.f, -1.f };
+	// Empty when the last test ran on the main thread only
+	std::vector<double> m_raycastThreadBusyTimesMs;
+	int m_numRaycastChunksStolenInLastTest = 0;
+	long long m_numHeapAllocationsInLastTest = 0;
 
 	AABB2 m_worldBounds = AABB2(Vec2::ZERO, Vec2(WORLD_SIZE_X, WORLD_SIZE_Y));
 	AABB2 m_sceneBounds = AABB2(Vec2::ZERO, Vec2(WORLD_SIZE_X, WORLD_SIZE_Y));
 
 	std::vector<GHCSFileChunk> m_unknownFileChunksLoaded;
 
+	// Polys moved, rotated or scaled since the last 'T'; their bit masks and minimal volumes are patched rather than rebuilt for every poly
+	std::vector<int> m_modifiedPolyIndexes;
+
 	bool m_needToRegenerateBitMasks = true;
+	bool m_needToRegenerateAABB2Tree = true;
+	bool m_needToRegenerateOBB2Tree = true;
+	bool m_needToRegenerateDisc2Tree = true;
+	bool m_needToRegenerateConvexHull2Tree = true;
+	bool m_needToRegenerateConvexPoly2Tree = true;
+	bool m_needToRegenerateCompositeTree = true;
+	bool m_needToRegenerateAsymmetricQuadtree = true;
+	bool m_needToRegenerateSymmetricQuadtree = true;
+	bool m_needToRegenerateBSP2Tree = true;
+	bool m_needToRegenerateColumnRowBitRegions = true;
+	bool m_needToRegenerateHierarchicalBitBuckets = true;
+	bool m_needToRegeneratePackedScene = true;
+	bool m_needToRegenerateMinimalBoundingVolumes = true;
 };
 
 void Append4ccCodeToWriter(char const* code, BufferWriter& writer);
 char const* Parse4ccCodeFromParser(BufferParser& parser);
 bool Command_SaveScene(EventArgs& args);
 bool Command_LoadScene(EventArgs& args);
-bool LoadChunkFromParser(BufferParser& parser);
+bool Command_SetColumnRowBitRegionsResolution(EventArgs& args);
+bool Command_SetBitBucketGridResolution(EventArgs& args);
+bool Command_BenchmarkConvexHullRaycasts(EventArgs& args);
+bool LoadChunkFromParser(BufferParser& parser, uint8_t fileMinorVersion);
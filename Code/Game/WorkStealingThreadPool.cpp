@@ -0,0 +1,181 @@
+#include "Game/WorkStealingThreadPool.hpp"
+
+#include "Engine/Core/Time.hpp"
+
+
+static uint64_t PackChunkRange(uint32_t nextChunkIndex, uint32_t endChunkIndex)
+{
+	return ((uint64_t)endChunkIndex << 32) | (uint64_t)nextChunkIndex;
+}
+
+static uint32_t GetNextChunkIndex(uint64_t chunkRange)
+{
+	return (uint32_t)(chunkRange & 0xFFFFFFFFull);
+}
+
+static uint32_t GetEndChunkIndex(uint64_t chunkRange)
+{
+	return (uint32_t)(chunkRange >> 32);
+}
+
+
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isQuitting = true;
+	}
+	m_workAvailableCondition.notify_all();
+
+	for (int workerIndex = 0; workerIndex < (int)m_workerThreads.size(); workerIndex++)
+	{
+		m_workerThreads[workerIndex].join();
+	}
+}
+
+WorkStealingThreadPool::WorkStealingThreadPool(int numThreads)
+	: m_chunkQueues(numThreads > 0 ? numThreads : (std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1))
+{
+	m_threadBusyTimesMs.resize(m_chunkQueues.size(), 0.0);
+	for (int queueIndex = 0; queueIndex < (int)m_chunkQueues.size(); queueIndex++)
+	{
+		m_chunkQueues[queueIndex].m_chunkRange.store(0ull);
+	}
+
+	// Thread 0 is whoever calls ParallelFor
+	for (int threadIndex = 1; threadIndex < (int)m_chunkQueues.size(); threadIndex++)
+	{
+		m_workerThreads.emplace_back(&WorkStealingThreadPool::WorkerThreadMain, this, threadIndex);
+	}
+}
+
+void WorkStealingThreadPool::ParallelFor(int numItems, int chunkSize, ChunkFunction const& chunkFunction)
+{
+	int numThreads = GetNumThreads();
+	m_chunkSize = chunkSize > 0 ? chunkSize : 1;
+	m_numItems = numItems;
+	m_chunkFunction = &chunkFunction;
+	m_numChunksStolen.store(0);
+
+	// Hand each thread an equal contiguous run of chunks up front; stealing evens out whatever imbalance remains
+	int numChunks = (numItems + m_chunkSize - 1) / m_chunkSize;
+	for (int threadIndex = 0; threadIndex < numThreads; threadIndex++)
+	{
+		uint32_t firstChunkIndex = (uint32_t)(((long long)numChunks * threadIndex) / numThreads);
+		uint32_t endChunkIndex = (uint32_t)(((long long)numChunks * (threadIndex + 1)) / numThreads);
+		m_chunkQueues[threadIndex].m_chunkRange.store(PackChunkRange(firstChunkIndex, endChunkIndex));
+		m_threadBusyTimesMs[threadIndex] = 0.0;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_numWorkersRunning = (int)m_workerThreads.size();
+		m_workGeneration++;
+	}
+	m_workAvailableCondition.notify_all();
+
+	RunChunks(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_workFinishedCondition.wait(lock, [this]() { return m_numWorkersRunning == 0; });
+	m_chunkFunction = nullptr;
+	m_numChunksStolenInLastRun = m_numChunksStolen.load();
+}
+
+void WorkStealingThreadPool::WorkerThreadMain(int threadIndex)
+{
+	uint64_t lastWorkGeneration = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workAvailableCondition.wait(lock, [this, lastWorkGeneration]() { return m_isQuitting || m_workGeneration != lastWorkGeneration; });
+			if (m_isQuitting)
+			{
+				return;
+			}
+			lastWorkGeneration = m_workGeneration;
+		}
+
+		RunChunks(threadIndex);
+
+		bool isLastWorkerToFinish = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_numWorkersRunning--;
+			isLastWorkerToFinish = m_numWorkersRunning == 0;
+		}
+		if (isLastWorkerToFinish)
+		{
+			m_workFinishedCondition.notify_one();
+		}
+	}
+}
+
+void WorkStealingThreadPool::RunChunks(int threadIndex)
+{
+	double startTimeSeconds = GetCurrentTimeSeconds();
+	int numThreads = GetNumThreads();
+	int numChunksStolen = 0;
+
+	while (true)
+	{
+		int chunkIndex = -1;
+		if (!PopChunkFromFront(threadIndex, chunkIndex))
+		{
+			// No chunks are ever added during a run, so once every queue is empty we are done
+			for (int queueOffset = 1; queueOffset < numThreads && chunkIndex < 0; queueOffset++)
+			{
+				if (StealChunkFromBack((threadIndex + queueOffset) % numThreads, chunkIndex))
+				{
+					numChunksStolen++;
+				}
+			}
+			if (chunkIndex < 0)
+			{
+				break;
+			}
+		}
+
+		int firstItemIndex = chunkIndex * m_chunkSize;
+		int endItemIndex = firstItemIndex + m_chunkSize < m_numItems ? firstItemIndex + m_chunkSize : m_numItems;
+		(*m_chunkFunction)(threadIndex, firstItemIndex, endItemIndex);
+	}
+
+	m_numChunksStolen.fetch_add(numChunksStolen);
+	m_threadBusyTimesMs[threadIndex] = (GetCurrentTimeSeconds() - startTimeSeconds) * 1000.0;
+}
+
+bool WorkStealingThreadPool::PopChunkFromFront(int queueIndex, int& out_chunkIndex)
+{
+	std::atomic<uint64_t>& chunkRange = m_chunkQueues[queueIndex].m_chunkRange;
+	uint64_t currentRange = chunkRange.load();
+	while (GetNextChunkIndex(currentRange) < GetEndChunkIndex(currentRange))
+	{
+		uint64_t poppedRange = PackChunkRange(GetNextChunkIndex(currentRange) + 1, GetEndChunkIndex(currentRange));
+		if (chunkRange.compare_exchange_weak(currentRange, poppedRange))
+		{
+			out_chunkIndex = (int)GetNextChunkIndex(currentRange);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool WorkStealingThreadPool::StealChunkFromBack(int queueIndex, int& out_chunkIndex)
+{
+	std::atomic<uint64_t>& chunkRange = m_chunkQueues[queueIndex].m_chunkRange;
+	uint64_t currentRange = chunkRange.load();
+	while (GetNextChunkIndex(currentRange) < GetEndChunkIndex(currentRange))
+	{
+		uint64_t stolenRange = PackChunkRange(GetNextChunkIndex(currentRange), GetEndChunkIndex(currentRange) - 1);
+		if (chunkRange.compare_exchange_weak(currentRange, stolenRange))
+		{
+			out_chunkIndex = (int)GetEndChunkIndex(currentRange) - 1;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Runs [first, end) item ranges on a fixed set of threads. The calling thread is thread 0 and works alongside the workers;
+// each thread drains its own contiguous run of chunks from the front and steals from the back of other threads' runs once empty.
+class WorkStealingThreadPool
+{
+public:
+	typedef std::function<void(int threadIndex, int firstItemIndex, int endItemIndex)> ChunkFunction;
+
+	~WorkStealingThreadPool();
+	explicit WorkStealingThreadPool(int numThreads = 0);
+	WorkStealingThreadPool(WorkStealingThreadPool const& copyFrom) = delete;
+	WorkStealingThreadPool& operator=(WorkStealingThreadPool const& copyFrom) = delete;
+
+	int GetNumThreads() const { return (int)m_chunkQueues.size(); }
+	void ParallelFor(int numItems, int chunkSize, ChunkFunction const& chunkFunction);
+
+	// Per-thread time spent running and stealing chunks during the last ParallelFor
+	double GetThreadBusyTimeMs(int threadIndex) const { return m_threadBusyTimesMs[threadIndex]; }
+	int GetNumChunksStolenInLastRun() const { return m_numChunksStolenInLastRun; }
+
+private:
+	// Next and end chunk indexes packed into one word, so the owner and thieves agree on a single compare-and-swap
+	struct alignas(64) ChunkQueue
+	{
+		std::atomic<uint64_t> m_chunkRange;
+	};
+
+	void WorkerThreadMain(int threadIndex);
+	void RunChunks(int threadIndex);
+	bool PopChunkFromFront(int queueIndex, int& out_chunkIndex);
+	bool StealChunkFromBack(int queueIndex, int& out_chunkIndex);
+
+private:
+	std::vector<std::thread> m_workerThreads;
+	std::vector<ChunkQueue> m_chunkQueues;
+	std::vector<double> m_threadBusyTimesMs;
+
+	std::mutex m_mutex;
+	std::condition_variable m_workAvailableCondition;
+	std::condition_variable m_workFinishedCondition;
+	uint64_t m_workGeneration = 0;
+	int m_numWorkersRunning = 0;
+	bool m_isQuitting = false;
+
+	ChunkFunction const* m_chunkFunction = nullptr;
+	int m_numItems = 0;
+	int m_chunkSize = 1;
+	std::atomic<int> m_numChunksStolen = 0;
+	int m_numChunksStolenInLastRun = 0;
+};